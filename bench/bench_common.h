@@ -0,0 +1,114 @@
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+// Shared benchmark helpers: a monotonic timer, a seeded RNG that gives every
+// run the same scene, box arrays for physics_add_boxes() and a box pile.
+// Benchmarks print their results to stderr, run them with >/dev/null to hide
+// world logging. Include this before any system header
+
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <cglm/cglm.h>
+
+#include "physics/physics.h"
+
+typedef struct {
+    unsigned int count;
+    vec3* positions;
+    vec3* sizes;     // Unit cubes until changed
+    float* masses;   // 1 kg until changed
+} bench_boxes_t;
+
+static unsigned int bench_rng_state = 12345;
+
+static inline double bench_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1e6;
+}
+
+static inline void bench_rng_seed(unsigned int seed) {
+    bench_rng_state = seed;
+}
+
+static inline unsigned int bench_rng_next(void) {
+    bench_rng_state = bench_rng_state * 1664525u + 1013904223u;
+
+    return bench_rng_state >> 8;
+}
+
+/**
+   * Uniform random float in [0, 1)
+**/
+
+static inline float bench_rng_float(void) {
+    return (float)bench_rng_next() / 16777216.0f;
+}
+
+/**
+   * Allocate box arrays, exits when out of memory
+   * @param count Number of boxes
+   * @param what Name for the error message, e.g. "pile"
+   * @return Boxes to fill in and pass to physics_add_boxes()
+**/
+
+static inline bench_boxes_t bench_boxes_alloc(unsigned int count, const char* what) {
+    bench_boxes_t boxes = {0};
+
+    boxes.count = count;
+    boxes.positions = malloc(sizeof(vec3) * count);
+    boxes.sizes = malloc(sizeof(vec3) * count);
+    boxes.masses = malloc(sizeof(float) * count);
+
+    if (!boxes.positions || !boxes.sizes || !boxes.masses) {
+        fprintf(stderr, "Failed to allocate %s\n", what);
+        exit(1);
+    }
+
+    for (unsigned int i = 0; i < count; i++) {
+        glm_vec3_zero(boxes.positions[i]);
+        glm_vec3_one(boxes.sizes[i]);
+        boxes.masses[i] = 1.0f;
+    }
+
+    return boxes;
+}
+
+static inline void bench_boxes_free(bench_boxes_t* boxes) {
+    free(boxes->positions);
+    free(boxes->sizes);
+    free(boxes->masses);
+
+    *boxes = (bench_boxes_t){0};
+}
+
+/**
+   * Add jittered columns of unit cubes on a static floor, they keep collapsing for a while
+   * @param world Physics world
+   * @param count Number of boxes
+   * @param width Columns per side, the pile is count / width^2 boxes high
+**/
+
+static inline void bench_add_pile(physics_world_t* world, unsigned int count, unsigned int width) {
+    bench_boxes_t boxes = bench_boxes_alloc(count, "pile");
+
+    for (unsigned int i = 0; i < count; i++) {
+        float jitter = (float)((i * 7919) % 100) * 0.002f;
+
+        boxes.positions[i][0] = (float)(i % width) * 1.05f + jitter;
+        boxes.positions[i][1] = 0.5f + (float)(i / (width * width)) * 1.05f;
+        boxes.positions[i][2] = (float)((i / width) % width) * 1.05f - jitter;
+    }
+
+    physics_add_box(world, (vec3){width * 0.5f, -0.5f, width * 0.5f}, (vec3){200.0f, 1.0f, 200.0f}, 0.0f);
+    physics_add_boxes(world, count, boxes.positions, boxes.sizes, boxes.masses, NULL, NULL);
+    bench_boxes_free(&boxes);
+}
+
+#endif // BENCH_COMMON_H
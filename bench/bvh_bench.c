@@ -0,0 +1,185 @@
+#include "bench_common.h"
+#include <float.h>
+#include <math.h>
+
+#include "renderer/bvh.h"
+
+// Scene BVH benchmark: build, refit and queries against a linear scan
+// Boxes are scattered like a dense city block: wide on XZ, short on Y
+
+#define OBJECT_COUNT 100000
+#define DYNAMIC_FRACTION 10
+#define QUERY_COUNT 1000
+#define WORLD_SIZE 2000.0f
+
+static float randf(float lo, float hi) {
+    return lo + (hi - lo) * ((float)rand() / (float)RAND_MAX);
+}
+
+static int ray_hits_box(vec3 origin, vec3 inv_dir, float max_t, vec3 min, vec3 max) {
+    float t_near = 0.0f;
+    float t_far = max_t;
+
+    for (int i = 0; i < 3; i++) {
+        float t0 = (min[i] - origin[i]) * inv_dir[i];
+        float t1 = (max[i] - origin[i]) * inv_dir[i];
+
+        t_near = fmaxf(t_near, fminf(t0, t1));
+        t_far = fminf(t_far, fmaxf(t0, t1));
+    }
+
+    return t_near <= t_far;
+}
+
+static int sphere_hits_box(vec3 center, float radius, vec3 min, vec3 max) {
+    float dist_sq = 0.0f;
+
+    for (int i = 0; i < 3; i++) {
+        float v = fmaxf(min[i], fminf(center[i], max[i])) - center[i];
+        dist_sq += v * v;
+    }
+
+    return dist_sq <= radius * radius;
+}
+
+int main(void) {
+    srand(1234);
+
+    vec3 (*boxes)[2] = malloc(sizeof(vec3[2]) * OBJECT_COUNT);
+    unsigned int* ids = malloc(sizeof(unsigned int) * OBJECT_COUNT);
+    int* handles = malloc(sizeof(int) * OBJECT_COUNT);
+
+    if (!boxes || !ids || !handles) {
+        fprintf(stderr, "Failed to allocate benchmark data\n");
+
+        return 1;
+    }
+
+    for (int i = 0; i < OBJECT_COUNT; i++) {
+        float x = randf(-WORLD_SIZE * 0.5f, WORLD_SIZE * 0.5f);
+        float z = randf(-WORLD_SIZE * 0.5f, WORLD_SIZE * 0.5f);
+        float w = randf(1.0f, 8.0f);
+        float h = randf(2.0f, 40.0f);
+
+        boxes[i][0][0] = x - w; boxes[i][0][1] = 0.0f; boxes[i][0][2] = z - w;
+        boxes[i][1][0] = x + w; boxes[i][1][1] = h;    boxes[i][1][2] = z + w;
+    }
+
+    bvh_t bvh = bvh_create();
+
+    for (int i = 0; i < OBJECT_COUNT; i++) {
+        handles[i] = bvh_insert(&bvh, boxes[i][0], boxes[i][1], (unsigned int)i);
+    }
+
+    // Build
+    double start = bench_now_ms();
+    bvh_build(&bvh);
+    double build_ms = bench_now_ms() - start;
+
+    printf("BVH benchmark: %d objects | %u nodes | SAH cost %.2f\n", OBJECT_COUNT, bvh.node_count, bvh.build_cost);
+    printf("  build:            %8.3f ms\n", build_ms);
+
+    // Refit after moving the dynamic fraction
+    double refit_ms = 0.0;
+    int refit_frames = 60;
+
+    for (int frame = 0; frame < refit_frames; frame++) {
+        for (int i = 0; i < OBJECT_COUNT; i += DYNAMIC_FRACTION) {
+            vec3 offset = {randf(-0.5f, 0.5f), 0.0f, randf(-0.5f, 0.5f)};
+
+            glm_vec3_add(boxes[i][0], offset, boxes[i][0]);
+            glm_vec3_add(boxes[i][1], offset, boxes[i][1]);
+            bvh_update(&bvh, handles[i], boxes[i][0], boxes[i][1]);
+        }
+
+        start = bench_now_ms();
+        bvh_refit(&bvh);
+        refit_ms += bench_now_ms() - start;
+    }
+
+    printf("  refit (%d%% moving): %6.3f ms/frame | SAH cost %.2f\n", 100 / DYNAMIC_FRACTION, refit_ms / refit_frames, bvh.cost);
+
+    // Frustum queries from random street level cameras
+    double bvh_ms = 0.0, linear_ms = 0.0;
+    unsigned long bvh_hits = 0, linear_hits = 0;
+
+    mat4 projection;
+    glm_perspective(glm_rad(60.0f), 16.0f / 9.0f, 0.1f, 500.0f, projection);
+
+    for (int q = 0; q < QUERY_COUNT; q++) {
+        vec3 eye = {randf(-900.0f, 900.0f), 2.0f, randf(-900.0f, 900.0f)};
+        vec3 target = {eye[0] + randf(-1.0f, 1.0f), 2.0f, eye[2] + randf(-1.0f, 1.0f)};
+        mat4 view, view_projection;
+        vec4 planes[6];
+
+        glm_lookat(eye, target, (vec3){0.0f, 1.0f, 0.0f}, view);
+        glm_mat4_mul(projection, view, view_projection);
+        glm_frustum_planes(view_projection, planes);
+
+        start = bench_now_ms();
+        bvh_hits += bvh_query_frustum(&bvh, planes, ids, OBJECT_COUNT);
+        bvh_ms += bench_now_ms() - start;
+
+        start = bench_now_ms();
+        for (int i = 0; i < OBJECT_COUNT; i++) {
+            linear_hits += glm_aabb_frustum(boxes[i], planes);
+        }
+        linear_ms += bench_now_ms() - start;
+    }
+
+    printf("  frustum query:    %8.4f ms (linear %8.4f ms) | hits %lu vs %lu\n",
+           bvh_ms / QUERY_COUNT, linear_ms / QUERY_COUNT, bvh_hits, linear_hits);
+
+    // Ray queries across the city
+    bvh_ms = linear_ms = 0.0;
+    bvh_hits = linear_hits = 0;
+
+    for (int q = 0; q < QUERY_COUNT; q++) {
+        vec3 origin = {randf(-900.0f, 900.0f), randf(1.0f, 30.0f), randf(-900.0f, 900.0f)};
+        vec3 dir = {randf(-1.0f, 1.0f), randf(-0.1f, 0.1f), randf(-1.0f, 1.0f)};
+        vec3 inv_dir = {1.0f / dir[0], 1.0f / dir[1], 1.0f / dir[2]};
+        float max_t = 200.0f;
+
+        start = bench_now_ms();
+        bvh_hits += bvh_query_ray(&bvh, origin, dir, max_t, ids, OBJECT_COUNT);
+        bvh_ms += bench_now_ms() - start;
+
+        start = bench_now_ms();
+        for (int i = 0; i < OBJECT_COUNT; i++) {
+            linear_hits += ray_hits_box(origin, inv_dir, max_t, boxes[i][0], boxes[i][1]);
+        }
+        linear_ms += bench_now_ms() - start;
+    }
+
+    printf("  ray query:        %8.4f ms (linear %8.4f ms) | hits %lu vs %lu\n",
+           bvh_ms / QUERY_COUNT, linear_ms / QUERY_COUNT, bvh_hits, linear_hits);
+
+    // Sphere queries
+    bvh_ms = linear_ms = 0.0;
+    bvh_hits = linear_hits = 0;
+
+    for (int q = 0; q < QUERY_COUNT; q++) {
+        vec3 center = {randf(-900.0f, 900.0f), randf(0.0f, 30.0f), randf(-900.0f, 900.0f)};
+        float radius = 25.0f;
+
+        start = bench_now_ms();
+        bvh_hits += bvh_query_sphere(&bvh, center, radius, ids, OBJECT_COUNT);
+        bvh_ms += bench_now_ms() - start;
+
+        start = bench_now_ms();
+        for (int i = 0; i < OBJECT_COUNT; i++) {
+            linear_hits += sphere_hits_box(center, radius, boxes[i][0], boxes[i][1]);
+        }
+        linear_ms += bench_now_ms() - start;
+    }
+
+    printf("  sphere query:     %8.4f ms (linear %8.4f ms) | hits %lu vs %lu\n",
+           bvh_ms / QUERY_COUNT, linear_ms / QUERY_COUNT, bvh_hits, linear_hits);
+
+    bvh_destroy(&bvh);
+    free(boxes);
+    free(ids);
+    free(handles);
+
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include "bench_common.h"
+#include "physics/physics.h"
+
+// Allocator benchmark: bodies of mixed sizes are removed and re-added every
+// tick, once with the pooled world arena and once with Bullet's heap allocator
+
+#define BODY_COUNT 2000
+#define CHURN_PER_STEP 64
+#define WARMUP_STEPS 60
+#define MEASURE_STEPS 600
+
+static btRigidBody* add_random_box(physics_world_t* world) {
+    vec3 pos = {
+        (float)(bench_rng_next() % 40) - 20.0f,
+        2.0f + (float)(bench_rng_next() % 30),
+        (float)(bench_rng_next() % 40) - 20.0f
+    };
+
+    // A handful of sizes: shapes are created and released as well
+    float edge = 0.5f + (float)(bench_rng_next() % 6) * 0.25f;
+
+    return physics_add_box(world, pos, (vec3){edge, edge, edge}, 1.0f);
+}
+
+static void run(const char* name, int heap_allocator) {
+    physics_world_config_t config = {0};
+    config.heap_allocator = heap_allocator;
+
+    physics_world_t world = physics_world_create_ex(&config);
+    btRigidBody** bodies = malloc(sizeof(btRigidBody*) * BODY_COUNT);
+
+    if (!bodies) {
+        fprintf(stderr, "Failed to allocate benchmark data\n");
+        physics_world_destroy(&world);
+        return;
+    }
+
+    bench_rng_seed(12345);
+    physics_add_box(&world, (vec3){0.0f, -0.5f, 0.0f}, (vec3){100.0f, 1.0f, 100.0f}, 0.0f);
+
+    for (unsigned int i = 0; i < BODY_COUNT; i++) {
+        bodies[i] = add_random_box(&world);
+    }
+
+    double step_ms = 0.0;
+    double churn_ms = 0.0;
+
+    for (unsigned int step = 0; step < WARMUP_STEPS + MEASURE_STEPS; step++) {
+        double start = bench_now_ms();
+
+        for (unsigned int i = 0; i < CHURN_PER_STEP; i++) {
+            unsigned int slot = bench_rng_next() % BODY_COUNT;
+
+            physics_remove_body(&world, bodies[slot]);
+            bodies[slot] = add_random_box(&world);
+        }
+
+        double churned = bench_now_ms();
+        physics_step_fixed(&world, 1);
+        double stepped = bench_now_ms();
+
+        if (step >= WARMUP_STEPS) {
+            churn_ms += churned - start;
+            step_ms += stepped - churned;
+        }
+    }
+
+    physics_alloc_stats_t stats = physics_get_alloc_stats(&world);
+
+    fprintf(stderr, "  %-6s step %7.3f ms | churn %7.3f ms | %llu allocs | live %u (%zu KB, peak %zu KB)\n",
+            name, step_ms / MEASURE_STEPS, churn_ms / MEASURE_STEPS, stats.allocations,
+            stats.live_allocations, stats.bytes_in_use / 1024, stats.peak_bytes / 1024);
+
+    if (stats.bytes_reserved > 0) {
+        fprintf(stderr, "         reserved %zu KB | free in pools %zu KB | fragmentation %.1f%%\n",
+                stats.bytes_reserved / 1024, stats.free_bytes / 1024, stats.fragmentation * 100.0f);
+    }
+
+    double destroy_start = bench_now_ms();
+    physics_world_destroy(&world);
+    fprintf(stderr, "         world destroy %.3f ms\n", bench_now_ms() - destroy_start);
+
+    free(bodies);
+}
+
+int main(void) {
+    fprintf(stderr, "Physics allocator benchmark: %d bodies | %d removed and added per step | %d steps\n",
+            BODY_COUNT, CHURN_PER_STEP, MEASURE_STEPS);
+
+    run("pooled", 0);
+    run("heap", 1);
+
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include "bench_common.h"
+#include "physics/physics.h"
+
+// Static baking benchmark: a level of static boxes with dynamic boxes falling
+// onto it, stepped and ray cast once with one body per box and once after
+// baking the boxes into compounds per streaming sector
+
+#define GRID_WIDTH 224 // 50176 static boxes
+#define GRID_SPACING 4.0f
+#define RAIN_COUNT 2000
+#define RAY_COUNT 10000
+#define WARMUP_STEPS 30
+#define MEASURE_STEPS 200
+
+static float level_extent(void) {
+    return GRID_WIDTH * GRID_SPACING;
+}
+
+static void build_level(physics_world_t* world) {
+    bench_rng_seed(12345);
+
+    // Varied heights still share a handful of cached shapes
+    for (unsigned int z = 0; z < GRID_WIDTH; z++) {
+        for (unsigned int x = 0; x < GRID_WIDTH; x++) {
+            float height = 1.0f + (float)(int)(bench_rng_float() * 4.0f);
+            vec3 position = {(float)x * GRID_SPACING, height * 0.5f, (float)z * GRID_SPACING};
+
+            physics_add_box(world, position, (vec3){GRID_SPACING, height, GRID_SPACING}, 0.0f);
+        }
+    }
+
+    bench_boxes_t rain = bench_boxes_alloc(RAIN_COUNT, "rain");
+
+    for (unsigned int i = 0; i < RAIN_COUNT; i++) {
+        rain.positions[i][0] = bench_rng_float() * level_extent();
+        rain.positions[i][1] = 8.0f + bench_rng_float() * 20.0f;
+        rain.positions[i][2] = bench_rng_float() * level_extent();
+        glm_vec3_fill(rain.sizes[i], 0.5f + bench_rng_float());
+    }
+
+    physics_add_boxes(world, RAIN_COUNT, rain.positions, rain.sizes, rain.masses, NULL, NULL);
+    bench_boxes_free(&rain);
+}
+
+static double cast_rays(physics_world_t* world, unsigned int* hit_count) {
+    physics_ray_t* rays = malloc(sizeof(physics_ray_t) * RAY_COUNT);
+    physics_hit_t* hits = malloc(sizeof(physics_hit_t) * RAY_COUNT);
+
+    if (!rays || !hits) {
+        fprintf(stderr, "Failed to allocate rays\n");
+        exit(1);
+    }
+
+    bench_rng_seed(777);
+
+    // Shallow rays across the level, each crosses many boxes before it hits
+    for (unsigned int i = 0; i < RAY_COUNT; i++) {
+        float x = bench_rng_float() * level_extent();
+        float z = bench_rng_float() * level_extent();
+
+        glm_vec3_copy((vec3){x, 6.0f, z}, rays[i].from);
+        glm_vec3_copy((vec3){x + (bench_rng_float() - 0.5f) * 100.0f, 0.0f, z + (bench_rng_float() - 0.5f) * 100.0f}, rays[i].to);
+    }
+
+    double start = bench_now_ms();
+    *hit_count = physics_raycast_batch(world, rays, RAY_COUNT, NULL, hits);
+    double elapsed = bench_now_ms() - start;
+
+    free(rays);
+    free(hits);
+
+    return elapsed;
+}
+
+static void run(const char* name, int baked) {
+    physics_world_t world = physics_world_create();
+    build_level(&world);
+
+    double bake_ms = 0.0;
+
+    if (baked) {
+        double start = bench_now_ms();
+        physics_bake_static(&world, (vec3){-1.0f, -1.0f, -1.0f}, (vec3){level_extent(), 10.0f, level_extent()}, 0.0f);
+        bake_ms = bench_now_ms() - start;
+    }
+
+    size_t bytes = physics_get_alloc_stats(&world).bytes_in_use;
+
+    physics_step_fixed(&world, WARMUP_STEPS);
+
+    double broadphase_ms = 0.0;
+    double start = bench_now_ms();
+
+    for (unsigned int step = 0; step < MEASURE_STEPS; step++) {
+        physics_step_fixed(&world, 1);
+        broadphase_ms += physics_get_broadphase_stats(&world).update_ms;
+    }
+
+    double step_ms = (bench_now_ms() - start) / MEASURE_STEPS;
+    physics_broadphase_stats_t stats = physics_get_broadphase_stats(&world);
+    unsigned int hit_count = 0;
+    double ray_ms = cast_rays(&world, &hit_count);
+
+    fprintf(stderr, "  %-10s step %7.3f ms | broadphase %7.3f ms | %6u proxies | %7.2f MB | rays %7.2f ms (%u hits) | bake %.2f ms\n",
+            name, step_ms, broadphase_ms / MEASURE_STEPS, stats.proxies, (double)bytes / (1024.0 * 1024.0), ray_ms,
+            hit_count, bake_ms);
+
+    physics_world_destroy(&world);
+}
+
+int main(void) {
+    fprintf(stderr, "Static baking benchmark: %u static boxes | %u dynamic | %u rays\n", GRID_WIDTH * GRID_WIDTH, RAIN_COUNT,
+            RAY_COUNT);
+
+    run("individual", 0);
+    run("baked", 1);
+
+    return 0;
+}
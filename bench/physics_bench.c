@@ -0,0 +1,115 @@
+#include "bench_common.h"
+#include "physics/physics.h"
+
+// Physics benchmark: collision shape sharing for many boxes and
+// bulk creation against one physics_add_box() call per body, and
+// transform export for instanced rendering
+
+#define BODY_COUNT 10000
+#define SIZE_VARIANTS 16
+#define BULK_COUNT 100000
+
+static void run_shapes(const char* name, int variants) {
+    physics_world_t world = physics_world_create();
+
+    double start = bench_now_ms();
+
+    for (int i = 0; i < BODY_COUNT; i++) {
+        vec3 pos = {(float)(i % 100) * 2.0f, 1.0f + (float)(i / 10000), (float)((i / 100) % 100) * 2.0f};
+        float s = 1.0f + 0.25f * (float)(i % variants);
+        vec3 size = {s, s, s};
+
+        physics_add_box(&world, pos, size, 1.0f);
+    }
+
+    double create_ms = bench_now_ms() - start;
+    physics_stats_t stats = physics_get_stats(&world);
+
+    fprintf(stderr, "  %-10s %u bodies | %u shapes | %zu bytes in shapes | %zu bytes saved | create %.2f ms\n",
+            name, stats.body_count, stats.shape_count, stats.shape_bytes, stats.shape_bytes_saved, create_ms);
+
+    physics_world_destroy(&world);
+}
+
+static void grid_position(int i, vec3 pos) {
+    pos[0] = (float)(i % 100) * 1.5f;
+    pos[1] = 0.5f + (float)(i / 10000) * 1.5f;
+    pos[2] = (float)((i / 100) % 100) * 1.5f;
+}
+
+static void run_creation(void) {
+    bench_boxes_t boxes = bench_boxes_alloc(BULK_COUNT, "benchmark data");
+
+    for (int i = 0; i < BULK_COUNT; i++) {
+        grid_position(i, boxes.positions[i]);
+    }
+
+    // One call per body
+    physics_world_t world = physics_world_create();
+    double start = bench_now_ms();
+
+    for (int i = 0; i < BULK_COUNT; i++) {
+        physics_add_box(&world, boxes.positions[i], boxes.sizes[i], boxes.masses[i]);
+    }
+
+    double single_ms = bench_now_ms() - start;
+
+    start = bench_now_ms();
+    physics_step_fixed(&world, 1);
+    double single_step_ms = bench_now_ms() - start;
+
+    physics_world_destroy(&world);
+
+    // One batch
+    world = physics_world_create();
+    start = bench_now_ms();
+
+    physics_add_boxes(&world, BULK_COUNT, boxes.positions, boxes.sizes, boxes.masses, NULL, NULL);
+
+    double bulk_ms = bench_now_ms() - start;
+
+    start = bench_now_ms();
+    physics_step_fixed(&world, 1);
+    double bulk_step_ms = bench_now_ms() - start;
+
+    // Export: first call writes everything, later calls only awake bodies
+    float* matrices = malloc(sizeof(mat4) * BULK_COUNT);
+    unsigned int* changed = malloc(sizeof(unsigned int) * BULK_COUNT);
+    double export_ms[2] = {0.0, 0.0};
+    unsigned int export_count[2] = {0, 0};
+
+    if (matrices && changed) {
+        for (int pass = 0; pass < 2; pass++) {
+            start = bench_now_ms();
+            export_count[pass] = physics_export_transforms(&world, matrices, BULK_COUNT, changed);
+            export_ms[pass] = bench_now_ms() - start;
+        }
+    }
+
+    free(matrices);
+    free(changed);
+
+    start = bench_now_ms();
+    physics_world_destroy(&world);
+    double destroy_ms = bench_now_ms() - start;
+
+    fprintf(stderr, "  creation   %d bodies | single %.2f ms | bulk %.2f ms | x%.1f\n",
+            BULK_COUNT, single_ms, bulk_ms, single_ms / bulk_ms);
+    fprintf(stderr, "  first step single %.2f ms | bulk %.2f ms | bulk destroy %.2f ms\n",
+            single_step_ms, bulk_step_ms, destroy_ms);
+    fprintf(stderr, "  export     %u matrices %.2f ms | again %u changed %.2f ms\n",
+            export_count[0], export_ms[0], export_count[1], export_ms[1]);
+
+    bench_boxes_free(&boxes);
+}
+
+int main(void) {
+    fprintf(stderr, "Physics shape benchmark: %d boxes\n", BODY_COUNT);
+
+    run_shapes("identical", 1);
+    run_shapes("variants", SIZE_VARIANTS);
+
+    run_creation();
+
+    return 0;
+}
@@ -0,0 +1,108 @@
+#include "bench_common.h"
+#include "physics/physics.h"
+
+// Broadphase benchmark: boxes rain onto a large level, stepped once with the
+// dynamic AABB tree and once with sweep and prune, then again with everything
+// but the sectors around the origin unloaded
+
+#define BODY_COUNT 20000
+#define LEVEL_EXTENT 900.0f
+#define WARMUP_STEPS 60
+#define MEASURE_STEPS 300
+#define SECTOR_SIZE 64.0f
+#define LOADED_RADIUS 2 // Sectors kept around the origin on each side
+
+static void build_level(physics_world_t* world) {
+    bench_boxes_t boxes = bench_boxes_alloc(BODY_COUNT, "level");
+
+    bench_rng_seed(12345);
+
+    for (unsigned int i = 0; i < BODY_COUNT; i++) {
+        boxes.positions[i][0] = (bench_rng_float() * 2.0f - 1.0f) * LEVEL_EXTENT;
+        boxes.positions[i][1] = 1.0f + bench_rng_float() * 20.0f;
+        boxes.positions[i][2] = (bench_rng_float() * 2.0f - 1.0f) * LEVEL_EXTENT;
+        glm_vec3_fill(boxes.sizes[i], 0.5f + bench_rng_float());
+    }
+
+    // One ground tile per sector, so unloading a sector takes its floor along
+    int tiles = (int)(LEVEL_EXTENT / SECTOR_SIZE) + 1;
+
+    for (int z = -tiles; z < tiles; z++) {
+        for (int x = -tiles; x < tiles; x++) {
+            vec3 center = {((float)x + 0.5f) * SECTOR_SIZE, -0.5f, ((float)z + 0.5f) * SECTOR_SIZE};
+            physics_add_box(world, center, (vec3){SECTOR_SIZE, 1.0f, SECTOR_SIZE}, 0.0f);
+        }
+    }
+
+    physics_add_boxes(world, BODY_COUNT, boxes.positions, boxes.sizes, boxes.masses, NULL, NULL);
+
+    bench_boxes_free(&boxes);
+}
+
+static void measure(const char* name, physics_world_t* world) {
+    double broadphase_ms = 0.0;
+    double start = bench_now_ms();
+
+    for (unsigned int step = 0; step < MEASURE_STEPS; step++) {
+        physics_step_fixed(world, 1);
+        broadphase_ms += physics_get_broadphase_stats(world).update_ms;
+    }
+
+    double step_ms = (bench_now_ms() - start) / MEASURE_STEPS;
+    physics_broadphase_stats_t stats = physics_get_broadphase_stats(world);
+
+    fprintf(stderr, "  %-10s step %7.3f ms | broadphase %7.3f ms (pairs %6.3f ms) | %5u proxies | %6u pairs | %5u updates | %5u parked\n",
+            name, step_ms, broadphase_ms / MEASURE_STEPS, stats.pairs_ms, stats.proxies, stats.pairs, stats.aabb_updates,
+            stats.parked_bodies);
+}
+
+static void run(const char* name, physics_broadphase_type_t type) {
+    physics_world_config_t config = {0};
+    config.broadphase = type;
+    config.sector_size = SECTOR_SIZE;
+
+    physics_world_t world = physics_world_create_ex(&config);
+    build_level(&world);
+    physics_step_fixed(&world, WARMUP_STEPS);
+    measure(name, &world);
+
+    // Stream out the outer sectors
+    int tiles = (int)(LEVEL_EXTENT / SECTOR_SIZE) + 1;
+    unsigned int parked = 0;
+    double start = bench_now_ms();
+
+    for (int z = -tiles; z < tiles; z++) {
+        for (int x = -tiles; x < tiles; x++) {
+            if (abs(x) > LOADED_RADIUS || abs(z) > LOADED_RADIUS) {
+                parked += physics_sector_unload(&world, x, z);
+            }
+        }
+    }
+
+    double unload_ms = bench_now_ms() - start;
+    measure("streamed", &world);
+
+    unsigned int restored = 0;
+    start = bench_now_ms();
+
+    for (int z = -tiles; z < tiles; z++) {
+        for (int x = -tiles; x < tiles; x++) {
+            restored += physics_sector_load(&world, x, z);
+        }
+    }
+
+    double load_ms = bench_now_ms() - start;
+
+    fprintf(stderr, "  %-10s unload %u bodies %.2f ms | load %u bodies %.2f ms\n", "", parked, unload_ms, restored, load_ms);
+
+    physics_world_destroy(&world);
+}
+
+int main(void) {
+    fprintf(stderr, "Broadphase benchmark: %u boxes over %.0f x %.0f m\n", BODY_COUNT, LEVEL_EXTENT * 2.0f, LEVEL_EXTENT * 2.0f);
+
+    run("dbvt", PHYSICS_BROADPHASE_DBVT);
+    run("sap", PHYSICS_BROADPHASE_SAP);
+
+    return 0;
+}
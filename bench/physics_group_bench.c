@@ -0,0 +1,74 @@
+#include "bench_common.h"
+#include <unistd.h>
+
+#include "core/jobs.h"
+#include "physics/physics.h"
+
+// World group benchmark: many small rooms of uneven size, as on a match
+// server, stepped together with 1..N job threads
+
+#define ROOM_COUNT 64
+#define ROOM_BOXES 150
+#define LARGE_ROOM_BOXES 1200 // Every 8th room, the long jobs to balance
+#define WARMUP_STEPS 30
+#define MEASURE_STEPS 240
+
+static double run(unsigned int threads, double* longest_ms) {
+    static physics_world_t rooms[ROOM_COUNT];
+
+    jobs_init(threads);
+
+    physics_world_group_t* group = physics_world_group_create(threads);
+
+    for (unsigned int i = 0; i < ROOM_COUNT; i++) {
+        rooms[i] = physics_world_create();
+        bench_add_pile(&rooms[i], i % 8 == 7 ? LARGE_ROOM_BOXES : ROOM_BOXES, 10);
+        physics_world_group_add(group, &rooms[i]);
+    }
+
+    physics_world_group_step_fixed(group, WARMUP_STEPS);
+
+    double start = bench_now_ms();
+    double longest = 0.0;
+
+    for (unsigned int step = 0; step < MEASURE_STEPS; step++) {
+        physics_world_group_step_fixed(group, 1);
+        longest += physics_world_group_get_stats(group).longest_ms;
+    }
+
+    double step_ms = (bench_now_ms() - start) / MEASURE_STEPS;
+    *longest_ms = longest / MEASURE_STEPS;
+
+    physics_world_group_destroy(group);
+
+    for (unsigned int i = 0; i < ROOM_COUNT; i++) {
+        physics_world_destroy(&rooms[i]);
+    }
+
+    jobs_shutdown();
+
+    return step_ms;
+}
+
+int main(int argc, char** argv) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned int max_threads = argc > 1 ? (unsigned int)atoi(argv[1]) : (unsigned int)(cores > 0 ? cores : 1);
+
+    fprintf(stderr, "World group benchmark: %u rooms | %u steps\n", ROOM_COUNT, MEASURE_STEPS);
+
+    double base_ms = 0.0;
+
+    for (unsigned int threads = 1; threads <= max_threads; threads++) {
+        double longest_ms;
+        double step_ms = run(threads, &longest_ms);
+
+        if (threads == 1) {
+            base_ms = step_ms;
+        }
+
+        fprintf(stderr, "  %2u threads: %8.3f ms/step | speedup x%.2f | slowest room %.3f ms\n",
+                threads, step_ms, base_ms / step_ms, longest_ms);
+    }
+
+    return 0;
+}
@@ -0,0 +1,126 @@
+#define _POSIX_C_SOURCE 200809L
+#include "bench_common.h"
+#include <string.h>
+#include <math.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "physics/physics.h"
+
+// Convex hull benchmark: a detailed torus is turned into a single hull and
+// into a decomposed compound, without a cache, with a cold and a warm one.
+// A ray dropped through the ring's hole tells whether the hole survived
+
+#define RING_SEGMENTS 128
+#define TUBE_SEGMENTS 48
+#define RING_RADIUS 2.0f
+#define TUBE_RADIUS 0.5f
+#define CACHE_DIR "physics_hull_bench_cache"
+
+static void build_torus(float* positions, unsigned int* indices) {
+    for (unsigned int ring = 0; ring < RING_SEGMENTS; ring++) {
+        float u = (float)ring / RING_SEGMENTS * 2.0f * GLM_PIf;
+
+        for (unsigned int tube = 0; tube < TUBE_SEGMENTS; tube++) {
+            float v = (float)tube / TUBE_SEGMENTS * 2.0f * GLM_PIf;
+            float* p = &positions[(ring * TUBE_SEGMENTS + tube) * 3];
+
+            p[0] = (RING_RADIUS + TUBE_RADIUS * cosf(v)) * cosf(u);
+            p[1] = TUBE_RADIUS * sinf(v);
+            p[2] = (RING_RADIUS + TUBE_RADIUS * cosf(v)) * sinf(u);
+        }
+    }
+
+    unsigned int n = 0;
+
+    for (unsigned int ring = 0; ring < RING_SEGMENTS; ring++) {
+        for (unsigned int tube = 0; tube < TUBE_SEGMENTS; tube++) {
+            unsigned int a = ring * TUBE_SEGMENTS + tube;
+            unsigned int b = ((ring + 1) % RING_SEGMENTS) * TUBE_SEGMENTS + tube;
+            unsigned int c = ((ring + 1) % RING_SEGMENTS) * TUBE_SEGMENTS + (tube + 1) % TUBE_SEGMENTS;
+            unsigned int d = ring * TUBE_SEGMENTS + (tube + 1) % TUBE_SEGMENTS;
+
+            indices[n++] = a;
+            indices[n++] = b;
+            indices[n++] = c;
+            indices[n++] = a;
+            indices[n++] = c;
+            indices[n++] = d;
+        }
+    }
+}
+
+static void clear_cache(void) {
+    DIR* dir = opendir(CACHE_DIR);
+
+    if (!dir) {
+        return;
+    }
+
+    struct dirent* entry;
+    char path[512];
+
+    while ((entry = readdir(dir)) != NULL) {
+        if (strstr(entry->d_name, ".hull")) {
+            snprintf(path, sizeof(path), "%s/%s", CACHE_DIR, entry->d_name);
+            remove(path);
+        }
+    }
+
+    closedir(dir);
+}
+
+static void run(const char* name, const float* positions, const unsigned int* indices, unsigned int max_pieces, const char* cache_dir) {
+    physics_world_t world = physics_world_create();
+    unsigned int vertex_count = RING_SEGMENTS * TUBE_SEGMENTS;
+    unsigned int index_count = RING_SEGMENTS * TUBE_SEGMENTS * 6;
+
+    physics_hull_params_t params = {0};
+    params.max_vertices = 32;
+    params.max_pieces = max_pieces;
+
+    double start = bench_now_ms();
+    btRigidBody* body = physics_add_convex_hull(&world, (vec3){0.0f, 0.0f, 0.0f}, 0.0f, positions, vertex_count, indices,
+                                                index_count, &params, cache_dir, NULL);
+    double elapsed = bench_now_ms() - start;
+
+    // Straight down through the middle of the ring
+    physics_ray_t ray = {{0.0f, 5.0f, 0.0f}, {0.0f, -5.0f, 0.0f}};
+    physics_hit_t hit;
+    unsigned int hole_blocked = physics_raycast_batch(&world, &ray, 1, NULL, &hit);
+
+    fprintf(stderr, "  %-24s %9.2f ms | hole %s%s\n", name, elapsed, hole_blocked ? "filled" : "open", body ? "" : " | FAILED");
+
+    physics_world_destroy(&world);
+}
+
+int main(void) {
+    unsigned int vertex_count = RING_SEGMENTS * TUBE_SEGMENTS;
+    unsigned int index_count = RING_SEGMENTS * TUBE_SEGMENTS * 6;
+    float* positions = malloc(sizeof(float) * 3 * vertex_count);
+    unsigned int* indices = malloc(sizeof(unsigned int) * index_count);
+
+    if (!positions || !indices) {
+        fprintf(stderr, "Failed to allocate torus\n");
+        return 1;
+    }
+
+    build_torus(positions, indices);
+    mkdir(CACHE_DIR, 0755);
+    clear_cache();
+
+    fprintf(stderr, "Convex hull benchmark: %u vertices | %u triangles\n", vertex_count, index_count / 3);
+
+    run("single hull", positions, indices, 1, NULL);
+    run("decomposed, no cache", positions, indices, 16, NULL);
+    run("decomposed, cold cache", positions, indices, 16, CACHE_DIR);
+    run("decomposed, warm cache", positions, indices, 16, CACHE_DIR);
+
+    clear_cache();
+    rmdir(CACHE_DIR);
+    free(positions);
+    free(indices);
+
+    return 0;
+}
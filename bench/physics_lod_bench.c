@@ -0,0 +1,87 @@
+#include "bench_common.h"
+#include "physics/physics.h"
+
+// Physics LOD benchmark: small piles scattered over an open world, kept
+// moving by periodic kicks, stepped with LOD off and on around the origin
+
+#define PILE_COUNT 1600 // 40 x 40 piles
+#define PILE_BOXES 12
+#define PILE_SPACING 25.0f
+#define WARMUP_STEPS 60
+#define MEASURE_STEPS 600
+#define KICK_INTERVAL 120
+
+static btRigidBody** build_world(physics_world_t* world) {
+    unsigned int count = PILE_COUNT * PILE_BOXES;
+    bench_boxes_t boxes = bench_boxes_alloc(count, "world");
+    btRigidBody** bodies = malloc(sizeof(btRigidBody*) * count);
+
+    if (!bodies) {
+        fprintf(stderr, "Failed to allocate world\n");
+        exit(1);
+    }
+
+    for (unsigned int i = 0; i < count; i++) {
+        unsigned int pile = i / PILE_BOXES;
+        unsigned int box = i % PILE_BOXES;
+
+        boxes.positions[i][0] = ((float)(pile % 40) - 19.5f) * PILE_SPACING + (float)(box % 2) * 0.3f;
+        boxes.positions[i][1] = 0.5f + (float)box * 1.05f;
+        boxes.positions[i][2] = ((float)(pile / 40) - 19.5f) * PILE_SPACING;
+    }
+
+    physics_add_box(world, (vec3){0.0f, -0.5f, 0.0f}, (vec3){1200.0f, 1.0f, 1200.0f}, 0.0f);
+    physics_add_boxes(world, count, boxes.positions, boxes.sizes, boxes.masses, NULL, bodies);
+
+    bench_boxes_free(&boxes);
+
+    return bodies;
+}
+
+static void run(const char* name, const physics_lod_config_t* lod) {
+    physics_world_t world = physics_world_create();
+    btRigidBody** bodies = build_world(&world);
+
+    if (lod) {
+        physics_lod_enable(&world, lod);
+        physics_lod_set_focus(&world, (vec3){0.0f, 0.0f, 0.0f});
+    }
+
+    physics_step_fixed(&world, WARMUP_STEPS);
+
+    double start = bench_now_ms();
+
+    for (unsigned int step = 0; step < MEASURE_STEPS; step++) {
+        // Knock the top box of every pile so nothing settles for good
+        if (step % KICK_INTERVAL == 0) {
+            for (unsigned int pile = 0; pile < PILE_COUNT; pile++) {
+                physics_apply_central_impulse(bodies[pile * PILE_BOXES + PILE_BOXES - 1], (vec3){2.0f, 0.0f, 0.0f});
+            }
+        }
+
+        physics_step_fixed(&world, 1);
+    }
+
+    double step_ms = (bench_now_ms() - start) / MEASURE_STEPS;
+    physics_stats_t stats = physics_get_stats(&world);
+
+    fprintf(stderr, "  %-8s step %7.3f ms | %5u reduced | %5u frozen\n", name, step_ms, stats.lod_reduced, stats.lod_frozen);
+
+    free(bodies);
+    physics_world_destroy(&world);
+}
+
+int main(void) {
+    fprintf(stderr, "Physics LOD benchmark: %u bodies over %.0f x %.0f m\n",
+            PILE_COUNT * PILE_BOXES, PILE_SPACING * 40.0f, PILE_SPACING * 40.0f);
+
+    physics_lod_config_t lod = {0};
+    lod.reduced_distance = 100.0f;
+    lod.frozen_distance = 200.0f;
+    lod.extrapolation_time = 0.5f;
+
+    run("lod off", NULL);
+    run("lod on", &lod);
+
+    return 0;
+}
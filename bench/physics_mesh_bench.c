@@ -0,0 +1,102 @@
+#include "bench_common.h"
+#include <math.h>
+
+#include "physics/physics.h"
+
+// Static mesh startup benchmark: a large heightfield-like terrain is turned
+// into collision without a BVH cache, with a cold cache and with a warm one
+
+#define GRID 512
+#define CELL 0.5f
+#define CACHE_PATH "physics_mesh_bench.bvh"
+#define PROBE_COUNT 1024
+
+static void build_terrain(float* positions, unsigned int* indices) {
+    for (unsigned int z = 0; z <= GRID; z++) {
+        for (unsigned int x = 0; x <= GRID; x++) {
+            float* p = &positions[(z * (GRID + 1) + x) * 3];
+
+            p[0] = (float)x * CELL;
+            p[1] = sinf((float)x * 0.05f) * cosf((float)z * 0.07f) * 4.0f;
+            p[2] = (float)z * CELL;
+        }
+    }
+
+    unsigned int n = 0;
+
+    for (unsigned int z = 0; z < GRID; z++) {
+        for (unsigned int x = 0; x < GRID; x++) {
+            unsigned int i = z * (GRID + 1) + x;
+
+            indices[n++] = i;
+            indices[n++] = i + GRID + 1;
+            indices[n++] = i + 1;
+            indices[n++] = i + 1;
+            indices[n++] = i + GRID + 1;
+            indices[n++] = i + GRID + 2;
+        }
+    }
+}
+
+static double run(const char* name, const float* positions, const unsigned int* indices, const char* cache_path) {
+    physics_world_t world = physics_world_create();
+    unsigned int vertex_count = (GRID + 1) * (GRID + 1);
+    unsigned int index_count = GRID * GRID * 6;
+
+    double start = bench_now_ms();
+    btRigidBody* body = physics_add_static_mesh(&world, (vec3){0.0f, 0.0f, 0.0f}, positions, vertex_count, indices, index_count, cache_path);
+    double elapsed = bench_now_ms() - start;
+
+    // Probe straight down over the terrain: every ray must land, cached or not
+    physics_ray_t rays[PROBE_COUNT];
+    physics_hit_t hits[PROBE_COUNT];
+
+    for (unsigned int i = 0; i < PROBE_COUNT; i++) {
+        float x = (float)(i % 32) * GRID * CELL / 32.0f + 1.0f;
+        float z = (float)(i / 32) * GRID * CELL / 32.0f + 1.0f;
+
+        rays[i].from[0] = x;
+        rays[i].from[1] = 50.0f;
+        rays[i].from[2] = z;
+        rays[i].to[0] = x;
+        rays[i].to[1] = -50.0f;
+        rays[i].to[2] = z;
+    }
+
+    unsigned int hit_count = physics_raycast_batch(&world, rays, PROBE_COUNT, NULL, hits);
+
+    fprintf(stderr, "  %-12s %9.2f ms | %u/%u probes hit%s\n", name, elapsed, hit_count, PROBE_COUNT, body ? "" : " | FAILED");
+
+    physics_world_destroy(&world);
+
+    return elapsed;
+}
+
+int main(void) {
+    unsigned int vertex_count = (GRID + 1) * (GRID + 1);
+    unsigned int index_count = GRID * GRID * 6;
+    float* positions = malloc(sizeof(float) * 3 * vertex_count);
+    unsigned int* indices = malloc(sizeof(unsigned int) * index_count);
+
+    if (!positions || !indices) {
+        fprintf(stderr, "Failed to allocate terrain\n");
+        return 1;
+    }
+
+    build_terrain(positions, indices);
+    remove(CACHE_PATH);
+
+    fprintf(stderr, "Static mesh benchmark: %u vertices | %u triangles\n", vertex_count, index_count / 3);
+
+    double uncached = run("no cache", positions, indices, NULL);
+    run("cold cache", positions, indices, CACHE_PATH);
+    double warm = run("warm cache", positions, indices, CACHE_PATH);
+
+    fprintf(stderr, "  Startup speedup with a warm cache: x%.1f\n", uncached / warm);
+
+    remove(CACHE_PATH);
+    free(positions);
+    free(indices);
+
+    return 0;
+}
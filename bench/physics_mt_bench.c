@@ -0,0 +1,57 @@
+#include "bench_common.h"
+#include <unistd.h>
+
+#include "core/jobs.h"
+#include "physics/physics.h"
+
+// Multithreaded physics benchmark: a large pile of boxes settling on a
+// static floor, stepped with 1..N job threads
+
+#define PILE_WIDTH 24
+#define PILE_HEIGHT 20
+#define WARMUP_STEPS 30
+#define MEASURE_STEPS 240
+
+static double run(unsigned int threads) {
+    physics_world_config_t config = {0};
+    config.multithreaded = 1;
+    config.thread_count = threads;
+
+    jobs_init(threads);
+
+    physics_world_t world = physics_world_create_ex(&config);
+    bench_add_pile(&world, PILE_WIDTH * PILE_WIDTH * PILE_HEIGHT, PILE_WIDTH);
+
+    physics_step_fixed(&world, WARMUP_STEPS);
+
+    double start = bench_now_ms();
+    physics_step_fixed(&world, MEASURE_STEPS);
+    double step_ms = (bench_now_ms() - start) / MEASURE_STEPS;
+
+    physics_world_destroy(&world);
+    jobs_shutdown();
+
+    return step_ms;
+}
+
+int main(int argc, char** argv) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned int max_threads = argc > 1 ? (unsigned int)atoi(argv[1]) : (unsigned int)(cores > 0 ? cores : 1);
+
+    fprintf(stderr, "Physics scaling benchmark: %d boxes | %d steps\n",
+            PILE_WIDTH * PILE_WIDTH * PILE_HEIGHT, MEASURE_STEPS);
+
+    double base_ms = 0.0;
+
+    for (unsigned int threads = 1; threads <= max_threads; threads++) {
+        double step_ms = run(threads);
+
+        if (threads == 1) {
+            base_ms = step_ms;
+        }
+
+        fprintf(stderr, "  %2u threads: %8.3f ms/step | speedup x%.2f\n", threads, step_ms, base_ms / step_ms);
+    }
+
+    return 0;
+}
@@ -0,0 +1,58 @@
+#include "bench_common.h"
+#include "physics/physics.h"
+
+// Phase profiling benchmark: a collapsing box pile stepped with profiling
+// off and on, for the overhead, then the per-phase breakdown
+
+#define PILE_WIDTH 20
+#define PILE_HEIGHT 10
+#define MEASURE_STEPS 300
+
+static const char* phase_names[PHYSICS_PHASE_COUNT] = {"broadphase", "narrowphase", "islands", "solver", "integration"};
+
+static double run(int profiled, double* phase_ms, physics_profile_t* last) {
+    physics_world_t world = physics_world_create();
+    bench_add_pile(&world, PILE_WIDTH * PILE_WIDTH * PILE_HEIGHT, PILE_WIDTH);
+    physics_profile_enable(&world, profiled);
+
+    double start = bench_now_ms();
+
+    for (unsigned int step = 0; step < MEASURE_STEPS; step++) {
+        physics_step_fixed(&world, 1);
+
+        physics_profile_t profile = physics_get_profile(&world);
+
+        for (int phase = 0; phase < PHYSICS_PHASE_COUNT; phase++) {
+            phase_ms[phase] += profile.phase_ms[phase];
+        }
+    }
+
+    double step_ms = (bench_now_ms() - start) / MEASURE_STEPS;
+
+    *last = physics_get_profile(&world);
+    physics_world_destroy(&world);
+
+    return step_ms;
+}
+
+int main(void) {
+    double phase_ms[PHYSICS_PHASE_COUNT] = {0};
+    physics_profile_t last;
+
+    fprintf(stderr, "Phase profiling benchmark: %u boxes | %u steps\n", PILE_WIDTH * PILE_WIDTH * PILE_HEIGHT, MEASURE_STEPS);
+
+    double off_ms = run(0, phase_ms, &last);
+    double on_ms = run(1, phase_ms, &last);
+
+    fprintf(stderr, "  profiling off %7.3f ms/step | on %7.3f ms/step | overhead %+.1f%%\n",
+            off_ms, on_ms, (on_ms / off_ms - 1.0) * 100.0);
+
+    for (int phase = 0; phase < PHYSICS_PHASE_COUNT; phase++) {
+        fprintf(stderr, "  %-12s %7.3f ms/step\n", phase_names[phase], phase_ms[phase] / MEASURE_STEPS);
+    }
+
+    fprintf(stderr, "  last step: %u pairs | %u manifolds | %u contacts | %u islands | %u active bodies\n",
+            last.pairs, last.manifolds, last.contacts, last.islands, last.active_bodies);
+
+    return 0;
+}
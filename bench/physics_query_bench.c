@@ -0,0 +1,112 @@
+#include "bench_common.h"
+#include "core/jobs.h"
+#include "physics/physics.h"
+
+// Query throughput benchmark: random rays and sphere sweeps through a field
+// of scattered boxes, closest-hit and any-hit
+
+#define FIELD_SIZE 100.0f
+#define BOX_COUNT 10000
+#define QUERY_COUNT 100000
+#define REPEATS 5
+
+static float random_range(float min, float max) {
+    return min + (max - min) * ((float)rand() / (float)RAND_MAX);
+}
+
+static void build_field(physics_world_t* world) {
+    bench_boxes_t boxes = bench_boxes_alloc(BOX_COUNT, "benchmark data");
+
+    for (unsigned int i = 0; i < BOX_COUNT; i++) {
+        boxes.positions[i][0] = random_range(-FIELD_SIZE, FIELD_SIZE);
+        boxes.positions[i][1] = random_range(0.0f, 20.0f);
+        boxes.positions[i][2] = random_range(-FIELD_SIZE, FIELD_SIZE);
+        boxes.sizes[i][0] = random_range(0.5f, 3.0f);
+        boxes.sizes[i][1] = random_range(0.5f, 3.0f);
+        boxes.sizes[i][2] = random_range(0.5f, 3.0f);
+        boxes.masses[i] = 0.0f; // Static: the field doesn't move between repeats
+    }
+
+    physics_add_boxes(world, BOX_COUNT, boxes.positions, boxes.sizes, boxes.masses, NULL, NULL);
+
+    bench_boxes_free(&boxes);
+}
+
+static void report(const char* name, double ms, unsigned int hits) {
+    double per_second = (double)QUERY_COUNT * REPEATS / (ms / 1000.0);
+
+    fprintf(stderr, "  %-16s %8.2f ms | %6.2f M queries/s | %5.1f%% hit\n",
+            name, ms / REPEATS, per_second / 1e6, 100.0 * hits / QUERY_COUNT);
+}
+
+int main(void) {
+    jobs_init(0);
+    srand(42);
+
+    physics_world_t world = physics_world_create();
+    build_field(&world);
+
+    physics_ray_t* rays = malloc(sizeof(physics_ray_t) * QUERY_COUNT);
+    physics_sweep_t* sweeps = malloc(sizeof(physics_sweep_t) * QUERY_COUNT);
+    physics_hit_t* hits = malloc(sizeof(physics_hit_t) * QUERY_COUNT);
+
+    if (!rays || !sweeps || !hits) {
+        fprintf(stderr, "Failed to allocate queries\n");
+        return 1;
+    }
+
+    // Mixed lengths: short AI and gameplay probes and long visibility rays
+    for (unsigned int i = 0; i < QUERY_COUNT; i++) {
+        vec3 from = {random_range(-FIELD_SIZE, FIELD_SIZE), random_range(0.0f, 20.0f), random_range(-FIELD_SIZE, FIELD_SIZE)};
+        vec3 dir = {random_range(-1.0f, 1.0f), random_range(-0.3f, 0.3f), random_range(-1.0f, 1.0f)};
+        float length = (i % 4 == 0) ? 80.0f : 10.0f;
+
+        glm_vec3_normalize(dir);
+        glm_vec3_copy(from, rays[i].from);
+        glm_vec3_muladds(dir, length, from);
+        glm_vec3_copy(from, rays[i].to);
+
+        glm_vec3_copy(rays[i].from, sweeps[i].from);
+        glm_vec3_copy(rays[i].to, sweeps[i].to);
+        sweeps[i].radius = 0.25f;
+    }
+
+    fprintf(stderr, "Physics query benchmark: %d boxes | %d queries | %u threads\n",
+            BOX_COUNT, QUERY_COUNT, jobs_thread_count());
+
+    physics_query_params_t closest = {PHYSICS_QUERY_CLOSEST, 0, 0};
+    physics_query_params_t any = {PHYSICS_QUERY_ANY, 0, 0};
+    unsigned int hit_count = 0;
+
+    double start = bench_now_ms();
+    for (int r = 0; r < REPEATS; r++) {
+        hit_count = physics_raycast_batch(&world, rays, QUERY_COUNT, &closest, hits);
+    }
+    report("rays closest", bench_now_ms() - start, hit_count);
+
+    start = bench_now_ms();
+    for (int r = 0; r < REPEATS; r++) {
+        hit_count = physics_raycast_batch(&world, rays, QUERY_COUNT, &any, hits);
+    }
+    report("rays any", bench_now_ms() - start, hit_count);
+
+    start = bench_now_ms();
+    for (int r = 0; r < REPEATS; r++) {
+        hit_count = physics_sweep_sphere_batch(&world, sweeps, QUERY_COUNT, &closest, hits);
+    }
+    report("sweeps closest", bench_now_ms() - start, hit_count);
+
+    start = bench_now_ms();
+    for (int r = 0; r < REPEATS; r++) {
+        hit_count = physics_sweep_sphere_batch(&world, sweeps, QUERY_COUNT, &any, hits);
+    }
+    report("sweeps any", bench_now_ms() - start, hit_count);
+
+    free(rays);
+    free(sweeps);
+    free(hits);
+    physics_world_destroy(&world);
+    jobs_shutdown();
+
+    return 0;
+}
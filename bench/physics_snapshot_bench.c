@@ -0,0 +1,136 @@
+#include "bench_common.h"
+#include <math.h>
+
+#include "physics/physics.h"
+
+// Snapshot benchmark: a settled pile of boxes is saved and restored as full
+// and delta snapshots, then a replay from a snapshot is compared to the original run
+
+#define BODY_COUNT 10000
+#define SETTLE_STEPS 240
+#define REPEATS 50
+#define REPLAY_STEPS 60
+
+static void build_pile(physics_world_t* world, btRigidBody** bodies) {
+    bench_boxes_t boxes = bench_boxes_alloc(BODY_COUNT, "pile");
+
+    // 50x50 columns, 4 boxes high, with a small offset per layer so the pile keeps moving a bit
+    for (unsigned int i = 0; i < BODY_COUNT; i++) {
+        unsigned int column = i % 2500;
+        unsigned int layer = i / 2500;
+
+        boxes.positions[i][0] = (float)(column % 50) * 1.1f - 27.5f + (float)layer * 0.2f;
+        boxes.positions[i][1] = 0.5f + (float)layer * 1.05f;
+        boxes.positions[i][2] = (float)(column / 50) * 1.1f - 27.5f;
+    }
+
+    physics_add_box(world, (vec3){0.0f, -0.5f, 0.0f}, (vec3){200.0f, 1.0f, 200.0f}, 0.0f);
+    physics_add_boxes(world, BODY_COUNT, boxes.positions, boxes.sizes, boxes.masses, NULL, bodies);
+
+    bench_boxes_free(&boxes);
+}
+
+static void read_positions(btRigidBody** bodies, vec3* out) {
+    mat4 rotation;
+
+    for (unsigned int i = 0; i < BODY_COUNT; i++) {
+        physics_get_transform(bodies[i], out[i], rotation);
+    }
+}
+
+int main(void) {
+    physics_world_t world = physics_world_create();
+    btRigidBody** bodies = malloc(sizeof(btRigidBody*) * BODY_COUNT);
+    vec3* expected = malloc(sizeof(vec3) * BODY_COUNT);
+    vec3* replayed = malloc(sizeof(vec3) * BODY_COUNT);
+
+    if (!bodies || !expected || !replayed) {
+        fprintf(stderr, "Failed to allocate benchmark data\n");
+        return 1;
+    }
+
+    build_pile(&world, bodies);
+    physics_step_fixed(&world, SETTLE_STEPS);
+
+    // Sized after settling: the bound depends on the live manifold count
+    size_t capacity = physics_snapshot_size(&world) * 2;
+    void* full = aligned_alloc(16, (capacity + 15) & ~(size_t)15);
+    void* delta = aligned_alloc(16, (capacity + 15) & ~(size_t)15);
+
+    if (!full || !delta) {
+        fprintf(stderr, "Failed to allocate snapshot buffers\n");
+        return 1;
+    }
+
+    size_t full_size = 0;
+    double start = bench_now_ms();
+
+    for (unsigned int i = 0; i < REPEATS; i++) {
+        full_size = physics_snapshot_save(&world, full, capacity, NULL);
+    }
+
+    double full_save_ms = (bench_now_ms() - start) / REPEATS;
+
+    physics_step_fixed(&world, 1);
+
+    size_t delta_size = 0;
+    start = bench_now_ms();
+
+    for (unsigned int i = 0; i < REPEATS; i++) {
+        delta_size = physics_snapshot_save(&world, delta, capacity, full);
+    }
+
+    double delta_save_ms = (bench_now_ms() - start) / REPEATS;
+
+    start = bench_now_ms();
+
+    for (unsigned int i = 0; i < REPEATS; i++) {
+        physics_snapshot_restore(&world, full, full_size, NULL);
+    }
+
+    double full_restore_ms = (bench_now_ms() - start) / REPEATS;
+
+    start = bench_now_ms();
+
+    for (unsigned int i = 0; i < REPEATS; i++) {
+        physics_snapshot_restore(&world, delta, delta_size, full);
+    }
+
+    double delta_restore_ms = (bench_now_ms() - start) / REPEATS;
+
+    if (full_size == 0 || delta_size == 0) {
+        fprintf(stderr, "Snapshot failed\n");
+        return 1;
+    }
+
+    // Replay: run from the delta state, rewind, run again and compare
+    physics_step_fixed(&world, REPLAY_STEPS);
+    read_positions(bodies, expected);
+    physics_snapshot_restore(&world, delta, delta_size, full);
+    physics_step_fixed(&world, REPLAY_STEPS);
+    read_positions(bodies, replayed);
+
+    float deviation = 0.0f;
+
+    for (unsigned int i = 0; i < BODY_COUNT; i++) {
+        deviation = fmaxf(deviation, glm_vec3_distance(expected[i], replayed[i]));
+    }
+
+    physics_stats_t stats = physics_get_stats(&world);
+
+    fprintf(stderr, "Snapshot benchmark: %u bodies\n", stats.body_count);
+    fprintf(stderr, "  full save     %8.3f ms | %7zu KB\n", full_save_ms, full_size / 1024);
+    fprintf(stderr, "  delta save    %8.3f ms | %7zu KB\n", delta_save_ms, delta_size / 1024);
+    fprintf(stderr, "  full restore  %8.3f ms\n", full_restore_ms);
+    fprintf(stderr, "  delta restore %8.3f ms\n", delta_restore_ms);
+    fprintf(stderr, "  Replay of %u steps: max deviation %.6f\n", REPLAY_STEPS, deviation);
+
+    free(full);
+    free(delta);
+    free(bodies);
+    free(expected);
+    free(replayed);
+    physics_world_destroy(&world);
+
+    return 0;
+}
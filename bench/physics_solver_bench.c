@@ -0,0 +1,104 @@
+#include "bench_common.h"
+#include <math.h>
+
+#include "physics/physics.h"
+
+// Constraint solver benchmark: rows of tall single box towers, stepped with
+// every solver backend at a few iteration budgets. Stability is how far the
+// tower tops drifted and how many towers fell, against the step time
+
+#define TOWER_COUNT 32
+#define TOWER_HEIGHT 20
+#define MEASURE_STEPS 600
+
+static void run(const char* name, physics_solver_type_t solver, unsigned int iterations) {
+    physics_world_config_t config = {0};
+    config.solver = solver;
+
+    physics_world_t world = physics_world_create_ex(&config);
+
+    physics_solver_params_t params = physics_get_solver_params(&world);
+    params.iterations = iterations;
+    physics_set_solver_params(&world, &params);
+
+    unsigned int count = TOWER_COUNT * TOWER_HEIGHT;
+    bench_boxes_t boxes = bench_boxes_alloc(count, "towers");
+    btRigidBody** bodies = malloc(sizeof(btRigidBody*) * count);
+
+    if (!bodies) {
+        fprintf(stderr, "Failed to allocate towers\n");
+        exit(1);
+    }
+
+    // Boxes rest exactly on each other, any drift comes from the solver
+    for (unsigned int i = 0; i < count; i++) {
+        boxes.positions[i][0] = ((float)(i / TOWER_HEIGHT) - TOWER_COUNT / 2) * 4.0f;
+        boxes.positions[i][1] = 0.5f + (float)(i % TOWER_HEIGHT);
+        boxes.positions[i][2] = 0.0f;
+    }
+
+    physics_add_box(&world, (vec3){0.0f, -0.5f, 0.0f}, (vec3){400.0f, 1.0f, 50.0f}, 0.0f);
+    physics_add_boxes(&world, count, boxes.positions, boxes.sizes, boxes.masses, NULL, bodies);
+
+    double start = bench_now_ms();
+
+    for (unsigned int step = 0; step < MEASURE_STEPS; step++) {
+        physics_step_fixed(&world, 1);
+    }
+
+    double step_ms = (bench_now_ms() - start) / MEASURE_STEPS;
+
+    float max_drift = 0.0f;
+    unsigned int fallen = 0;
+
+    for (unsigned int tower = 0; tower < TOWER_COUNT; tower++) {
+        unsigned int top = tower * TOWER_HEIGHT + TOWER_HEIGHT - 1;
+        vec3 pos;
+        mat4 rotation;
+
+        physics_get_transform(bodies[top], pos, rotation);
+
+        float dx = pos[0] - boxes.positions[top][0];
+        float dz = pos[2] - boxes.positions[top][2];
+        float drift = sqrtf(dx * dx + dz * dz);
+
+        if (drift > max_drift) {
+            max_drift = drift;
+        }
+
+        if (pos[1] < boxes.positions[top][1] - 0.5f) {
+            fallen++;
+        }
+    }
+
+    fprintf(stderr, "  %-20s %3u iterations | step %7.3f ms | top drift %6.3f m | %2u/%u towers fallen\n",
+            name, iterations, step_ms, max_drift, fallen, TOWER_COUNT);
+
+    bench_boxes_free(&boxes);
+    free(bodies);
+    physics_world_destroy(&world);
+}
+
+int main(void) {
+    static const struct {
+        const char* name;
+        physics_solver_type_t type;
+    } solvers[] = {
+        {"sequential impulse", PHYSICS_SOLVER_SI},
+        {"NNCG", PHYSICS_SOLVER_NNCG},
+        {"MLCP Dantzig", PHYSICS_SOLVER_MLCP_DANTZIG},
+        {"MLCP PGS", PHYSICS_SOLVER_MLCP_PGS},
+        {"MLCP Lemke", PHYSICS_SOLVER_MLCP_LEMKE},
+    };
+    static const unsigned int iterations[] = {4, 10, 30};
+
+    fprintf(stderr, "Constraint solver benchmark: %u towers of %u boxes, %u steps\n", TOWER_COUNT, TOWER_HEIGHT, MEASURE_STEPS);
+
+    for (unsigned int i = 0; i < sizeof(solvers) / sizeof(solvers[0]); i++) {
+        for (unsigned int j = 0; j < sizeof(iterations) / sizeof(iterations[0]); j++) {
+            run(solvers[i].name, solvers[i].type, iterations[j]);
+        }
+    }
+
+    return 0;
+}
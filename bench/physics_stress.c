@@ -0,0 +1,251 @@
+#include "bench_common.h"
+#include <string.h>
+#include <sys/resource.h>
+
+#include "physics/physics.h"
+
+// Headless physics stress test: canned scenarios stepped at a fixed 60 Hz,
+// no window or GL context involved
+// Usage: physics_stress [scenario] [output.json]
+// Scenarios: pyramids, rain, sleeping_piles, mixed, all (default)
+// The JSON report goes to stderr unless a path is given, run with >/dev/null
+// to hide world logging
+
+#define TICK_RATE 60.0f
+
+typedef struct {
+    const char* name;
+    unsigned int steps;
+    void (*build)(physics_world_t* world);
+} scenario_t;
+
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+
+    return (x > y) - (x < y);
+}
+
+static void add_ground(physics_world_t* world, float extent) {
+    physics_add_box(world, (vec3){0.0f, -0.5f, 0.0f}, (vec3){extent, 1.0f, extent}, 0.0f);
+}
+
+// Batch of count boxes filled by a callback, all sharing one bulk add
+static void add_batch(physics_world_t* world, unsigned int count, void (*fill)(unsigned int i, vec3 pos, vec3 size, float* mass)) {
+    bench_boxes_t boxes = bench_boxes_alloc(count, "scenario data");
+
+    for (unsigned int i = 0; i < count; i++) {
+        fill(i, boxes.positions[i], boxes.sizes[i], &boxes.masses[i]);
+    }
+
+    physics_add_boxes(world, count, boxes.positions, boxes.sizes, boxes.masses, NULL, NULL);
+
+    bench_boxes_free(&boxes);
+}
+
+// 8 flat pyramids with a 30 box base, stress the solver on tall stacks
+#define PYRAMID_COUNT 8
+#define PYRAMID_BASE 30
+#define PYRAMID_BOXES (PYRAMID_BASE * (PYRAMID_BASE + 1) / 2)
+
+static void fill_pyramid(unsigned int i, vec3 pos, vec3 size, float* mass) {
+    unsigned int pyramid = i / PYRAMID_BOXES;
+    unsigned int index = i % PYRAMID_BOXES;
+    unsigned int row = 0;
+
+    while (index >= PYRAMID_BASE - row) {
+        index -= PYRAMID_BASE - row;
+        row++;
+    }
+
+    pos[0] = ((float)index - (float)(PYRAMID_BASE - row) * 0.5f) * 1.02f;
+    pos[1] = 0.5f + (float)row;
+    pos[2] = ((float)pyramid - PYRAMID_COUNT * 0.5f) * 4.0f;
+    glm_vec3_one(size);
+    *mass = 1.0f;
+}
+
+static void build_pyramids(physics_world_t* world) {
+    add_ground(world, 200.0f);
+    add_batch(world, PYRAMID_COUNT * PYRAMID_BOXES, fill_pyramid);
+}
+
+// 50k boxes spread over 250 m of height, landing over the first seconds
+#define RAIN_COUNT 50000
+
+static void fill_rain(unsigned int i, vec3 pos, vec3 size, float* mass) {
+    (void)i;
+    pos[0] = (bench_rng_float() * 2.0f - 1.0f) * 100.0f;
+    pos[1] = 5.0f + bench_rng_float() * 250.0f;
+    pos[2] = (bench_rng_float() * 2.0f - 1.0f) * 100.0f;
+    glm_vec3_fill(size, 0.4f + bench_rng_float() * 0.4f);
+    *mass = 1.0f;
+}
+
+static void build_rain(physics_world_t* world) {
+    add_ground(world, 400.0f);
+    add_batch(world, RAIN_COUNT, fill_rain);
+}
+
+// Columns resting on each other, should fall asleep and cost next to nothing
+#define PILE_COUNT 4
+#define PILE_WIDTH 10
+#define PILE_HEIGHT 10
+#define PILE_BOXES (PILE_WIDTH * PILE_WIDTH * PILE_HEIGHT)
+
+static void fill_pile(unsigned int i, vec3 pos, vec3 size, float* mass) {
+    unsigned int pile = i / PILE_BOXES;
+    unsigned int index = i % PILE_BOXES;
+
+    pos[0] = (float)(index % PILE_WIDTH) * 1.01f + (float)pile * 20.0f - 40.0f;
+    pos[1] = 0.5f + (float)(index / (PILE_WIDTH * PILE_WIDTH));
+    pos[2] = (float)((index / PILE_WIDTH) % PILE_WIDTH) * 1.01f;
+    glm_vec3_one(size);
+    *mass = 1.0f;
+}
+
+static void build_sleeping_piles(physics_world_t* world) {
+    add_ground(world, 200.0f);
+    add_batch(world, PILE_COUNT * PILE_BOXES, fill_pile);
+}
+
+// A level of static crates and pillars with dynamic boxes dropped between them
+#define MIXED_STATIC 10000
+#define MIXED_DYNAMIC 5000
+
+static void fill_mixed(unsigned int i, vec3 pos, vec3 size, float* mass) {
+    if (i < MIXED_STATIC) {
+        pos[0] = (float)(i % 100) * 3.0f - 150.0f;
+        pos[2] = (float)(i / 100) * 3.0f - 150.0f;
+        size[0] = 1.0f + bench_rng_float();
+        size[1] = 0.5f + bench_rng_float() * 4.0f;
+        size[2] = 1.0f + bench_rng_float();
+        pos[1] = size[1] * 0.5f;
+        *mass = 0.0f;
+    } else {
+        pos[0] = (bench_rng_float() * 2.0f - 1.0f) * 150.0f;
+        pos[1] = 8.0f + bench_rng_float() * 30.0f;
+        pos[2] = (bench_rng_float() * 2.0f - 1.0f) * 150.0f;
+        glm_vec3_fill(size, 0.5f + bench_rng_float() * 0.5f);
+        *mass = 1.0f;
+    }
+}
+
+static void build_mixed(physics_world_t* world) {
+    add_ground(world, 400.0f);
+    add_batch(world, MIXED_STATIC + MIXED_DYNAMIC, fill_mixed);
+}
+
+static const scenario_t scenarios[] = {
+    {"pyramids", 600, build_pyramids},
+    {"rain", 600, build_rain},
+    {"sleeping_piles", 900, build_sleeping_piles},
+    {"mixed", 600, build_mixed}
+};
+
+#define SCENARIO_COUNT (sizeof(scenarios) / sizeof(scenarios[0]))
+
+static void run(const scenario_t* scenario, FILE* out, int first) {
+    physics_world_t world = physics_world_create();
+    physics_set_fixed_timestep(&world, TICK_RATE, 1);
+
+    bench_rng_seed(12345);
+
+    double build_start = bench_now_ms();
+    scenario->build(&world);
+    double build_ms = bench_now_ms() - build_start;
+
+    unsigned int body_count = physics_get_stats(&world).body_count;
+    double* times = malloc(sizeof(double) * scenario->steps);
+    float* matrices = malloc(sizeof(float) * 16 * body_count);
+
+    if (!times || !matrices) {
+        fprintf(stderr, "Failed to allocate scenario results\n");
+        exit(1);
+    }
+
+    unsigned int peak_pairs = 0;
+    unsigned int active_bodies = 0;
+    double total_ms = 0.0;
+
+    for (unsigned int step = 0; step < scenario->steps; step++) {
+        double start = bench_now_ms();
+        physics_step_fixed(&world, 1);
+        times[step] = bench_now_ms() - start;
+        total_ms += times[step];
+
+        physics_broadphase_stats_t broadphase = physics_get_broadphase_stats(&world);
+
+        if (broadphase.pairs > peak_pairs) {
+            peak_pairs = broadphase.pairs;
+        }
+
+        // Export skips sleeping and static bodies after the first call: what's left is moving
+        active_bodies = physics_export_transforms(&world, matrices, body_count, NULL);
+    }
+
+    qsort(times, scenario->steps, sizeof(double), compare_double);
+
+    physics_alloc_stats_t alloc = physics_get_alloc_stats(&world);
+    physics_broadphase_stats_t broadphase = physics_get_broadphase_stats(&world);
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    unsigned int n = scenario->steps;
+
+    fprintf(out, "%s    {\n", first ? "" : ",\n");
+    fprintf(out, "      \"name\": \"%s\",\n", scenario->name);
+    fprintf(out, "      \"bodies\": %u,\n", body_count);
+    fprintf(out, "      \"steps\": %u,\n", n);
+    fprintf(out, "      \"build_ms\": %.3f,\n", build_ms);
+    fprintf(out, "      \"step_ms\": {\"min\": %.4f, \"mean\": %.4f, \"p50\": %.4f, \"p90\": %.4f, \"p99\": %.4f, \"max\": %.4f},\n",
+            times[0], total_ms / n, times[n / 2], times[n * 90 / 100], times[n * 99 / 100], times[n - 1]);
+    fprintf(out, "      \"pairs\": {\"final\": %u, \"peak\": %u},\n", broadphase.pairs, peak_pairs);
+    fprintf(out, "      \"active_bodies_final\": %u,\n", active_bodies);
+    fprintf(out, "      \"memory\": {\"arena_peak_bytes\": %zu, \"arena_reserved_bytes\": %zu, \"process_peak_rss_kb\": %ld}\n",
+            alloc.peak_bytes, alloc.bytes_reserved, usage.ru_maxrss);
+    fprintf(out, "    }");
+
+    free(times);
+    free(matrices);
+    physics_world_destroy(&world);
+}
+
+int main(int argc, char** argv) {
+    const char* name = argc > 1 ? argv[1] : "all";
+    FILE* out = stderr;
+
+    if (argc > 2) {
+        out = fopen(argv[2], "w");
+
+        if (!out) {
+            fprintf(stderr, "Failed to open %s\n", argv[2]);
+            return 1;
+        }
+    }
+
+    int all = strcmp(name, "all") == 0;
+    int found = 0;
+
+    fprintf(out, "{\n  \"tick_rate\": %.0f,\n  \"scenarios\": [\n", TICK_RATE);
+
+    for (size_t i = 0; i < SCENARIO_COUNT; i++) {
+        if (all || strcmp(name, scenarios[i].name) == 0) {
+            run(&scenarios[i], out, !found);
+            found = 1;
+        }
+    }
+
+    fprintf(out, "\n  ]\n}\n");
+
+    if (out != stderr) {
+        fclose(out);
+    }
+
+    if (!found) {
+        fprintf(stderr, "Unknown scenario %s\n", name);
+        return 1;
+    }
+
+    return 0;
+}
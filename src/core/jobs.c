@@ -0,0 +1,159 @@
+#include "jobs.h"
+#include <stdio.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+
+static pthread_t workers[JOBS_MAX_THREADS];
+static unsigned int worker_count = 0;
+static int running = 0;
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wake_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t done_cond = PTHREAD_COND_INITIALIZER;
+
+// Only one batch runs at a time, everything else executes inline
+static pthread_mutex_t submit_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static unsigned long generation = 0;
+static unsigned int busy_workers = 0;
+
+static job_func_t batch_func = NULL;
+static void* batch_data = NULL;
+static unsigned int batch_count = 0;
+static atomic_uint next_index;
+
+static void run_batch(unsigned int thread_index) {
+    for (;;) {
+        unsigned int index = atomic_fetch_add(&next_index, 1);
+
+        if (index >= batch_count) {
+            break;
+        }
+
+        batch_func(batch_data, index, thread_index);
+    }
+}
+
+static void* worker_main(void* arg) {
+    unsigned int thread_index = (unsigned int)(size_t)arg;
+    unsigned long seen = 0;
+
+    pthread_mutex_lock(&lock);
+
+    for (;;) {
+        while (running && seen == generation) {
+            pthread_cond_wait(&wake_cond, &lock);
+        }
+
+        if (!running) {
+            break;
+        }
+
+        seen = generation;
+        pthread_mutex_unlock(&lock);
+
+        run_batch(thread_index);
+
+        pthread_mutex_lock(&lock);
+
+        if (--busy_workers == 0) {
+            pthread_cond_signal(&done_cond);
+        }
+    }
+
+    pthread_mutex_unlock(&lock);
+
+    return NULL;
+}
+
+int jobs_init(unsigned int thread_count) {
+    if (running) {
+        return 0;
+    }
+
+    if (thread_count == 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        thread_count = cores > 0 ? (unsigned int)cores : 1;
+    }
+
+    if (thread_count > JOBS_MAX_THREADS) {
+        thread_count = JOBS_MAX_THREADS;
+    }
+
+    running = 1;
+    worker_count = 0;
+
+    // The caller is thread 0, workers take 1..thread_count-1
+    for (unsigned int i = 1; i < thread_count; i++) {
+        if (pthread_create(&workers[worker_count], NULL, worker_main, (void*)(size_t)i) != 0) {
+            fprintf(stderr, "Failed to create worker thread %u\n", i);
+            jobs_shutdown();
+
+            return -1;
+        }
+
+        worker_count++;
+    }
+
+    printf("Job system started with %u threads\n", worker_count + 1);
+
+    return 0;
+}
+
+unsigned int jobs_thread_count(void) {
+    return worker_count + 1;
+}
+
+void jobs_parallel_for(unsigned int count, job_func_t func, void* user_data) {
+    if (count == 0) {
+        return;
+    }
+
+    if (worker_count == 0 || count == 1 || pthread_mutex_trylock(&submit_lock) != 0) {
+        for (unsigned int i = 0; i < count; i++) {
+            func(user_data, i, 0);
+        }
+
+        return;
+    }
+
+    pthread_mutex_lock(&lock);
+    batch_func = func;
+    batch_data = user_data;
+    batch_count = count;
+    atomic_store(&next_index, 0);
+    busy_workers = worker_count;
+    generation++;
+    pthread_cond_broadcast(&wake_cond);
+    pthread_mutex_unlock(&lock);
+
+    run_batch(0);
+
+    // Wait until every worker left the batch before it can be reused
+    pthread_mutex_lock(&lock);
+
+    while (busy_workers > 0) {
+        pthread_cond_wait(&done_cond, &lock);
+    }
+
+    pthread_mutex_unlock(&lock);
+    pthread_mutex_unlock(&submit_lock);
+}
+
+void jobs_shutdown(void) {
+    if (!running) {
+        return;
+    }
+
+    pthread_mutex_lock(&lock);
+    running = 0;
+    pthread_cond_broadcast(&wake_cond);
+    pthread_mutex_unlock(&lock);
+
+    for (unsigned int i = 0; i < worker_count; i++) {
+        pthread_join(workers[i], NULL);
+    }
+
+    worker_count = 0;
+}
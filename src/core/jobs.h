@@ -0,0 +1,56 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Upper bound for jobs_thread_count(), sizes per-thread scratch arrays
+#define JOBS_MAX_THREADS 64
+
+/**
+   * Job callback, runs once per index of a parallel_for
+   * @param user_data Pointer passed to jobs_parallel_for()
+   * @param index Job index: 0..count-1
+   * @param thread_index Executing thread: 0..jobs_thread_count()-1
+**/
+
+typedef void (*job_func_t)(void* user_data, unsigned int index, unsigned int thread_index);
+
+/**
+   * Start the engine worker threads
+   * @param thread_count Total threads including the caller: 0 picks one per CPU core
+   * @return 0 on success and -1 on failure
+**/
+
+int jobs_init(unsigned int thread_count);
+
+/**
+   * Get the number of threads that can run jobs, caller included
+   * @return Thread count, 1 when the pool is not running
+**/
+
+unsigned int jobs_thread_count(void);
+
+/**
+   * Run func for every index in 0..count-1 across the worker threads
+   * The calling thread helps and the call returns once every job finished
+   * Calls made while another batch is running, e.g. from inside a job, run inline
+   * @param count Number of jobs
+   * @param func Job callback
+   * @param user_data Pointer forwarded to func
+**/
+
+void jobs_parallel_for(unsigned int count, job_func_t func, void* user_data);
+
+/**
+   * Stop and join the worker threads
+**/
+
+void jobs_shutdown(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // JOBS_H
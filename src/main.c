@@ -9,18 +9,27 @@
 
 #include "core/window.h"
 #include "core/input.h"
+#include "core/jobs.h"
 #include "renderer/renderer.h"
 #include "renderer/shader.h"
 #include "renderer/texture.h"
 #include "renderer/camera.h"
 #include "renderer/model.h"
+#include "renderer/soft_occlusion.h"
+#include "renderer/bvh.h"
 #include "physics/physics.h"
+#include "physics/physics_thread.h"
 #include "audio/audio.h"
 
 #define WINDOW_WIDTH 1920
 #define WINDOW_HEIGHT 1080
 #define WINDOW_TITLE "Miracle Engine"
 
+// GPU culled cube field below the ground, B grows it to show the CPU cost stays flat
+#define CUBE_FIELD_WIDTH 512 // 262144 instances at most
+#define CUBE_FIELD_SPACING 2.0f
+#define CUBE_FIELD_START 4096
+
 static double last_frame = 0.0;
 static double delta_time = 0.0;
 
@@ -33,16 +42,32 @@ static model_t girl_model;
 static model_t cube_model;
 static physics_world_t physics_world;
 static int current_model = 0; // 0 = cube, 1 = girl model
-static btRigidBody* physics_cube = NULL;
+static physics_thread_t* physics_thread = NULL;
+static unsigned int physics_cube = PHYSICS_INVALID_HANDLE;
+static occlusion_query_t cube_query;
+static occlusion_query_t girl_query;
+static soft_occlusion_t soft_occluder;
+static bvh_t scene_bvh; // Dynamic objects, refit every frame
+static int cube_item = -1;
+static int girl_item = -1;
+static vec3 ground_pos = {0.0f, -1.0f, 0.0f};
+static vec3 ground_size = {10.0f, 0.1f, 10.0f};
 static unsigned int kaleidoscope = 0;
 static vec3 light_pos = {2.0f, 4.0f, 3.0f};
 static vec3 light_color = {1.0f, 1.0f, 1.0f};
+static gpu_batch_t cube_field;
+static unsigned int cube_field_count = CUBE_FIELD_START;
+static double cube_field_cpu_ms = 0.0; // Submit time summed since the last report
+static unsigned int cube_field_frames = 0;
 
 static int init_engine(void);
 static void update_engine(void);
 static void render_engine(void);
 static void cleanup_engine(void);
 static void process_input(void);
+static void scene_update_item(int item, model_t* model, mat4 transform);
+static void cube_field_create(void);
+static void cube_field_render(void);
 
 int main(void) {
     printf("Starting Miracle Engine...\n");
@@ -57,6 +82,8 @@ int main(void) {
     printf("Controls:\n");
     printf("  M - Toggle between models (Cube/Girl)\n");
     printf("  1 - Play audio track Romchika\n");
+    printf("  SPACE - Push the physics cube\n");
+    printf("  B - Grow the GPU culled cube field (x4, wraps around)\n");
     printf("  F1 - Toggle wireframe\n");
     printf("  ESC - Exit\n");
 
@@ -84,8 +111,17 @@ static int init_engine(void) {
     }
 
     input_init(window);
+
+    if (jobs_init(0) != 0) {
+        printf("Warning: Running without worker threads\n");
+    }
+
     renderer_init();
 
+    cube_query = occlusion_query_create();
+    girl_query = occlusion_query_create();
+    soft_occluder = soft_occlusion_create(320, 180);
+
     if (audio_init() != 0) {
         printf("Warning: Failed to initialize audio system\n");
     } else {
@@ -99,12 +135,30 @@ static int init_engine(void) {
     // Create physics cube
     vec3 cube_pos = {0.0f, 5.0f, 0.0f}; // Start above ground
     vec3 cube_size = {1.0f, 1.0f, 1.0f};
-    physics_cube = physics_add_box(&physics_world, cube_pos, cube_size, 1.0f); // 1kg mass
+    btRigidBody* cube_body = physics_add_box(&physics_world, cube_pos, cube_size, 1.0f); // 1kg mass
 
-    vec3 ground_pos = {0.0f, -1.0f, 0.0f};
-    vec3 ground_size = {10.0f, 0.1f, 10.0f};
     physics_add_box(&physics_world, ground_pos, ground_size, 0.0f); // Static (mass = 0)
 
+    // Bodies far from the camera step less often or freeze
+    physics_lod_config_t lod_config = {0};
+    lod_config.reduced_distance = 40.0f;
+    lod_config.frozen_distance = 80.0f;
+    lod_config.extrapolation_time = 0.5f;
+    physics_lod_enable(&physics_world, &lod_config);
+
+    // Simulation runs on its own thread from here on, the world is only touched through it
+    physics_thread = physics_thread_create(&physics_world, 60.0f, 64, 256);
+
+    if (!physics_thread) {
+        return -1;
+    }
+
+    physics_cube = physics_thread_adopt(physics_thread, cube_body);
+
+    if (physics_thread_start(physics_thread) != 0) {
+        return -1;
+    }
+
     // Create camera (move further back to see the whole cube)
     vec3 camera_pos = {0.0f, 0.0f, 5.0f};
     camera = camera_create(camera_pos);
@@ -134,6 +188,18 @@ static int init_engine(void) {
         current_model = 1; // Start with girl model
     }
 
+    // Scene BVH for frustum culling, user IDs point back at the models
+    scene_bvh = bvh_create();
+    cube_item = bvh_insert(&scene_bvh, cube_model.bounds_min, cube_model.bounds_max, 0);
+
+    if (girl_model.mesh_count > 0) {
+        girl_item = bvh_insert(&scene_bvh, girl_model.bounds_min, girl_model.bounds_max, 1);
+    }
+
+    bvh_build(&scene_bvh);
+
+    cube_field_create();
+
     // Create a simple white texture for models without textures
     printf("Creating default white texture\n");
     unsigned char white_pixel[] = {255, 255, 255, 255};
@@ -150,7 +216,7 @@ static void update_engine(void) {
     input_update(window);
     process_input();
     camera_process_input(&camera, window, (float)delta_time);
-    physics_step_simulation(&physics_world, (float)delta_time);
+    physics_thread_set_lod_focus(physics_thread, camera.pos);
 
     static double last_audio_update = 0.0;
     double current_time = glfwGetTime();
@@ -171,22 +237,62 @@ static void render_engine(void) {
 
     model_t* active_model = (current_model == 1 && girl_model.mesh_count > 0) ? &girl_model : &cube_model;
 
+    // Cube with physics
+    mat4 cube_matrix;
+    const physics_frame_t* physics_frame = physics_thread_acquire(physics_thread);
+    physics_frame_get_matrix(physics_frame, physics_cube, cube_matrix);
+
+    mat4 girl_matrix;
+    glm_mat4_identity(girl_matrix);
+    glm_translate(girl_matrix, (vec3){0.0f, -1.0f, 0.0f}); // Lower to ground
+    glm_scale(girl_matrix, (vec3){1.0f, 1.0f, 1.0f});
+
+    // Simple animated rotation
+    glm_rotate(girl_matrix, (float)glfwGetTime() * glm_rad(30.0f), (vec3){0.0f, 1.0f, 0.0f});
+
     mat4 model_matrix;
-    glm_mat4_identity(model_matrix);
+    glm_mat4_copy(active_model == &girl_model ? girl_matrix : cube_matrix, model_matrix);
+
+    // Move dynamic objects in the scene BVH
+    scene_update_item(cube_item, &cube_model, cube_matrix);
+    scene_update_item(girl_item, &girl_model, girl_matrix);
+    bvh_refit(&scene_bvh);
+
+    // CPU occlusion: the ground box and the physics cube (when not drawn itself) occlude
+    mat4 view;
+    mat4 view_projection;
+    camera_get_view_matrix(&camera, view);
+    glm_mat4_mul(projection, view, view_projection);
+
+    soft_occlusion_begin_frame(&soft_occluder, view_projection);
+
+    mat4 ground_matrix;
+    vec3 ground_half;
+    vec3 ground_neg_half;
+    glm_translate_make(ground_matrix, ground_pos);
+    glm_vec3_scale(ground_size, 0.5f, ground_half);
+    glm_vec3_scale(ground_size, -0.5f, ground_neg_half);
+    soft_occlusion_add_box(&soft_occluder, ground_neg_half, ground_half, ground_matrix);
+
+    if (active_model != &cube_model) {
+        soft_occlusion_add_box(&soft_occluder, cube_model.bounds_min, cube_model.bounds_max, cube_matrix);
+    }
 
-    if (current_model == 1) {
-        glm_translate(model_matrix, (vec3){0.0f, -1.0f, 0.0f}); // Lower to ground
-        glm_scale(model_matrix, (vec3){1.0f, 1.0f, 1.0f});
+    soft_occlusion_rasterize(&soft_occluder);
 
-        // Simple animated rotation
-        glm_rotate(model_matrix, (float)glfwGetTime() * glm_rad(30.0f), (vec3){0.0f, 1.0f, 0.0f});
-    } else {
-        // Cube with physics
-        vec3 physics_pos;
-        mat4 physics_rotation;
-        physics_get_transform(physics_cube, physics_pos, physics_rotation);
-        glm_translate(model_matrix, physics_pos);
-        glm_mat4_mul(model_matrix, physics_rotation, model_matrix);
+    // Frustum culling through the BVH
+    vec4 frustum_planes[6];
+    unsigned int visible_ids[2];
+    glm_frustum_planes(view_projection, frustum_planes);
+    unsigned int visible_count = bvh_query_frustum(&scene_bvh, frustum_planes, visible_ids, 2);
+
+    unsigned int active_id = (active_model == &girl_model) ? 1 : 0;
+    int in_view = 0;
+
+    for (unsigned int i = 0; i < visible_count; i++) {
+        if (visible_ids[i] == active_id) {
+            in_view = 1;
+        }
     }
 
     shader_use(shader_program);
@@ -198,11 +304,19 @@ static void render_engine(void) {
     // Bind fallback texture (for meshes without textures)
     texture_bind(texture_id, 0);
 
-    renderer_submit(*active_model, model_matrix, shader_program);
+    occlusion_query_t* active_query = (active_model == &girl_model) ? &girl_query : &cube_query;
+
+    if (in_view && soft_occlusion_test_aabb(&soft_occluder, active_model->bounds_min, active_model->bounds_max, model_matrix)) {
+        renderer_submit_occluded(*active_model, model_matrix, shader_program, active_query);
+    }
+
+    cube_field_render();
+
     renderer_end_frame();
 }
 
 static void cleanup_engine(void) {
+    gpu_batch_destroy(&cube_field);
     model_free(&cube_model);
     model_free(&girl_model);
 
@@ -214,15 +328,108 @@ static void cleanup_engine(void) {
         texture_delete(texture_id);
     }
 
+    occlusion_query_delete(&cube_query);
+    occlusion_query_delete(&girl_query);
+    renderer_shutdown();
+    soft_occlusion_destroy(&soft_occluder);
+    bvh_destroy(&scene_bvh);
+
+    physics_thread_destroy(physics_thread);
     physics_world_destroy(&physics_world);
     if (kaleidoscope != 0) audio_delete_buffer(kaleidoscope);
     audio_shutdown();
+    jobs_shutdown();
 
     if (window) {
         window_terminate();
     }
 }
 
+static void scene_update_item(int item, model_t* model, mat4 transform) {
+    if (item < 0) {
+        return;
+    }
+
+    vec3 box[2];
+    vec3 world_box[2];
+
+    glm_vec3_copy(model->bounds_min, box[0]);
+    glm_vec3_copy(model->bounds_max, box[1]);
+    glm_aabb_transform(box, transform, world_box);
+
+    bvh_update(&scene_bvh, item, world_box[0], world_box[1]);
+}
+
+static void cube_field_create(void) {
+    unsigned int capacity = CUBE_FIELD_WIDTH * CUBE_FIELD_WIDTH;
+
+    cube_field = gpu_batch_create(cube_model, capacity);
+
+    if (cube_field.instance_capacity == 0) {
+        printf("Warning: Cube field disabled\n");
+        return;
+    }
+
+    capacity = cube_field.instance_capacity;
+    mat4* transforms = malloc(sizeof(mat4) * capacity);
+
+    if (!transforms) {
+        fprintf(stderr, "Failed to allocate cube field transforms\n");
+        gpu_batch_destroy(&cube_field);
+        return;
+    }
+
+    // Flat grid centered under the scene
+    float half = CUBE_FIELD_WIDTH * CUBE_FIELD_SPACING * 0.5f;
+
+    for (unsigned int i = 0; i < capacity; i++) {
+        vec3 pos = {
+            (float)(i % CUBE_FIELD_WIDTH) * CUBE_FIELD_SPACING - half,
+            -3.0f,
+            (float)(i / CUBE_FIELD_WIDTH) * CUBE_FIELD_SPACING - half
+        };
+
+        glm_translate_make(transforms[i], pos);
+    }
+
+    gpu_batch_set_transforms(&cube_field, 0, capacity, (const mat4*)transforms);
+    gpu_batch_set_count(&cube_field, cube_field_count);
+    free(transforms);
+
+    printf("Cube field: %u of %u instances\n", cube_field.instance_count, capacity);
+}
+
+static void cube_field_render(void) {
+    if (cube_field.instance_capacity == 0) {
+        return;
+    }
+
+    // The first row waves, its matrices are streamed every frame
+    mat4 row[CUBE_FIELD_WIDTH];
+    float half = CUBE_FIELD_WIDTH * CUBE_FIELD_SPACING * 0.5f;
+    float time = (float)glfwGetTime();
+
+    for (unsigned int i = 0; i < CUBE_FIELD_WIDTH; i++) {
+        vec3 pos = {(float)i * CUBE_FIELD_SPACING - half, -3.0f + sinf(time * 2.0f + (float)i * 0.1f), -half};
+        glm_translate_make(row[i], pos);
+    }
+
+    gpu_batch_set_transforms(&cube_field, 0, CUBE_FIELD_WIDTH, (const mat4*)row);
+
+    double start = glfwGetTime();
+    renderer_submit_batch(&cube_field, 0);
+    cube_field_cpu_ms += (glfwGetTime() - start) * 1000.0;
+    cube_field_frames++;
+
+    // CPU side of cull and draw, averaged over about a second
+    if (cube_field_frames == 60) {
+        printf("Cube field: %u instances | %.3f ms CPU per frame\n", cube_field.instance_count,
+               cube_field_cpu_ms / cube_field_frames);
+        cube_field_cpu_ms = 0.0;
+        cube_field_frames = 0;
+    }
+}
+
 static void process_input(void) {
     if (input_is_key_pressed(window, GLFW_KEY_ESCAPE)) {
         glfwSetWindowShouldClose(window, 1);
@@ -264,6 +471,32 @@ static void process_input(void) {
         m_pressed = 0;
     }
 
+    // B - Grow the cube field
+    static int b_pressed = 0;
+    if (input_is_key_pressed(window, GLFW_KEY_B)) {
+        if (!b_pressed && cube_field.instance_capacity > 0) {
+            cube_field_count = cube_field_count >= cube_field.instance_capacity ? CUBE_FIELD_START : cube_field_count * 4;
+            gpu_batch_set_count(&cube_field, cube_field_count);
+            cube_field_cpu_ms = 0.0;
+            cube_field_frames = 0;
+            printf("Cube field: %u instances\n", cube_field.instance_count);
+            b_pressed = 1;
+        }
+    } else {
+        b_pressed = 0;
+    }
+
+    // SPACE - Push the physics cube
+    static int space_pressed = 0;
+    if (input_is_key_pressed(window, GLFW_KEY_SPACE)) {
+        if (!space_pressed) {
+            physics_thread_apply_impulse(physics_thread, physics_cube, (vec3){0.0f, 5.0f, -1.0f});
+            space_pressed = 1;
+        }
+    } else {
+        space_pressed = 0;
+    }
+
     // 1 - Play audio track
     static int key1_pressed = 0;
     if (input_is_key_pressed(window, GLFW_KEY_1)) {
@@ -1,6 +1,7 @@
 #ifndef PHYSICS_H
 #define PHYSICS_H
 
+#include <stddef.h>
 #include <cglm/cglm.h>
 
 #ifdef __cplusplus
@@ -14,6 +15,19 @@ typedef struct btCollisionDispatcher btCollisionDispatcher;
 typedef struct btSequentialImpulseConstraintSolver btSequentialImpulseConstrainSolver;
 typedef struct btRigidBody btRigidBody;
 typedef struct btCollisionShape btCollisionShape;
+typedef struct btGhostObject btGhostObject;
+typedef struct physics_world_data_t physics_world_data_t;
+typedef struct physics_world_group_t physics_world_group_t;
+
+// Collision group bits, the first six are Bullet's own
+#define PHYSICS_GROUP_DEFAULT   1
+#define PHYSICS_GROUP_STATIC    2
+#define PHYSICS_GROUP_KINEMATIC 4
+#define PHYSICS_GROUP_DEBRIS    8
+#define PHYSICS_GROUP_TRIGGER   16
+#define PHYSICS_GROUP_CHARACTER 32
+#define PHYSICS_GROUP_USER      64 // First free bit for game defined groups
+#define PHYSICS_GROUP_ALL       (-1)
 
 typedef struct {
     btDiscreteDynamicsWorld* dynamics_world;
@@ -21,8 +35,179 @@ typedef struct {
     btDefaultCollisionConfiguration* collision_config;
     btCollisionDispatcher* dispatcher;
     btSequentialImpulseConstrainSolver* solver;
+    physics_world_data_t* data; // Wrapper owned state: shape cache etc..
 } physics_world_t;
 
+typedef enum {
+    PHYSICS_BROADPHASE_DBVT, // Dynamic AABB trees: unbounded, cheap inserts, the default
+    PHYSICS_BROADPHASE_SAP   // 32-bit sweep and prune: bounded, fast for many slow movers
+} physics_broadphase_type_t;
+
+typedef enum {
+    PHYSICS_SOLVER_SI,           // Sequential impulse, SIMD rows where the CPU has them: the default
+    PHYSICS_SOLVER_NNCG,         // Nonsmooth nonlinear conjugate gradient: converges faster on stacks
+    PHYSICS_SOLVER_MLCP_DANTZIG, // Direct LCP solve per island: stiff and exact, cubic in island size
+    PHYSICS_SOLVER_MLCP_PGS,     // Projected Gauss-Seidel on the assembled LCP
+    PHYSICS_SOLVER_MLCP_LEMKE    // Lemke pivoting on the assembled LCP
+} physics_solver_type_t;
+
+typedef struct {
+    int multithreaded;             // btDiscreteDynamicsWorldMt, needs Bullet built with BT_THREADSAFE
+    unsigned int thread_count;     // Job threads if the job system isn't running yet: 0 = one per core
+    unsigned int solver_pool_size; // Parallel island solvers: 0 = one per thread
+    int heap_allocator;            // Bullet objects on the process heap instead of a world arena
+    physics_broadphase_type_t broadphase;
+    vec3 world_min;                // Sweep and prune bounds: all zero for +-1024 on each axis
+    vec3 world_max;
+    unsigned int max_proxies;      // Sweep and prune preallocated proxies: 0 for 65536
+    float sector_size;             // Streaming sector edge on XZ: 0 for 64
+    physics_solver_type_t solver;  // Also the type of every pooled solver in a multithreaded world
+} physics_world_config_t;
+
+typedef struct {
+    unsigned int iterations;       // Solver passes per tick, Bullet's default is 10
+    int warm_starting;             // Start each tick from the previous tick's impulses
+    float warm_starting_factor;    // Share of the previous impulses reused: 0 to 1
+    int split_impulse;             // Separate penetrating bodies without adding velocity
+    float split_impulse_threshold; // Penetration depth where split impulse takes over, negative
+    float erp;                     // Share of the contact error corrected per tick: 0 to 1
+    int randomize_order;           // Shuffle constraint rows every pass
+} physics_solver_params_t;
+
+typedef struct {
+    unsigned int body_count;
+    unsigned int shape_count;      // Unique shapes alive
+    unsigned int shape_references; // Bodies using cached shapes
+    size_t shape_bytes;            // Memory held by unique shapes
+    size_t shape_bytes_saved;      // Memory one shape per body would have needed on top
+    unsigned int contact_pairs;    // Touching pairs after the last tick, with contact events on
+    unsigned int contact_events_dropped; // Events lost to a full ring since it was enabled
+    unsigned int lod_reduced;      // Bodies stepped at a reduced rate
+    unsigned int lod_frozen;       // Bodies frozen by distance
+} physics_stats_t;
+
+typedef enum {
+    PHYSICS_LOD_FULL,    // Simulated every tick
+    PHYSICS_LOD_REDUCED, // Simulated every reduced_interval ticks with a longer step
+    PHYSICS_LOD_FROZEN   // Not simulated, drifts along its velocity for a while
+} physics_lod_tier_t;
+
+typedef struct {
+    float reduced_distance;        // From the focus, beyond it bodies step at a reduced rate
+    float frozen_distance;         // Beyond it bodies are frozen
+    float hidden_scale;            // Distance multiplier for bodies marked hidden: 0 for 0.5
+    float hysteresis;              // Bodies return to a finer tier this much closer: 0 for 10% of reduced_distance
+    unsigned int reduced_interval; // Ticks per reduced step: 0 for 4
+    float extrapolation_time;      // Seconds frozen bodies keep moving along their velocity
+    unsigned int classify_rate;    // Bodies re-tiered per step: 0 for all of them every 8 steps
+} physics_lod_config_t;
+
+typedef struct {
+    physics_broadphase_type_t type;
+    unsigned int proxies;           // Objects in the broadphase
+    unsigned int pairs;             // Overlapping AABB pairs after the last tick
+    unsigned int aabb_updates;      // Proxies moved in the last tick
+    double update_ms;               // Last tick: AABB updates and pair finding
+    double pairs_ms;                // Last tick: pair finding alone
+    double average_update_ms;       // update_ms averaged over all ticks so far
+    unsigned int manifolds;         // Pairs the narrowphase keeps contact caches for
+    unsigned long long filter_accepted; // Pair filter calls that let the pair through so far
+    unsigned long long filter_rejected; // Pair filter calls rejected by groups, masks and pair rules so far
+    unsigned int parked_bodies;     // Bodies out of the world in unloaded sectors
+    unsigned int unloaded_sectors;
+} physics_broadphase_stats_t;
+
+typedef struct {
+    unsigned int max_vertices; // Per hull after simplification: 0 for 32
+    unsigned int max_pieces;   // Convex pieces of the decomposition, up to 64: 0 or 1 for a single hull
+    float concavity;           // Pieces this close to their hull aren't split further: 0 for 2% of the mesh size
+} physics_hull_params_t;
+
+typedef enum {
+    PHYSICS_PHASE_BROADPHASE,  // AABB updates and pair finding
+    PHYSICS_PHASE_NARROWPHASE, // Contact generation for overlapping pairs
+    PHYSICS_PHASE_ISLANDS,     // Island building and sleep state
+    PHYSICS_PHASE_SOLVER,      // Constraint solving
+    PHYSICS_PHASE_INTEGRATION, // Velocity prediction, integration and motion state sync
+    PHYSICS_PHASE_COUNT
+} physics_phase_t;
+
+typedef struct {
+    unsigned int ticks;                     // Ticks the last step call ran
+    double step_ms;                         // Whole call: phases plus wrapper work (LOD, contact events..)
+    double phase_ms[PHYSICS_PHASE_COUNT];   // Summed over the ticks
+    unsigned int pairs;                     // Overlapping AABB pairs after the last tick
+    unsigned int manifolds;                 // Pairs with a contact cache
+    unsigned int contacts;                  // Contact points over every manifold
+    unsigned int islands;                   // Islands with awake bodies
+    unsigned int active_bodies;             // Awake dynamic bodies
+} physics_profile_t;
+
+typedef struct {
+    unsigned int world_count;
+    unsigned int thread_count;
+    double step_ms;    // Last group step, wall time
+    double busy_ms;    // Last group step, every world's step time summed
+    double longest_ms; // Slowest world of the last step, the floor for step_ms
+} physics_world_group_stats_t;
+
+typedef struct {
+    size_t bytes_in_use;            // Requested bytes of live allocations
+    size_t peak_bytes;
+    size_t bytes_reserved;          // Pool chunks and large blocks taken from the heap
+    size_t free_bytes;              // Pool blocks waiting for reuse
+    unsigned long long allocations;
+    unsigned long long frees;
+    unsigned int live_allocations;
+    float fragmentation;            // Reserved memory not holding live data: 0..1
+} physics_alloc_stats_t;
+
+typedef enum {
+    PHYSICS_QUERY_CLOSEST, // Nearest hit along the ray or sweep
+    PHYSICS_QUERY_ANY      // First hit found, for visibility and occlusion checks
+} physics_query_mode_t;
+
+typedef struct {
+    physics_query_mode_t mode;
+    int filter_group; // Groups the query belongs to: 0 for the default group
+    int filter_mask;  // Groups the query hits: 0 for all but triggers
+} physics_query_params_t;
+
+typedef struct {
+    vec3 from;
+    vec3 to;
+} physics_ray_t;
+
+typedef struct {
+    vec3 from;
+    vec3 to;
+    float radius;
+} physics_sweep_t;
+
+typedef struct {
+    btRigidBody* body; // NULL when the hit object isn't a rigid body
+    vec3 point;
+    vec3 normal;
+    float fraction;    // 0..1 along the query, 1 on a miss
+    int hit;
+} physics_hit_t;
+
+typedef enum {
+    PHYSICS_CONTACT_BEGIN,
+    PHYSICS_CONTACT_PERSIST, // Once per step call while touching, not every tick
+    PHYSICS_CONTACT_END
+} physics_contact_type_t;
+
+typedef struct {
+    physics_contact_type_t type;
+    btRigidBody* body_a;    // Body entering a trigger for trigger events
+    btRigidBody* body_b;    // NULL for trigger events
+    btGhostObject* trigger; // NULL for body contacts
+    vec3 point;             // Deepest contact point in world space, zero for END
+    vec3 normal;            // Contact normal pointing from body_b towards body_a
+    float impulse;          // Summed normal impulse of the pair in the last tick
+} physics_contact_event_t;
+
 /**
     * Create and init a physics world
     * @return initialized physics world
@@ -30,8 +215,18 @@ typedef struct {
 
 physics_world_t physics_world_create(void);
 
+/**
+    * Create a physics world with explicit options
+    * The multithreaded world runs Bullet's task scheduler on the engine job system
+    * @param config World options
+    * @return initialized physics world
+**/
+
+physics_world_t physics_world_create_ex(const physics_world_config_t* config);
+
 /**
     * Add a rigid body box to the physics world
+    * Boxes of the same size share one collision shape
     * @param world Physics world
     * @param pos Initial position
     * @param size Box dimensions
@@ -41,14 +236,353 @@ physics_world_t physics_world_create(void);
 
 btRigidBody* physics_add_box(physics_world_t* world, vec3 pos, vec3 size, float mass);
 
+/**
+    * Add a rigid body box with collision filtering
+    * Two bodies collide when each one's group is in the other's mask
+    * @param world Physics world
+    * @param pos Initial position
+    * @param size Box dimensions
+    * @param mass Mass: 0 for static objects
+    * @param group PHYSICS_GROUP_* bits the body belongs to
+    * @param mask Groups it collides with: group and mask 0 for the defaults
+    * @return Rigid body pointer
+**/
+
+btRigidBody* physics_add_box_filtered(physics_world_t* world, vec3 pos, vec3 size, float mass, int group, int mask);
+
+/**
+    * Add many rigid body boxes at once
+    * Motion states and bodies are allocated in two contiguous blocks and
+    * the broadphase tree is rebuilt once after insertion
+    * @param world Physics world
+    * @param count Number of boxes
+    * @param positions Initial positions: count entries
+    * @param sizes Box dimensions: count entries
+    * @param masses Masses, 0 for static objects: count entries
+    * @param orientations Initial rotations: count entries or NULL for identity
+    * @param out_bodies Output body pointers: count entries or NULL
+    * @return Number of bodies added
+**/
+
+unsigned int physics_add_boxes(physics_world_t* world, unsigned int count, const vec3* positions, const vec3* sizes,
+                               const float* masses, const versor* orientations, btRigidBody** out_bodies);
+
+/**
+    * Add many rigid body boxes sharing one collision filter, e.g. a debris burst
+    * @param world Physics world
+    * @param count Number of boxes
+    * @param positions Initial positions: count entries
+    * @param sizes Box dimensions: count entries
+    * @param masses Masses, 0 for static objects: count entries
+    * @param orientations Initial rotations: count entries or NULL for identity
+    * @param group PHYSICS_GROUP_* bits of every box
+    * @param mask Groups they collide with: group and mask 0 for the defaults
+    * @param out_bodies Output body pointers: count entries or NULL
+    * @return Number of bodies added
+**/
+
+unsigned int physics_add_boxes_filtered(physics_world_t* world, unsigned int count, const vec3* positions, const vec3* sizes,
+                                        const float* masses, const versor* orientations, int group, int mask,
+                                        btRigidBody** out_bodies);
+
+/**
+    * Change a body's collision group and mask, its current pairs are dropped
+    * @param world Physics world
+    * @param body Rigid body in the world
+    * @param group PHYSICS_GROUP_* bits
+    * @param mask Groups it collides with: group and mask 0 for the defaults
+    * @return 0 on success, -1 if the body isn't in the world
+**/
+
+int physics_set_collision_filter(physics_world_t* world, btRigidBody* body, int group, int mask);
+
+/**
+    * Enable or disable collisions between two groups on top of the masks
+    * Covers pair classes like debris vs debris without touching each body.
+    * Disabling also drops pairs already found. Batched queries follow the
+    * rules too, as members of their filter_group
+    * @param world Physics world
+    * @param group_a PHYSICS_GROUP_* bits
+    * @param group_b PHYSICS_GROUP_* bits
+    * @param collide 0 to never let the groups collide
+**/
+
+void physics_set_group_collision(physics_world_t* world, int group_a, int group_b, int collide);
+
+/**
+    * Get the constraint solver settings, to change a few of them and set them back
+    * @param world Physics world
+    * @return Current solver settings
+**/
+
+physics_solver_params_t physics_get_solver_params(const physics_world_t* world);
+
+/**
+    * Set iteration count, warm starting and split impulse for every following tick
+    * @param world Physics world
+    * @param params Solver settings
+    * @return 0 on success, -1 on invalid settings
+**/
+
+int physics_set_solver_params(physics_world_t* world, const physics_solver_params_t* params);
+
+/**
+    * Add static triangle mesh collision, e.g. level geometry
+    * The mesh is copied. With a cache path the quantized BVH is built once,
+    * written to disk and memory mapped on later loads of the same mesh
+    * Feed it from model_read_geometry() to collide with a loaded model
+    * @param world Physics world
+    * @param pos Mesh origin in world space
+    * @param positions xyz per vertex: vertex_count * 3 floats
+    * @param vertex_count Vertex count
+    * @param indices Triangle indices: index_count entries
+    * @param index_count Index count: multiple of 3
+    * @param cache_path BVH cache file or NULL to build every time
+    * @return Static rigid body or NULL on failure
+**/
+
+btRigidBody* physics_add_static_mesh(physics_world_t* world, vec3 pos, const float* positions, unsigned int vertex_count,
+                                     const unsigned int* indices, unsigned int index_count, const char* cache_path);
+
+/**
+    * Add a rigid body with convex hull collision generated from a mesh
+    * Feed it from model_read_geometry() to give a loaded model a tight collider.
+    * The hull is built by Bullet's hull library and capped to params->max_vertices,
+    * with params->max_pieces above 1 the mesh is split into a compound of hulls.
+    * With a cache directory the result is stored under the mesh content hash
+    * and loaded from there next time
+    * @param world Physics world
+    * @param pos Mesh origin in world space
+    * @param mass Mass: 0 for static objects
+    * @param positions xyz per vertex: vertex_count * 3 floats
+    * @param vertex_count Vertex count
+    * @param indices Triangle indices, needed to decompose: NULL for a single hull from the points
+    * @param index_count Index count: multiple of 3
+    * @param params Hull settings, NULL for a single 32 vertex hull
+    * @param cache_dir Existing directory for hull caches or NULL to generate every time
+    * @param mesh_transform Output or NULL: the body sits at the hull's center of mass, not at pos,
+    * multiply its model matrix by this to draw the mesh
+    * @return Rigid body or NULL on failure
+**/
+
+btRigidBody* physics_add_convex_hull(physics_world_t* world, vec3 pos, float mass, const float* positions, unsigned int vertex_count,
+                                     const unsigned int* indices, unsigned int index_count, const physics_hull_params_t* params,
+                                     const char* cache_dir, mat4 mesh_transform);
+
+/**
+    * Merge static boxes into one compound body per grid cell, e.g. after loading a level
+    * Cuts broadphase proxies and per-body memory, the compound's AABB tree culls
+    * its children. Only static boxes with the same collision filter are merged.
+    * Merged bodies are freed: drop any pointer to them, hits and contacts
+    * report the compound body from here on
+    * @param world Physics world
+    * @param region_min Lower corner of the region, boxes are picked by their origin
+    * @param region_max Upper corner
+    * @param cell_size XZ edge of the cell each compound covers: 0 for the streaming sector size
+    * @return Number of boxes merged
+**/
+
+unsigned int physics_bake_static(physics_world_t* world, vec3 region_min, vec3 region_max, float cell_size);
+
+/**
+    * Add a box shaped trigger volume
+    * Triggers report overlapping bodies through contact events and
+    * push nothing, queries skip them unless their mask asks for triggers
+    * @param world Physics world
+    * @param pos Center position
+    * @param size Box dimensions
+    * @return Ghost object or NULL on failure
+**/
+
+btGhostObject* physics_add_trigger_box(physics_world_t* world, vec3 pos, vec3 size);
+
+/**
+    * Remove a trigger and free it, pending overlaps end immediately
+    * @param world Physics world
+    * @param trigger Ghost object from physics_add_trigger_box()
+**/
+
+void physics_remove_trigger(physics_world_t* world, btGhostObject* trigger);
+
+/**
+    * Turn contact events on with a preallocated ring, or off
+    * Manifolds are walked after every tick once enabled
+    * @param world Physics world
+    * @param capacity Max undrained events: 0 disables events
+    * @return 0 on success, -1 on failure
+**/
+
+int physics_enable_contact_events(physics_world_t* world, unsigned int capacity);
+
+/**
+    * Copy pending contact events out of the ring, oldest first
+    * Meant to be called once per frame, events beyond the ring capacity are dropped
+    * @param world Physics world
+    * @param events Output events: max_events entries
+    * @param max_events Output capacity
+    * @return Number of events written
+**/
+
+unsigned int physics_drain_contact_events(physics_world_t* world, physics_contact_event_t* events, unsigned int max_events);
+
+/**
+    * Remove a rigid body from the world and free it
+    * Its collision shape is released once no other body uses it
+    * Its touching pairs end right away, the END events carry the freed pointer
+    * @param world Physics world
+    * @param body Rigid body from physics_add_box() or physics_add_boxes()
+**/
+
+void physics_remove_body(physics_world_t* world, btRigidBody* body);
+
+/**
+    * Apply a force through the center of mass for the next tick
+    * @param body Rigid body
+    * @param force Force in newtons
+**/
+
+void physics_apply_central_force(btRigidBody* body, vec3 force);
+
+/**
+    * Apply an impulse through the center of mass, wakes the body up
+    * @param body Rigid body
+    * @param impulse Impulse in newton seconds
+**/
+
+void physics_apply_central_impulse(btRigidBody* body, vec3 impulse);
+
 /**
     * Step the physics simulation
+    * Runs whole fixed ticks: 60 Hz and max 5 per frame by default
     * @param world Physics world
-    * @param delta_time Time step in sec
+    * @param delta_time Frame time in sec
 **/
 
 void physics_step_simulation(physics_world_t* world, float delta_time);
 
+/**
+    * Run exactly the given number of fixed ticks, independent of frame time
+    * Meant for benchmarks and deterministic replays
+    * @param world Physics world
+    * @param steps Number of ticks
+**/
+
+void physics_step_fixed(physics_world_t* world, unsigned int steps);
+
+/**
+    * Configure the fixed timestep used by physics_step_simulation()
+    * Frame time is accumulated and consumed in whole ticks, time beyond
+    * max_steps ticks per frame is dropped
+    * @param world Physics world
+    * @param tick_rate Ticks per second: 0 for Bullet's internal substepping
+    * @param max_steps Max ticks per frame
+**/
+
+void physics_set_fixed_timestep(physics_world_t* world, float tick_rate, unsigned int max_steps);
+
+/**
+    * Get how far the accumulator is into the next tick
+    * @param world Physics world
+    * @return Blend factor 0..1 between the previous and current tick
+**/
+
+float physics_get_interpolation_alpha(const physics_world_t* world);
+
+/**
+    * Create a group of independent worlds stepped concurrently, e.g. server rooms
+    * Runs on the engine job system, started here if it isn't running yet
+    * @param thread_count Job threads if the job system isn't running yet: 0 = one per core
+    * @return World group or NULL on failure
+**/
+
+physics_world_group_t* physics_world_group_create(unsigned int thread_count);
+
+/**
+    * Free a world group, its worlds are left alive
+    * @param group World group
+**/
+
+void physics_world_group_destroy(physics_world_group_t* group);
+
+/**
+    * Add a world to a group, it must outlive its membership
+    * @param group World group
+    * @param world Physics world, not stepped by anything else during group steps
+    * @return 0 on success, -1 if invalid or already in the group
+**/
+
+int physics_world_group_add(physics_world_group_t* group, physics_world_t* world);
+
+/**
+    * Remove a world from a group, later worlds move down one index
+    * @param group World group
+    * @param world Physics world
+**/
+
+void physics_world_group_remove(physics_world_group_t* group, physics_world_t* world);
+
+/**
+    * Run physics_step_simulation() on every world of the group in parallel
+    * Worlds with the longest last step start first
+    * @param group World group
+    * @param delta_time Frame time in sec
+**/
+
+void physics_world_group_step(physics_world_group_t* group, float delta_time);
+
+/**
+    * Run physics_step_fixed() on every world of the group in parallel
+    * @param group World group
+    * @param steps Number of ticks per world
+**/
+
+void physics_world_group_step_fixed(physics_world_group_t* group, unsigned int steps);
+
+/**
+    * Get wall, summed and slowest world time of the last group step
+    * @param group World group
+    * @return Group stats
+**/
+
+physics_world_group_stats_t physics_world_group_get_stats(const physics_world_group_t* group);
+
+/**
+    * Get each world's step time from the last group step
+    * @param group World group
+    * @param world_ms Output times in the order worlds were added
+    * @param capacity Entries world_ms can hold
+    * @return Number of times written
+**/
+
+unsigned int physics_world_group_get_times(const physics_world_group_t* group, double* world_ms, unsigned int capacity);
+
+/**
+    * Cast many rays, in parallel on the job system when Bullet is thread safe
+    * Call between steps: the world must not change while the batch runs
+    * @param world Physics world
+    * @param rays Rays in world space: count entries
+    * @param count Number of rays
+    * @param params Mode and collision filter or NULL for closest hit against everything
+    * @param hits Output hit per ray: count entries
+    * @return Number of rays that hit
+**/
+
+unsigned int physics_raycast_batch(physics_world_t* world, const physics_ray_t* rays, unsigned int count,
+                                   const physics_query_params_t* params, physics_hit_t* hits);
+
+/**
+    * Sweep many spheres, in parallel on the job system when Bullet is thread safe
+    * @param world Physics world
+    * @param sweeps Sphere sweeps in world space: count entries
+    * @param count Number of sweeps
+    * @param params Mode and collision filter or NULL for closest hit against everything
+    * @param hits Output hit per sweep, point is the contact on the hit object: count entries
+    * @return Number of sweeps that hit
+**/
+
+unsigned int physics_sweep_sphere_batch(physics_world_t* world, const physics_sweep_t* sweeps, unsigned int count,
+                                        const physics_query_params_t* params, physics_hit_t* hits);
+
 /**
     * Get rigid body transform
     * @param body Rigid body
@@ -58,6 +592,205 @@ void physics_step_simulation(physics_world_t* world, float delta_time);
 
 void physics_get_transform(btRigidBody* body, vec3 pos, mat4 rotation);
 
+/**
+    * Get body and collision shape memory stats
+    * @param world Physics world
+    * @return Stats, zeroed for an invalid world
+**/
+
+physics_stats_t physics_get_stats(const physics_world_t* world);
+
+/**
+    * Get Bullet allocation stats of a world's arena
+    * Worlds using the heap allocator report process wide heap allocations
+    * @param world Physics world
+    * @return Stats, zeroed for an invalid world
+**/
+
+physics_alloc_stats_t physics_get_alloc_stats(const physics_world_t* world);
+
+/**
+    * Get a body's model matrix, ready for rendering
+    * @param body Rigid body
+    * @param model Output model matrix: translation * rotation
+**/
+
+void physics_get_model_matrix(btRigidBody* body, mat4 model);
+
+/**
+    * Get a body's model matrix blended between the last two ticks
+    * @param world Physics world
+    * @param body Rigid body
+    * @param model Output model matrix
+**/
+
+void physics_get_interpolated_matrix(physics_world_t* world, btRigidBody* body, mat4 model);
+
+/**
+    * Get a body's slot in the transform export array
+    * Slots are dense: removing a body moves the last body into its slot
+    * @param body Rigid body
+    * @return Slot or -1 if the body isn't in a world
+**/
+
+int physics_body_index(btRigidBody* body);
+
+/**
+    * Write model matrices of active bodies into a contiguous array
+    * Matrices are interpolated by physics_get_interpolation_alpha()
+    * Sleeping and static bodies are written once and skipped afterwards,
+    * so the caller must keep the array between calls
+    * @param world Physics world
+    * @param matrices Output: 16 floats per body slot, column-major
+    * @param capacity Number of matrices the array holds
+    * @param changed_indices Output slots written by this call or NULL: capacity entries
+    * @return Number of matrices written
+**/
+
+unsigned int physics_export_transforms(physics_world_t* world, float* matrices, unsigned int capacity, unsigned int* changed_indices);
+
+/**
+    * Turn on distance based physics LOD
+    * Far bodies take coarser steps, farther ones are frozen, so the step cost
+    * follows the region around the focus instead of the body count.
+    * Tiers change gradually: a few bodies per step, with hysteresis
+    * @param world Physics world
+    * @param config LOD distances or NULL to turn LOD off and wake every frozen body
+    * @return 0 on success, -1 on invalid distances
+**/
+
+int physics_lod_enable(physics_world_t* world, const physics_lod_config_t* config);
+
+/**
+    * Move the point LOD distances are measured from, usually the camera
+    * @param world Physics world
+    * @param focus World position
+**/
+
+void physics_lod_set_focus(physics_world_t* world, vec3 focus);
+
+/**
+    * Mark a body as hidden, its LOD distances shrink by hidden_scale
+    * @param world Physics world
+    * @param body Rigid body in the world
+    * @param visible 0 if the body is outside the view or occluded
+**/
+
+void physics_lod_set_visible(physics_world_t* world, btRigidBody* body, int visible);
+
+/**
+    * Get a body's current LOD tier
+    * @param world Physics world
+    * @param body Rigid body
+    * @return Tier, PHYSICS_LOD_FULL with LOD off
+**/
+
+physics_lod_tier_t physics_lod_get_tier(const physics_world_t* world, btRigidBody* body);
+
+/**
+    * Get broadphase pair counts and timings, to pick a broadphase per level
+    * @param world Physics world
+    * @return Broadphase stats
+**/
+
+physics_broadphase_stats_t physics_get_broadphase_stats(const physics_world_t* world);
+
+/**
+    * Turn per-phase step timing on or off, call between steps
+    * Uses Bullet's profile zone hooks while any world has it on, off costs nothing
+    * @param world Physics world
+    * @param enabled 0 to turn it off
+    * @return 0 on success, -1 on an invalid world
+**/
+
+int physics_profile_enable(physics_world_t* world, int enabled);
+
+/**
+    * Get phase timings and counters of the last step call
+    * @param world Physics world
+    * @return Profile, all zero with profiling off
+**/
+
+physics_profile_t physics_get_profile(const physics_world_t* world);
+
+/**
+    * Get the streaming sector containing a position
+    * @param world Physics world
+    * @param pos World position, only x and z are used
+    * @param sector_x Output sector column
+    * @param sector_z Output sector row
+**/
+
+void physics_sector_of(const physics_world_t* world, vec3 pos, int* sector_x, int* sector_z);
+
+/**
+    * Take every body whose origin lies in a sector out of the simulation and broadphase
+    * Body pointers stay valid but lose their export slot while parked.
+    * Active bodies moving into an unloaded sector are parked after each step
+    * @param world Physics world
+    * @param sector_x Sector column
+    * @param sector_z Sector row
+    * @return Number of bodies parked, 0 if the sector was already unloaded
+**/
+
+unsigned int physics_sector_unload(physics_world_t* world, int sector_x, int sector_z);
+
+/**
+    * Put a sector's parked bodies back into the world as they were
+    * @param world Physics world
+    * @param sector_x Sector column
+    * @param sector_z Sector row
+    * @return Number of bodies restored
+**/
+
+unsigned int physics_sector_load(physics_world_t* world, int sector_x, int sector_z);
+
+/**
+    * Check whether a sector is simulated
+    * @param world Physics world
+    * @param sector_x Sector column
+    * @param sector_z Sector row
+    * @return 1 if loaded, 0 if unloaded
+**/
+
+int physics_sector_is_loaded(const physics_world_t* world, int sector_x, int sector_z);
+
+/**
+    * Get a buffer size that fits a full or delta snapshot of the world now
+    * The bound grows with the body and contact manifold count
+    * @param world Physics world
+    * @return Bytes
+**/
+
+size_t physics_snapshot_size(const physics_world_t* world);
+
+/**
+    * Save bodies' transforms, velocities, activation and the contact
+    * warm starting data into a caller owned buffer, without allocating
+    * A delta snapshot only stores bodies that differ from its base
+    * Snapshots are tied to the set of bodies: adding or removing any invalidates them
+    * @param world Physics world
+    * @param buffer Output buffer, 16-byte aligned
+    * @param capacity Buffer size from physics_snapshot_size()
+    * @param base Full snapshot to diff against or NULL for a full snapshot
+    * @return Bytes written, 0 if the buffer is too small or the base doesn't match
+**/
+
+size_t physics_snapshot_save(physics_world_t* world, void* buffer, size_t capacity, const void* base);
+
+/**
+    * Put the world back into a saved state
+    * Contact warm starting is restored for pairs the broadphase still tracks,
+    * contact events then continue from the restored contacts
+    * @param world Physics world
+    * @param buffer Snapshot from physics_snapshot_save()
+    * @param size Snapshot size in bytes
+    * @param base The delta's base snapshot, NULL for full snapshots
+    * @return 0 on success, -1 if the snapshot doesn't fit the world
+**/
+
+int physics_snapshot_restore(physics_world_t* world, const void* buffer, size_t size, const void* base);
+
 /**
     * Destroy physics world and cleanup resources
     * @param world Physics world to destroy
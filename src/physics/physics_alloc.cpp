@@ -0,0 +1,360 @@
+#include "physics_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <mutex>
+
+// Bullet allocation hooks: size-class pools carved from per-world arenas
+// Every block starts with a header naming its arena and class, so a free
+// never needs to know which world is current
+
+#define ALLOC_CLASS_COUNT 14
+#define ALLOC_LARGE 0xFFFFFFFFu
+#define ALLOC_CHUNK_SIZE (64 * 1024)
+#define ALLOC_ALIGNMENT 16
+
+static const unsigned int class_sizes[ALLOC_CLASS_COUNT] = {
+    16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048
+};
+
+struct alignas(ALLOC_ALIGNMENT) alloc_header_t {
+    physics_arena_t* arena; // NULL: process heap
+    unsigned int size_class;
+    unsigned int size;
+};
+
+// Blocks above the largest class or with a stricter alignment
+struct large_block_t {
+    large_block_t* prev;
+    large_block_t* next;
+    void* base;
+    size_t bytes;
+};
+
+struct free_block_t {
+    free_block_t* next;
+};
+
+struct alloc_chunk_t {
+    alloc_chunk_t* next;
+};
+
+struct physics_arena_t {
+    std::mutex mutex;
+    bool thread_safe;
+
+    free_block_t* free_lists[ALLOC_CLASS_COUNT];
+    alloc_chunk_t* chunks;
+    unsigned char* bump;
+    unsigned char* bump_end;
+    large_block_t* large;
+
+    size_t bytes_in_use;
+    size_t peak_bytes;
+    size_t bytes_reserved;
+    size_t free_bytes;
+    unsigned long long allocations;
+    unsigned long long frees;
+    unsigned int live;
+};
+
+thread_local physics_arena_t* physics_current_arena = nullptr;
+
+// Allocations outside any world, e.g. the shared task scheduler
+static std::atomic<size_t> heap_bytes_in_use(0);
+static std::atomic<size_t> heap_peak_bytes(0);
+static std::atomic<unsigned long long> heap_allocations(0);
+static std::atomic<unsigned long long> heap_frees(0);
+
+static inline unsigned int size_class_of(size_t size) {
+    for (unsigned int i = 0; i < ALLOC_CLASS_COUNT; i++) {
+        if (size <= class_sizes[i]) {
+            return i;
+        }
+    }
+
+    return ALLOC_LARGE;
+}
+
+static inline uintptr_t align_up(uintptr_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(uintptr_t)(alignment - 1);
+}
+
+static void* large_alloc(physics_arena_t* arena, size_t size, size_t alignment) {
+    size_t bytes = sizeof(large_block_t) + sizeof(alloc_header_t) + size + alignment;
+    unsigned char* base = static_cast<unsigned char*>(malloc(bytes));
+
+    if (!base) {
+        return nullptr;
+    }
+
+    unsigned char* data = reinterpret_cast<unsigned char*>(
+        align_up(reinterpret_cast<uintptr_t>(base) + sizeof(large_block_t) + sizeof(alloc_header_t), alignment)
+    );
+    alloc_header_t* header = reinterpret_cast<alloc_header_t*>(data) - 1;
+    large_block_t* block = reinterpret_cast<large_block_t*>(header) - 1;
+
+    header->arena = arena;
+    header->size_class = ALLOC_LARGE;
+    header->size = (unsigned int)size;
+    block->base = base;
+    block->bytes = bytes;
+    block->prev = nullptr;
+    block->next = nullptr;
+
+    if (arena) {
+        block->next = arena->large;
+
+        if (arena->large) {
+            arena->large->prev = block;
+        }
+
+        arena->large = block;
+        arena->bytes_reserved += bytes;
+    }
+
+    return data;
+}
+
+static void large_free(physics_arena_t* arena, alloc_header_t* header) {
+    large_block_t* block = reinterpret_cast<large_block_t*>(header) - 1;
+
+    if (arena) {
+        if (block->prev) {
+            block->prev->next = block->next;
+        } else {
+            arena->large = block->next;
+        }
+
+        if (block->next) {
+            block->next->prev = block->prev;
+        }
+
+        arena->bytes_reserved -= block->bytes;
+    }
+
+    free(block->base);
+}
+
+static void* pool_alloc(physics_arena_t* arena, unsigned int size_class) {
+    free_block_t* block = arena->free_lists[size_class];
+    size_t block_size = sizeof(alloc_header_t) + class_sizes[size_class];
+
+    if (block) {
+        arena->free_lists[size_class] = block->next;
+        arena->free_bytes -= block_size;
+
+        return block;
+    }
+
+    if ((size_t)(arena->bump_end - arena->bump) < block_size) {
+        alloc_chunk_t* chunk = static_cast<alloc_chunk_t*>(malloc(ALLOC_CHUNK_SIZE));
+
+        if (!chunk) {
+            return nullptr;
+        }
+
+        // The unused tail of the old chunk is lost until the arena is released
+        chunk->next = arena->chunks;
+        arena->chunks = chunk;
+        arena->bump = reinterpret_cast<unsigned char*>(align_up(reinterpret_cast<uintptr_t>(chunk + 1), ALLOC_ALIGNMENT));
+        arena->bump_end = reinterpret_cast<unsigned char*>(chunk) + ALLOC_CHUNK_SIZE;
+        arena->bytes_reserved += ALLOC_CHUNK_SIZE;
+    }
+
+    void* memory = arena->bump;
+    arena->bump += block_size;
+
+    return memory;
+}
+
+static void* arena_alloc(physics_arena_t* arena, size_t size, size_t alignment) {
+    unsigned int size_class = alignment <= ALLOC_ALIGNMENT ? size_class_of(size) : ALLOC_LARGE;
+    void* data;
+
+    if (size_class == ALLOC_LARGE) {
+        data = large_alloc(arena, size, alignment < ALLOC_ALIGNMENT ? ALLOC_ALIGNMENT : alignment);
+    } else {
+        alloc_header_t* header = static_cast<alloc_header_t*>(pool_alloc(arena, size_class));
+
+        if (!header) {
+            return nullptr;
+        }
+
+        header->arena = arena;
+        header->size_class = size_class;
+        header->size = (unsigned int)size;
+        data = header + 1;
+    }
+
+    if (data) {
+        arena->bytes_in_use += size;
+        arena->allocations++;
+        arena->live++;
+
+        if (arena->bytes_in_use > arena->peak_bytes) {
+            arena->peak_bytes = arena->bytes_in_use;
+        }
+    }
+
+    return data;
+}
+
+static void arena_free(physics_arena_t* arena, alloc_header_t* header) {
+    arena->bytes_in_use -= header->size;
+    arena->frees++;
+    arena->live--;
+
+    if (header->size_class == ALLOC_LARGE) {
+        large_free(arena, header);
+        return;
+    }
+
+    unsigned int size_class = header->size_class;
+    free_block_t* block = reinterpret_cast<free_block_t*>(header);
+
+    block->next = arena->free_lists[size_class];
+    arena->free_lists[size_class] = block;
+    arena->free_bytes += sizeof(alloc_header_t) + class_sizes[size_class];
+}
+
+static void* physics_aligned_alloc(size_t size, int alignment) {
+    physics_arena_t* arena = physics_current_arena;
+    size_t align = alignment > 0 ? (size_t)alignment : ALLOC_ALIGNMENT;
+
+    if (!arena) {
+        void* data = large_alloc(nullptr, size, align < ALLOC_ALIGNMENT ? ALLOC_ALIGNMENT : align);
+
+        if (data) {
+            size_t in_use = heap_bytes_in_use.fetch_add(size, std::memory_order_relaxed) + size;
+            size_t peak = heap_peak_bytes.load(std::memory_order_relaxed);
+
+            while (in_use > peak && !heap_peak_bytes.compare_exchange_weak(peak, in_use, std::memory_order_relaxed)) {
+            }
+
+            heap_allocations.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        return data;
+    }
+
+    if (arena->thread_safe) {
+        std::lock_guard<std::mutex> lock(arena->mutex);
+
+        return arena_alloc(arena, size, align);
+    }
+
+    return arena_alloc(arena, size, align);
+}
+
+static void physics_aligned_free(void* memory) {
+    if (!memory) {
+        return;
+    }
+
+    alloc_header_t* header = static_cast<alloc_header_t*>(memory) - 1;
+    physics_arena_t* arena = header->arena;
+
+    if (!arena) {
+        heap_bytes_in_use.fetch_sub(header->size, std::memory_order_relaxed);
+        heap_frees.fetch_add(1, std::memory_order_relaxed);
+        large_free(nullptr, header);
+        return;
+    }
+
+    if (arena->thread_safe) {
+        std::lock_guard<std::mutex> lock(arena->mutex);
+        arena_free(arena, header);
+        return;
+    }
+
+    arena_free(arena, header);
+}
+
+static void* physics_alloc(size_t size) {
+    return physics_aligned_alloc(size, ALLOC_ALIGNMENT);
+}
+
+void physics_alloc_install(void) {
+    static bool installed = false;
+
+    if (installed) {
+        return;
+    }
+
+    // Must run before Bullet allocates anything, blocks from another allocator can't be freed here
+    btAlignedAllocSetCustom(physics_alloc, physics_aligned_free);
+    btAlignedAllocSetCustomAligned(physics_aligned_alloc, physics_aligned_free);
+    installed = true;
+}
+
+physics_arena_t* physics_arena_create(int thread_safe) {
+    physics_arena_t* arena = new (std::nothrow) physics_arena_t();
+
+    if (!arena) {
+        fprintf(stderr, "Failed to allocate physics arena\n");
+        return nullptr;
+    }
+
+    arena->thread_safe = thread_safe != 0;
+
+    return arena;
+}
+
+void physics_arena_destroy(physics_arena_t* arena) {
+    if (!arena) {
+        return;
+    }
+
+    if (arena->live > 0) {
+        printf("Physics arena released with %u live allocations (%zu bytes)\n", arena->live, arena->bytes_in_use);
+    }
+
+    // Everything goes back at once, individual blocks are never walked
+    alloc_chunk_t* chunk = arena->chunks;
+
+    while (chunk) {
+        alloc_chunk_t* next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+
+    large_block_t* block = arena->large;
+
+    while (block) {
+        large_block_t* next = block->next;
+        free(block->base);
+        block = next;
+    }
+
+    delete arena;
+}
+
+void physics_arena_get_stats(physics_arena_t* arena, physics_alloc_stats_t* stats) {
+    memset(stats, 0, sizeof(physics_alloc_stats_t));
+
+    if (!arena) {
+        stats->bytes_in_use = heap_bytes_in_use.load(std::memory_order_relaxed);
+        stats->peak_bytes = heap_peak_bytes.load(std::memory_order_relaxed);
+        stats->allocations = heap_allocations.load(std::memory_order_relaxed);
+        stats->frees = heap_frees.load(std::memory_order_relaxed);
+        stats->live_allocations = (unsigned int)(stats->allocations - stats->frees);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(arena->mutex);
+
+    stats->bytes_in_use = arena->bytes_in_use;
+    stats->peak_bytes = arena->peak_bytes;
+    stats->bytes_reserved = arena->bytes_reserved;
+    stats->free_bytes = arena->free_bytes;
+    stats->allocations = arena->allocations;
+    stats->frees = arena->frees;
+    stats->live_allocations = arena->live;
+
+    if (arena->bytes_reserved > 0) {
+        stats->fragmentation = 1.0f - (float)((double)arena->bytes_in_use / (double)arena->bytes_reserved);
+    }
+}
@@ -0,0 +1,149 @@
+#include "physics_internal.h"
+#include <stdio.h>
+#include <math.h>
+
+// Static geometry baking
+// Static boxes are merged per XZ grid cell into one btCompoundShape body.
+// The broadphase then holds one proxy per cell instead of one per box, and
+// the compound's own dynamic AABB tree culls its children for the narrowphase
+// and ray tests. Children keep referencing the cached box shapes, so baking
+// frees the bodies and motion states but no shape memory
+
+struct bake_key_t {
+    int cell_x;
+    int cell_z;
+    int group; // Bodies only merge with bodies filtered the same way
+    int mask;
+
+    bool operator==(const bake_key_t& other) const {
+        return cell_x == other.cell_x && cell_z == other.cell_z && group == other.group && mask == other.mask;
+    }
+};
+
+struct bake_key_hash_t {
+    size_t operator()(const bake_key_t& key) const {
+        size_t hash = (size_t)(unsigned int)key.cell_x;
+
+        hash = hash * 31 + (size_t)(unsigned int)key.cell_z;
+        hash = hash * 31 + (size_t)(unsigned int)key.group;
+        hash = hash * 31 + (size_t)(unsigned int)key.mask;
+
+        return hash;
+    }
+};
+
+// Static cached boxes only: meshes and hulls own their shapes, moving bodies can't be merged
+static bool bake_candidate(const btRigidBody* body, const btVector3& region_min, const btVector3& region_max) {
+    const btCollisionShape* shape = body->getCollisionShape();
+    const btVector3& origin = body->getWorldTransform().getOrigin();
+
+    if (!body->isStaticObject() || !shape || shape->getShapeType() != BOX_SHAPE_PROXYTYPE || !shape->getUserPointer() ||
+        !body->getBroadphaseHandle()) {
+        return false;
+    }
+
+    return origin.x() >= region_min.x() && origin.y() >= region_min.y() && origin.z() >= region_min.z() &&
+           origin.x() <= region_max.x() && origin.y() <= region_max.y() && origin.z() <= region_max.z();
+}
+
+static btRigidBody* bake_cell(physics_world_t* world, const bake_key_t& key, const std::vector<btRigidBody*>& bodies) {
+    physics_world_data_t* data = world->data;
+    btVector3 center(0, 0, 0);
+
+    for (btRigidBody* body : bodies) {
+        center += body->getWorldTransform().getOrigin();
+    }
+
+    center /= (btScalar)bodies.size();
+
+    btCompoundShape* compound = new btCompoundShape(true, (int)bodies.size());
+    compound->setUserIndex(SHAPE_BAKED_COMPOUND);
+
+    for (btRigidBody* body : bodies) {
+        btCollisionShape* shape = body->getCollisionShape();
+        shape_entry_t* entry = static_cast<shape_entry_t*>(shape->getUserPointer());
+        btTransform child = body->getWorldTransform();
+
+        child.setOrigin(child.getOrigin() - center);
+        compound->addChildShape(child, shape);
+
+        // The compound takes over the body's reference before the body goes
+        entry->refs++;
+        data->shape_references++;
+        physics_remove_body(world, body);
+    }
+
+    btTransform transform;
+    transform.setIdentity();
+    transform.setOrigin(center);
+
+    btRigidBody::btRigidBodyConstructionInfo rb_info(0.0f, new btDefaultMotionState(transform), compound, btVector3(0, 0, 0));
+    btRigidBody* baked = new btRigidBody(rb_info);
+
+    static_cast<btDiscreteDynamicsWorld*>(world->dynamics_world)->addRigidBody(baked, key.group, key.mask);
+    body_register(data, baked);
+
+    return baked;
+}
+
+extern "C" {
+
+unsigned int physics_bake_static(physics_world_t* world, vec3 region_min, vec3 region_max, float cell_size) {
+    if (!world || !world->dynamics_world || !world->data || !region_min || !region_max) {
+        printf("Error: Invalid physics world\n");
+        return 0;
+    }
+
+    physics_world_data_t* data = world->data;
+    physics_arena_scope_t scope(data->arena);
+
+    if (cell_size <= 0.0f) {
+        cell_size = data->sector_size;
+    }
+
+    btVector3 min(region_min[0], region_min[1], region_min[2]);
+    btVector3 max(region_max[0], region_max[1], region_max[2]);
+    std::unordered_map<bake_key_t, std::vector<btRigidBody*>, bake_key_hash_t> cells;
+
+    // Gathered first, removing bodies reorders the registry
+    for (btRigidBody* body : data->bodies) {
+        if (!bake_candidate(body, min, max)) {
+            continue;
+        }
+
+        const btBroadphaseProxy* proxy = body->getBroadphaseHandle();
+        const btVector3& origin = body->getWorldTransform().getOrigin();
+        bake_key_t key;
+
+        key.cell_x = (int)floorf(origin.x() / cell_size);
+        key.cell_z = (int)floorf(origin.z() / cell_size);
+        key.group = proxy->m_collisionFilterGroup;
+        key.mask = proxy->m_collisionFilterMask;
+
+        cells[key].push_back(body);
+    }
+
+    unsigned int merged = 0;
+    unsigned int compounds = 0;
+
+    for (auto& cell : cells) {
+        // A lone box gains nothing from a compound
+        if (cell.second.size() < 2) {
+            continue;
+        }
+
+        bake_cell(world, cell.first, cell.second);
+        merged += (unsigned int)cell.second.size();
+        compounds++;
+    }
+
+    if (compounds > 0) {
+        physics_broadphase_optimize(world->broadphase);
+    }
+
+    printf("Baked %u static boxes into %u compounds | %.0f m cells\n", merged, compounds, cell_size);
+
+    return merged;
+}
+
+} // extern "C"
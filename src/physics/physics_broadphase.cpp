@@ -0,0 +1,183 @@
+#include "physics_internal.h"
+#include <stdio.h>
+
+// Broadphase selection and measurement
+// The chosen broadphase sits behind a forwarding wrapper that counts AABB
+// updates and times each tick's broadphase work, so levels can compare the
+// algorithms on their own content
+
+// Proxies the sweep and prune broadphase preallocates by default
+#define SAP_DEFAULT_MAX_PROXIES 65536
+#define SAP_DEFAULT_EXTENT 1024.0f
+
+struct timed_broadphase_t : public btBroadphaseInterface {
+    btBroadphaseInterface* inner;
+    physics_broadphase_type_t type;
+
+    // A tick's broadphase work runs from its first AABB update to the end of pair finding
+    bool in_step = false;
+    bool tick_open = false;
+    double tick_start = 0.0;
+    unsigned int tick_updates = 0;
+
+    unsigned int last_updates = 0;
+    double last_update_ms = 0.0;
+    double last_pairs_ms = 0.0;
+    double total_update_ms = 0.0;
+    unsigned long long ticks = 0;
+
+    timed_broadphase_t(btBroadphaseInterface* wrapped, physics_broadphase_type_t wrapped_type)
+        : inner(wrapped), type(wrapped_type) {}
+
+    ~timed_broadphase_t() override {
+        delete inner;
+    }
+
+    btBroadphaseProxy* createProxy(const btVector3& aabb_min, const btVector3& aabb_max, int shape_type, void* user,
+                                   int group, int mask, btDispatcher* dispatcher) override {
+        return inner->createProxy(aabb_min, aabb_max, shape_type, user, group, mask, dispatcher);
+    }
+
+    void destroyProxy(btBroadphaseProxy* proxy, btDispatcher* dispatcher) override {
+        inner->destroyProxy(proxy, dispatcher);
+    }
+
+    void setAabb(btBroadphaseProxy* proxy, const btVector3& aabb_min, const btVector3& aabb_max, btDispatcher* dispatcher) override {
+        if (in_step) {
+            if (!tick_open) {
+                tick_open = true;
+                tick_start = physics_now_ms();
+            }
+
+            tick_updates++;
+        }
+
+        inner->setAabb(proxy, aabb_min, aabb_max, dispatcher);
+    }
+
+    void getAabb(btBroadphaseProxy* proxy, btVector3& aabb_min, btVector3& aabb_max) const override {
+        inner->getAabb(proxy, aabb_min, aabb_max);
+    }
+
+    void rayTest(const btVector3& from, const btVector3& to, btBroadphaseRayCallback& callback,
+                 const btVector3& aabb_min, const btVector3& aabb_max) override {
+        inner->rayTest(from, to, callback, aabb_min, aabb_max);
+    }
+
+    void aabbTest(const btVector3& aabb_min, const btVector3& aabb_max, btBroadphaseAabbCallback& callback) override {
+        inner->aabbTest(aabb_min, aabb_max, callback);
+    }
+
+    void calculateOverlappingPairs(btDispatcher* dispatcher) override {
+        if (!in_step) {
+            inner->calculateOverlappingPairs(dispatcher);
+            return;
+        }
+
+        double start = physics_now_ms();
+        inner->calculateOverlappingPairs(dispatcher);
+        double end = physics_now_ms();
+
+        last_pairs_ms = end - start;
+        last_update_ms = end - (tick_open ? tick_start : start);
+        last_updates = tick_updates;
+        total_update_ms += last_update_ms;
+        ticks++;
+
+        tick_open = false;
+        tick_updates = 0;
+    }
+
+    btOverlappingPairCache* getOverlappingPairCache() override {
+        return inner->getOverlappingPairCache();
+    }
+
+    const btOverlappingPairCache* getOverlappingPairCache() const override {
+        return inner->getOverlappingPairCache();
+    }
+
+    void getBroadphaseAabb(btVector3& aabb_min, btVector3& aabb_max) const override {
+        inner->getBroadphaseAabb(aabb_min, aabb_max);
+    }
+
+    void resetPool(btDispatcher* dispatcher) override {
+        inner->resetPool(dispatcher);
+    }
+
+    void printStats() override {
+        inner->printStats();
+    }
+};
+
+btBroadphaseInterface* physics_broadphase_create(const physics_world_config_t* config) {
+    physics_broadphase_type_t type = config ? config->broadphase : PHYSICS_BROADPHASE_DBVT;
+    btBroadphaseInterface* inner;
+
+    if (type == PHYSICS_BROADPHASE_SAP) {
+        btVector3 world_min(-SAP_DEFAULT_EXTENT, -SAP_DEFAULT_EXTENT, -SAP_DEFAULT_EXTENT);
+        btVector3 world_max(SAP_DEFAULT_EXTENT, SAP_DEFAULT_EXTENT, SAP_DEFAULT_EXTENT);
+
+        // Zero bounds: a cube around the origin
+        if (config->world_min[0] < config->world_max[0] && config->world_min[1] < config->world_max[1] &&
+            config->world_min[2] < config->world_max[2]) {
+            world_min.setValue(config->world_min[0], config->world_min[1], config->world_min[2]);
+            world_max.setValue(config->world_max[0], config->world_max[1], config->world_max[2]);
+        }
+
+        unsigned int max_proxies = config->max_proxies > 0 ? config->max_proxies : SAP_DEFAULT_MAX_PROXIES;
+        inner = new bt32BitAxisSweep3(world_min, world_max, max_proxies);
+
+        printf("Broadphase: 32-bit sweep and prune | %u proxies | (%.0f, %.0f, %.0f) to (%.0f, %.0f, %.0f)\n", max_proxies,
+               world_min.getX(), world_min.getY(), world_min.getZ(), world_max.getX(), world_max.getY(), world_max.getZ());
+    } else {
+        type = PHYSICS_BROADPHASE_DBVT;
+        inner = new btDbvtBroadphase();
+    }
+
+    return new timed_broadphase_t(inner, type);
+}
+
+void physics_broadphase_optimize(btBroadphaseInterface* broadphase) {
+    timed_broadphase_t* timed = static_cast<timed_broadphase_t*>(broadphase);
+
+    // Only the dynamic tree degrades with incremental inserts, sweep and prune stays sorted
+    if (timed->type == PHYSICS_BROADPHASE_DBVT) {
+        static_cast<btDbvtBroadphase*>(timed->inner)->optimize();
+    }
+}
+
+void physics_broadphase_set_stepping(btBroadphaseInterface* broadphase, bool stepping) {
+    timed_broadphase_t* timed = static_cast<timed_broadphase_t*>(broadphase);
+
+    timed->in_step = stepping;
+    timed->tick_open = false;
+    timed->tick_updates = 0;
+}
+
+extern "C" {
+
+physics_broadphase_stats_t physics_get_broadphase_stats(const physics_world_t* world) {
+    physics_broadphase_stats_t stats = {};
+
+    if (!world || !world->dynamics_world || !world->data) {
+        return stats;
+    }
+
+    const timed_broadphase_t* timed = static_cast<const timed_broadphase_t*>(world->broadphase);
+
+    stats.type = timed->type;
+    stats.proxies = (unsigned int)static_cast<btDiscreteDynamicsWorld*>(world->dynamics_world)->getNumCollisionObjects();
+    stats.pairs = (unsigned int)timed->getOverlappingPairCache()->getNumOverlappingPairs();
+    stats.aabb_updates = timed->last_updates;
+    stats.update_ms = timed->last_update_ms;
+    stats.pairs_ms = timed->last_pairs_ms;
+    stats.average_update_ms = timed->ticks > 0 ? timed->total_update_ms / (double)timed->ticks : 0.0;
+    stats.manifolds = (unsigned int)static_cast<const btCollisionDispatcher*>(world->dispatcher)->getNumManifolds();
+    physics_filter_get_stats(world->data, &stats.filter_accepted, &stats.filter_rejected);
+    stats.parked_bodies = world->data->parked_count;
+    stats.unloaded_sectors = (unsigned int)world->data->parked.size();
+
+    return stats;
+}
+
+} // extern "C"
@@ -1,38 +1,341 @@
 #include "physics.h"
-#include <btBulletDynamicsCommon.h>
+#include "physics_internal.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <math.h>
+#include <new>
+#include <BulletCollision/CollisionDispatch/btGhostObject.h>
+
+#if BT_THREADSAFE
+#include <BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
+#include <BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolverMt.h>
+#include <BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h>
+#endif
 
 // C++ wrapper for Bullet Physics to be used from C
 // It's implementation sucks don't mind on this
 
+void body_register(physics_world_data_t* data, btRigidBody* body) {
+    body->setUserIndex((int)data->bodies.size());
+    data->bodies.push_back(body);
+    data->exported.push_back(0);
+    data->previous.push_back(body->getWorldTransform());
+    data->lod.push_back(body_lod_t());
+    data->layout_version++;
+}
+
+void body_unregister(physics_world_data_t* data, btRigidBody* body) {
+    int slot = body->getUserIndex();
+
+    if (slot < 0 || (size_t)slot >= data->bodies.size() || data->bodies[slot] != body) {
+        return;
+    }
+
+    physics_lod_forget(data, body);
+
+    // Swap remove, the moved body must be exported again at its new slot
+    btRigidBody* last = data->bodies.back();
+    data->bodies[slot] = last;
+    data->exported[slot] = 0;
+    data->previous[slot] = data->previous.back();
+    data->lod[slot] = data->lod.back();
+    last->setUserIndex(slot);
+
+    data->bodies.pop_back();
+    data->exported.pop_back();
+    data->previous.pop_back();
+    data->lod.pop_back();
+    data->layout_version++;
+    body->setUserIndex(-1);
+}
+
+static inline void body_interpolated_transform(const physics_world_data_t* data, const btRigidBody* body, btTransform& out) {
+    const btTransform& current = body_current_transform(body);
+
+    if (data->alpha >= 1.0f || body->isStaticObject()) {
+        out = current;
+        return;
+    }
+
+    const btTransform& previous = data->previous[body->getUserIndex()];
+
+    out.setOrigin(previous.getOrigin().lerp(current.getOrigin(), data->alpha));
+    out.setRotation(previous.getRotation().slerp(current.getRotation(), data->alpha));
+}
+
+// Remember the state before the last tick of a frame, rendering blends towards the new one
+static void snapshot_previous(physics_world_data_t* data) {
+    for (size_t i = 0; i < data->bodies.size(); i++) {
+        if (!data->bodies[i]->isStaticObject()) {
+            data->previous[i] = body_current_transform(data->bodies[i]);
+        }
+    }
+}
+
+static void step_ticks(physics_world_t* world, unsigned int steps) {
+    btDiscreteDynamicsWorld* dynamics_world = static_cast<btDiscreteDynamicsWorld*>(world->dynamics_world);
+
+    physics_profile_begin(world);
+    physics_lod_update(world);
+    physics_broadphase_set_stepping(world->broadphase, true);
+
+    for (unsigned int i = 0; i < steps; i++) {
+        if (i == steps - 1) {
+            snapshot_previous(world->data);
+        }
+
+        // maxSubSteps 0: exactly one step of the given length, no internal interpolation
+        physics_lod_pre_tick(world);
+        dynamics_world->stepSimulation(world->data->tick, 0, world->data->tick);
+        physics_lod_post_tick(world, world->data->tick);
+
+        // Every tick so short touches are seen, PERSIST once per call
+        physics_contacts_update(world, i == steps - 1);
+    }
+
+    physics_broadphase_set_stepping(world->broadphase, false);
+    physics_sectors_update(world);
+    physics_profile_end(world, steps);
+}
+
+static btCollisionShape* shape_acquire_box(physics_world_data_t* data, const btVector3& half_extents) {
+    shape_key_t key;
+    key.type = BOX_SHAPE_PROXYTYPE;
+
+    for (int i = 0; i < 3; i++) {
+        key.dims[i] = (int)lroundf(half_extents[i] * SHAPE_QUANTIZE);
+    }
+
+    auto it = data->shapes.find(key);
+
+    if (it == data->shapes.end()) {
+        shape_entry_t entry;
+        entry.shape = new btBoxShape(half_extents);
+        entry.refs = 0;
+        entry.bytes = sizeof(btBoxShape);
+        entry.key = key;
+
+        it = data->shapes.emplace(key, entry).first;
+        it->second.shape->setUserPointer(&it->second);
+        data->shape_bytes += entry.bytes;
+    }
+
+    it->second.refs++;
+    data->shape_references++;
+
+    return it->second.shape;
+}
+
+static void shape_release(physics_world_data_t* data, btCollisionShape* shape) {
+    // Meshes are never shared, their user pointer holds the mesh data
+    if (shape->getShapeType() == TRIANGLE_MESH_SHAPE_PROXYTYPE) {
+        physics_mesh_shape_free(shape);
+        return;
+    }
+
+    // Baked static geometry holds one cache reference per child box
+    if (shape->getShapeType() == COMPOUND_SHAPE_PROXYTYPE && shape->getUserIndex() == SHAPE_BAKED_COMPOUND) {
+        btCompoundShape* compound = static_cast<btCompoundShape*>(shape);
+
+        for (int i = compound->getNumChildShapes() - 1; i >= 0; i--) {
+            shape_release(data, compound->getChildShape(i));
+        }
+
+        delete compound;
+        return;
+    }
+
+    // Generated hulls are never shared either, compounds own their pieces
+    if (shape->getShapeType() == CONVEX_HULL_SHAPE_PROXYTYPE || shape->getShapeType() == COMPOUND_SHAPE_PROXYTYPE) {
+        physics_hull_shape_free(shape);
+        return;
+    }
+
+    shape_entry_t* entry = static_cast<shape_entry_t*>(shape->getUserPointer());
+
+    // Not from the cache, the body owned it alone
+    if (!entry) {
+        delete shape;
+        return;
+    }
+
+    data->shape_references--;
+
+    if (--entry->refs == 0) {
+        shape_key_t key = entry->key; // entry dies with the erase
+
+        data->shape_bytes -= entry->bytes;
+        delete entry->shape;
+        data->shapes.erase(key);
+    }
+}
+
+static body_block_t* block_find(physics_world_data_t* data, btRigidBody* body) {
+    unsigned char* address = reinterpret_cast<unsigned char*>(body);
+
+    for (auto& block : data->blocks) {
+        if (address >= block.bodies && address < block.bodies + (size_t)block.count * sizeof(btRigidBody)) {
+            return &block;
+        }
+    }
+
+    return nullptr;
+}
+
+static void body_free(physics_world_data_t* data, btRigidBody* body) {
+    body_unregister(data, body);
+
+    btMotionState* motion_state = body->getMotionState();
+    btCollisionShape* shape = body->getCollisionShape();
+    body_block_t* block = data->blocks.empty() ? nullptr : block_find(data, body);
+
+    if (block) {
+        // Placement constructed, the block memory goes back when it's empty
+        if (motion_state) {
+            motion_state->~btMotionState();
+        }
+
+        body->~btRigidBody();
+
+        if (--block->live == 0) {
+            btAlignedFree(block->motion_states);
+            btAlignedFree(block->bodies);
+            data->blocks.erase(data->blocks.begin() + (block - data->blocks.data()));
+        }
+    } else {
+        delete motion_state;
+        delete body;
+    }
+
+    if (shape) {
+        shape_release(data, shape);
+    }
+}
+
+// Group and mask 0: Bullet picks static or default filtering from the mass
+static inline void world_add_body(btDiscreteDynamicsWorld* dynamics_world, btRigidBody* body, int group, int mask) {
+    if (group == 0 && mask == 0) {
+        dynamics_world->addRigidBody(body);
+    } else {
+        dynamics_world->addRigidBody(body, group, mask);
+    }
+}
+
 extern "C" {
 
 physics_world_t physics_world_create(void) {
+    physics_world_config_t config = {0};
+
+    return physics_world_create_ex(&config);
+}
+
+physics_world_t physics_world_create_ex(const physics_world_config_t* config) {
     physics_world_t world = {0};
-    
-    // Create collision configuration
-    world.collision_config = new btDefaultCollisionConfiguration();
-    
-    // Create collision dispatcher
-    world.dispatcher = new btCollisionDispatcher(
-        static_cast<btDefaultCollisionConfiguration*>(world.collision_config)
-    );
+
+    physics_alloc_install();
+
+    world.data = new physics_world_data_t();
+
+    int multithreaded = config && config->multithreaded;
+
+#if !BT_THREADSAFE
+    if (multithreaded) {
+        printf("Warning: Bullet built without BT_THREADSAFE, using a single-threaded world\n");
+        multithreaded = 0;
+    }
+#endif
+
+    if (!(config && config->heap_allocator)) {
+        world.data->arena = physics_arena_create(multithreaded);
+    }
+
+    physics_arena_scope_t scope(world.data->arena);
+
+    // Create collision configuration, the threaded world keeps more manifolds in flight
+    btDefaultCollisionConstructionInfo construction_info;
+
+    if (multithreaded) {
+        construction_info.m_defaultMaxPersistentManifoldPoolSize = 80000;
+        construction_info.m_defaultMaxCollisionAlgorithmPoolSize = 80000;
+    }
+
+    world.collision_config = new btDefaultCollisionConfiguration(construction_info);
     
     // Create broadphase
-    world.broadphase = new btDbvtBroadphase();
-    
-    // Create constraint solver
-    world.solver = new btSequentialImpulseConstraintSolver();
-    
-    // Create dynamics world
-    world.dynamics_world = new btDiscreteDynamicsWorld(
-        static_cast<btCollisionDispatcher*>(world.dispatcher),
-        static_cast<btBroadphaseInterface*>(world.broadphase),
-        static_cast<btSequentialImpulseConstraintSolver*>(world.solver),
-        static_cast<btDefaultCollisionConfiguration*>(world.collision_config)
-    );
+    world.broadphase = physics_broadphase_create(config);
+
+    if (config && config->sector_size > 0.0f) {
+        world.data->sector_size = config->sector_size;
+    }
+
+    physics_solver_type_t solver_type = config ? config->solver : PHYSICS_SOLVER_SI;
+
+    if (solver_type < PHYSICS_SOLVER_SI || solver_type > PHYSICS_SOLVER_MLCP_LEMKE) {
+        printf("Warning: Unknown constraint solver %d, using sequential impulse\n", (int)solver_type);
+        solver_type = PHYSICS_SOLVER_SI;
+    }
+
+#if BT_THREADSAFE
+    if (multithreaded) {
+        btITaskScheduler* scheduler = physics_task_scheduler(config->thread_count);
+        unsigned int pool_size = config->solver_pool_size > 0 ? config->solver_pool_size : (unsigned int)scheduler->getNumThreads();
+
+        // Narrowphase pairs are processed in parallel batches
+        world.dispatcher = new btCollisionDispatcherMt(
+            static_cast<btDefaultCollisionConfiguration*>(world.collision_config), 40
+        );
+
+        // Islands are solved concurrently, each by a free solver from the pool.
+        // The pool owns its solvers, islands too large to split go to solver_mt
+        btConstraintSolverPoolMt* solver_pool;
+
+        if (solver_type == PHYSICS_SOLVER_SI) {
+            solver_pool = new btConstraintSolverPoolMt((int)pool_size);
+        } else {
+            std::vector<btConstraintSolver*> solvers(pool_size);
+
+            for (unsigned int i = 0; i < pool_size; i++) {
+                solvers[i] = physics_solver_create(world.data, solver_type);
+            }
+
+            solver_pool = new btConstraintSolverPoolMt(solvers.data(), (int)pool_size);
+        }
+
+        world.data->solver_pool = solver_pool;
+        world.data->solver_mt = new btSequentialImpulseConstraintSolverMt();
+
+        world.dynamics_world = new btDiscreteDynamicsWorldMt(
+            static_cast<btCollisionDispatcher*>(world.dispatcher),
+            static_cast<btBroadphaseInterface*>(world.broadphase),
+            solver_pool,
+            world.data->solver_mt,
+            static_cast<btDefaultCollisionConfiguration*>(world.collision_config)
+        );
+
+        printf("Bullet Physics multithreaded world: %d threads | %u pooled solvers\n", scheduler->getNumThreads(), pool_size);
+    } else
+#endif
+    {
+        // Create collision dispatcher
+        world.dispatcher = new btCollisionDispatcher(
+            static_cast<btDefaultCollisionConfiguration*>(world.collision_config)
+        );
+
+        // Create constraint solver
+        world.solver = physics_solver_create(world.data, solver_type);
+
+        // Create dynamics world
+        world.dynamics_world = new btDiscreteDynamicsWorld(
+            static_cast<btCollisionDispatcher*>(world.dispatcher),
+            static_cast<btBroadphaseInterface*>(world.broadphase),
+            static_cast<btSequentialImpulseConstraintSolver*>(world.solver),
+            static_cast<btDefaultCollisionConfiguration*>(world.collision_config)
+        );
+    }
     
+    physics_solver_setup(&world, solver_type);
+    physics_filter_install(&world);
+
     // Set gravity
     static_cast<btDiscreteDynamicsWorld*>(world.dynamics_world)->setGravity(btVector3(0, -9.81f, 0));
     
@@ -43,13 +346,19 @@ physics_world_t physics_world_create(void) {
 }
 
 btRigidBody* physics_add_box(physics_world_t* world, vec3 pos, vec3 size, float mass) {
+    return physics_add_box_filtered(world, pos, size, mass, 0, 0);
+}
+
+btRigidBody* physics_add_box_filtered(physics_world_t* world, vec3 pos, vec3 size, float mass, int group, int mask) {
     if (!world || !world->dynamics_world) {
         printf("Error: Invalid physics world\n");
         return nullptr;
     }
+
+    physics_arena_scope_t scope(world->data->arena);
     
-    // Create box shape
-    btCollisionShape* box_shape = new btBoxShape(btVector3(size[0]/2, size[1]/2, size[2]/2));
+    // Shared box shape
+    btCollisionShape* box_shape = shape_acquire_box(world->data, btVector3(size[0]/2, size[1]/2, size[2]/2));
     
     // Create motion state
     btTransform start_transform;
@@ -68,7 +377,8 @@ btRigidBody* physics_add_box(physics_world_t* world, vec3 pos, vec3 size, float
     btRigidBody* body = new btRigidBody(rb_info);
     
     // Add to world
-    static_cast<btDiscreteDynamicsWorld*>(world->dynamics_world)->addRigidBody(body);
+    world_add_body(static_cast<btDiscreteDynamicsWorld*>(world->dynamics_world), body, group, mask);
+    body_register(world->data, body);
     
     printf("Added physics box at (%.2f, %.2f, %.2f) with mass %.2f\n", 
            pos[0], pos[1], pos[2], mass);
@@ -76,14 +386,357 @@ btRigidBody* physics_add_box(physics_world_t* world, vec3 pos, vec3 size, float
     return body;
 }
 
+unsigned int physics_add_boxes(physics_world_t* world, unsigned int count, const vec3* positions, const vec3* sizes,
+                               const float* masses, const versor* orientations, btRigidBody** out_bodies) {
+    return physics_add_boxes_filtered(world, count, positions, sizes, masses, orientations, 0, 0, out_bodies);
+}
+
+unsigned int physics_add_boxes_filtered(physics_world_t* world, unsigned int count, const vec3* positions, const vec3* sizes,
+                                        const float* masses, const versor* orientations, int group, int mask,
+                                        btRigidBody** out_bodies) {
+    if (!world || !world->dynamics_world) {
+        printf("Error: Invalid physics world\n");
+        return 0;
+    }
+
+    if (count == 0 || !positions || !sizes || !masses) {
+        return 0;
+    }
+
+    physics_arena_scope_t scope(world->data->arena);
+
+    body_block_t block;
+    block.motion_states = static_cast<unsigned char*>(btAlignedAlloc(sizeof(btDefaultMotionState) * count, 16));
+    block.bodies = static_cast<unsigned char*>(btAlignedAlloc(sizeof(btRigidBody) * count, 16));
+    block.count = count;
+    block.live = count;
+
+    if (!block.motion_states || !block.bodies) {
+        fprintf(stderr, "Failed to allocate %u physics bodies\n", count);
+        btAlignedFree(block.motion_states);
+        btAlignedFree(block.bodies);
+        return 0;
+    }
+
+    btDiscreteDynamicsWorld* dynamics_world = static_cast<btDiscreteDynamicsWorld*>(world->dynamics_world);
+    dynamics_world->getCollisionObjectArray().reserve(dynamics_world->getNumCollisionObjects() + (int)count);
+    world->data->bodies.reserve(world->data->bodies.size() + count);
+    world->data->exported.reserve(world->data->exported.size() + count);
+    world->data->previous.reserve(world->data->previous.size() + count);
+    world->data->lod.reserve(world->data->lod.size() + count);
+
+    // Neighbouring boxes are usually the same size, skip the cache lookup then
+    btCollisionShape* last_shape = nullptr;
+    btVector3 last_half_extents(0, 0, 0);
+    unsigned int static_count = 0;
+
+    for (unsigned int i = 0; i < count; i++) {
+        btVector3 half_extents(sizes[i][0] / 2, sizes[i][1] / 2, sizes[i][2] / 2);
+        btCollisionShape* box_shape;
+
+        if (last_shape && half_extents == last_half_extents) {
+            box_shape = last_shape;
+            static_cast<shape_entry_t*>(box_shape->getUserPointer())->refs++;
+            world->data->shape_references++;
+        } else {
+            box_shape = shape_acquire_box(world->data, half_extents);
+            last_shape = box_shape;
+            last_half_extents = half_extents;
+        }
+
+        btTransform start_transform;
+        start_transform.setIdentity();
+        start_transform.setOrigin(btVector3(positions[i][0], positions[i][1], positions[i][2]));
+
+        if (orientations) {
+            start_transform.setRotation(btQuaternion(orientations[i][0], orientations[i][1], orientations[i][2], orientations[i][3]));
+        }
+
+        btDefaultMotionState* motion_state = new (block.motion_states + (size_t)i * sizeof(btDefaultMotionState))
+            btDefaultMotionState(start_transform);
+
+        float mass = masses[i];
+        btVector3 local_inertia(0, 0, 0);
+
+        if (mass != 0.0f) {
+            box_shape->calculateLocalInertia(mass, local_inertia);
+        } else {
+            static_count++;
+        }
+
+        btRigidBody::btRigidBodyConstructionInfo rb_info(mass, motion_state, box_shape, local_inertia);
+        btRigidBody* body = new (block.bodies + (size_t)i * sizeof(btRigidBody)) btRigidBody(rb_info);
+
+        world_add_body(dynamics_world, body, group, mask);
+        body_register(world->data, body);
+
+        if (out_bodies) {
+            out_bodies[i] = body;
+        }
+    }
+
+    world->data->blocks.push_back(block);
+
+    // Incremental inserts leave the dynamic tree unbalanced, rebuild it top-down once
+    physics_broadphase_optimize(world->broadphase);
+
+    printf("Added %u physics boxes (%u static)\n", count, static_count);
+
+    return count;
+}
+
+void physics_remove_body(physics_world_t* world, btRigidBody* body) {
+    if (!world || !world->dynamics_world || !body) {
+        return;
+    }
+
+    physics_arena_scope_t scope(world->data->arena);
+
+    // Parked in an unloaded sector: already out of the world and the registry
+    if (body->getUserIndex() < 0 && physics_sectors_forget(world->data, body)) {
+        body_free(world->data, body);
+        return;
+    }
+
+    physics_contacts_forget(world->data, body);
+    static_cast<btDiscreteDynamicsWorld*>(world->dynamics_world)->removeRigidBody(body);
+    body_free(world->data, body);
+}
+
+btRigidBody* physics_add_static_mesh(physics_world_t* world, vec3 pos, const float* positions, unsigned int vertex_count,
+                                     const unsigned int* indices, unsigned int index_count, const char* cache_path) {
+    if (!world || !world->dynamics_world) {
+        printf("Error: Invalid physics world\n");
+        return nullptr;
+    }
+
+    if (!positions || !indices || vertex_count == 0 || index_count < 3 || index_count % 3 != 0) {
+        fprintf(stderr, "Invalid static mesh data\n");
+        return nullptr;
+    }
+
+    physics_arena_scope_t scope(world->data->arena);
+
+    btCollisionShape* mesh_shape = physics_mesh_shape_create(positions, vertex_count, indices, index_count, cache_path);
+
+    if (!mesh_shape) {
+        return nullptr;
+    }
+
+    btTransform start_transform;
+    start_transform.setIdentity();
+    start_transform.setOrigin(btVector3(pos[0], pos[1], pos[2]));
+    btDefaultMotionState* motion_state = new btDefaultMotionState(start_transform);
+
+    btRigidBody::btRigidBodyConstructionInfo rb_info(0.0f, motion_state, mesh_shape, btVector3(0, 0, 0));
+    btRigidBody* body = new btRigidBody(rb_info);
+
+    static_cast<btDiscreteDynamicsWorld*>(world->dynamics_world)->addRigidBody(body);
+    body_register(world->data, body);
+
+    printf("Added static mesh: %u vertices | %u triangles\n", vertex_count, index_count / 3);
+
+    return body;
+}
+
+btRigidBody* physics_add_convex_hull(physics_world_t* world, vec3 pos, float mass, const float* positions, unsigned int vertex_count,
+                                     const unsigned int* indices, unsigned int index_count, const physics_hull_params_t* params,
+                                     const char* cache_dir, mat4 mesh_transform) {
+    if (!world || !world->dynamics_world) {
+        printf("Error: Invalid physics world\n");
+        return nullptr;
+    }
+
+    if (!positions || vertex_count < 4 || (indices && index_count % 3 != 0)) {
+        fprintf(stderr, "Invalid convex hull mesh data\n");
+        return nullptr;
+    }
+
+    for (unsigned int i = 0; indices && i < index_count; i++) {
+        if (indices[i] >= vertex_count) {
+            fprintf(stderr, "Convex hull index %u out of range: %u vertices\n", indices[i], vertex_count);
+            return nullptr;
+        }
+    }
+
+    physics_arena_scope_t scope(world->data->arena);
+
+    btTransform principal;
+    btVector3 unit_inertia;
+    btCollisionShape* hull_shape = physics_hull_shape_create(positions, vertex_count, indices, index_count, params, cache_dir,
+                                                             principal, unit_inertia);
+
+    if (!hull_shape) {
+        return nullptr;
+    }
+
+    // The body sits at the hull's center of mass, pos is where the mesh origin goes
+    btTransform mesh_origin;
+    mesh_origin.setIdentity();
+    mesh_origin.setOrigin(btVector3(pos[0], pos[1], pos[2]));
+    btTransform start_transform = mesh_origin * principal;
+    btDefaultMotionState* motion_state = new btDefaultMotionState(start_transform);
+
+    if (mesh_transform) {
+        principal.inverse().getOpenGLMatrix(&mesh_transform[0][0]);
+    }
+
+    btVector3 local_inertia(0, 0, 0);
+    if (mass != 0.0f) {
+        local_inertia = unit_inertia * mass;
+    }
+
+    btRigidBody::btRigidBodyConstructionInfo rb_info(mass, motion_state, hull_shape, local_inertia);
+    btRigidBody* body = new btRigidBody(rb_info);
+
+    world_add_body(static_cast<btDiscreteDynamicsWorld*>(world->dynamics_world), body, 0, 0);
+    body_register(world->data, body);
+
+    int pieces = hull_shape->getShapeType() == COMPOUND_SHAPE_PROXYTYPE
+        ? static_cast<btCompoundShape*>(hull_shape)->getNumChildShapes()
+        : 1;
+
+    printf("Added convex hull at (%.2f, %.2f, %.2f): %d pieces | mass %.2f\n", pos[0], pos[1], pos[2], pieces, mass);
+
+    return body;
+}
+
+btGhostObject* physics_add_trigger_box(physics_world_t* world, vec3 pos, vec3 size) {
+    if (!world || !world->dynamics_world) {
+        printf("Error: Invalid physics world\n");
+        return nullptr;
+    }
+
+    physics_arena_scope_t scope(world->data->arena);
+
+    btTransform transform;
+    transform.setIdentity();
+    transform.setOrigin(btVector3(pos[0], pos[1], pos[2]));
+
+    btGhostObject* trigger = new btGhostObject();
+    trigger->setCollisionShape(shape_acquire_box(world->data, btVector3(size[0]/2, size[1]/2, size[2]/2)));
+    trigger->setWorldTransform(transform);
+    trigger->setCollisionFlags(trigger->getCollisionFlags() | btCollisionObject::CF_NO_CONTACT_RESPONSE);
+
+    // Overlaps with dynamic bodies only, static geometry and other triggers are ignored
+    static_cast<btDiscreteDynamicsWorld*>(world->dynamics_world)->addCollisionObject(
+        trigger,
+        btBroadphaseProxy::SensorTrigger,
+        btBroadphaseProxy::AllFilter ^ (btBroadphaseProxy::StaticFilter | btBroadphaseProxy::SensorTrigger)
+    );
+
+    printf("Added trigger box at (%.2f, %.2f, %.2f)\n", pos[0], pos[1], pos[2]);
+
+    return trigger;
+}
+
+void physics_remove_trigger(physics_world_t* world, btGhostObject* trigger) {
+    if (!world || !world->dynamics_world || !trigger) {
+        return;
+    }
+
+    physics_arena_scope_t scope(world->data->arena);
+    physics_contacts_forget(world->data, trigger);
+    static_cast<btDiscreteDynamicsWorld*>(world->dynamics_world)->removeCollisionObject(trigger);
+
+    btCollisionShape* shape = trigger->getCollisionShape();
+    delete trigger;
+
+    if (shape) {
+        shape_release(world->data, shape);
+    }
+}
+
+void physics_apply_central_force(btRigidBody* body, vec3 force) {
+    if (!body) {
+        return;
+    }
+
+    body->activate();
+    body->applyCentralForce(btVector3(force[0], force[1], force[2]));
+}
+
+void physics_apply_central_impulse(btRigidBody* body, vec3 impulse) {
+    if (!body) {
+        return;
+    }
+
+    body->activate();
+    body->applyCentralImpulse(btVector3(impulse[0], impulse[1], impulse[2]));
+}
+
 void physics_step_simulation(physics_world_t* world, float delta_time) {
     if (!world || !world->dynamics_world) {
         return;
     }
     
-    static_cast<btDiscreteDynamicsWorld*>(world->dynamics_world)->stepSimulation(
-        delta_time, 10, 1.0f/60.0f
-    );
+    physics_world_data_t* data = world->data;
+    physics_arena_scope_t scope(data->arena);
+
+    if (data->tick <= 0.0f) {
+        // The whole call counts as one LOD tick
+        physics_profile_begin(world);
+        physics_lod_update(world);
+        physics_lod_pre_tick(world);
+        physics_broadphase_set_stepping(world->broadphase, true);
+        int substeps = static_cast<btDiscreteDynamicsWorld*>(world->dynamics_world)->stepSimulation(
+            delta_time, 10, 1.0f/60.0f
+        );
+        physics_broadphase_set_stepping(world->broadphase, false);
+        physics_lod_post_tick(world, delta_time);
+        physics_contacts_update(world, true);
+        physics_sectors_update(world);
+        physics_profile_end(world, (unsigned int)substeps);
+        data->alpha = 1.0f;
+        return;
+    }
+
+    data->accumulator += delta_time;
+
+    unsigned int steps = (unsigned int)(data->accumulator / data->tick);
+
+    // Over budget: drop the excess instead of spiralling into ever longer frames
+    if (steps > data->max_steps) {
+        steps = data->max_steps;
+        data->accumulator = steps * data->tick;
+    }
+
+    step_ticks(world, steps);
+
+    data->accumulator -= steps * data->tick;
+    data->alpha = data->accumulator / data->tick;
+}
+
+void physics_step_fixed(physics_world_t* world, unsigned int steps) {
+    if (!world || !world->dynamics_world || steps == 0) {
+        return;
+    }
+
+    if (world->data->tick <= 0.0f) {
+        world->data->tick = 1.0f / PHYSICS_TICK_RATE;
+    }
+
+    physics_arena_scope_t scope(world->data->arena);
+
+    step_ticks(world, steps);
+
+    world->data->accumulator = 0.0f;
+    world->data->alpha = 1.0f;
+}
+
+void physics_set_fixed_timestep(physics_world_t* world, float tick_rate, unsigned int max_steps) {
+    if (!world || !world->data) {
+        return;
+    }
+
+    world->data->tick = tick_rate > 0.0f ? 1.0f / tick_rate : 0.0f;
+    world->data->max_steps = max_steps > 0 ? max_steps : 1;
+    world->data->accumulator = 0.0f;
+    world->data->alpha = 1.0f;
+}
+
+float physics_get_interpolation_alpha(const physics_world_t* world) {
+    return world && world->data ? world->data->alpha : 1.0f;
 }
 
 void physics_get_transform(btRigidBody* body, vec3 pos, mat4 rotation) {
@@ -103,47 +756,175 @@ void physics_get_transform(btRigidBody* body, vec3 pos, mat4 rotation) {
     pos[1] = origin.getY();
     pos[2] = origin.getZ();
     
-    // Extract rotation matrix
+    // Extract rotation matrix: basis is row-major, cglm is column-major
     btMatrix3x3 basis = trans.getBasis();
-    rotation[0][0] = basis[0][0]; rotation[0][1] = basis[0][1]; rotation[0][2] = basis[0][2]; rotation[0][3] = 0.0f;
-    rotation[1][0] = basis[1][0]; rotation[1][1] = basis[1][1]; rotation[1][2] = basis[1][2]; rotation[1][3] = 0.0f;
-    rotation[2][0] = basis[2][0]; rotation[2][1] = basis[2][1]; rotation[2][2] = basis[2][2]; rotation[2][3] = 0.0f;
+    rotation[0][0] = basis[0][0]; rotation[0][1] = basis[1][0]; rotation[0][2] = basis[2][0]; rotation[0][3] = 0.0f;
+    rotation[1][0] = basis[0][1]; rotation[1][1] = basis[1][1]; rotation[1][2] = basis[2][1]; rotation[1][3] = 0.0f;
+    rotation[2][0] = basis[0][2]; rotation[2][1] = basis[1][2]; rotation[2][2] = basis[2][2]; rotation[2][3] = 0.0f;
     rotation[3][0] = 0.0f;        rotation[3][1] = 0.0f;        rotation[3][2] = 0.0f;        rotation[3][3] = 1.0f;
 }
 
+void physics_get_model_matrix(btRigidBody* body, mat4 model) {
+    if (!body) {
+        glm_mat4_identity(model);
+        return;
+    }
+
+    btTransform trans;
+    body->getMotionState()->getWorldTransform(trans);
+    transform_to_matrix(trans, (float*)model);
+}
+
+void physics_get_interpolated_matrix(physics_world_t* world, btRigidBody* body, mat4 model) {
+    if (!world || !world->data || !body || body->getUserIndex() < 0) {
+        physics_get_model_matrix(body, model);
+        return;
+    }
+
+    btTransform trans;
+    body_interpolated_transform(world->data, body, trans);
+    transform_to_matrix(trans, (float*)model);
+}
+
+int physics_body_index(btRigidBody* body) {
+    return body ? body->getUserIndex() : -1;
+}
+
+unsigned int physics_export_transforms(physics_world_t* world, float* matrices, unsigned int capacity, unsigned int* changed_indices) {
+    if (!world || !world->data || !matrices) {
+        return 0;
+    }
+
+    physics_world_data_t* data = world->data;
+    unsigned int count = (unsigned int)data->bodies.size();
+    unsigned int changed = 0;
+    bool interpolate = data->alpha < 1.0f;
+
+    if (count > capacity) {
+        count = capacity;
+    }
+
+    for (unsigned int i = 0; i < count; i++) {
+        btRigidBody* body = data->bodies[i];
+
+        // Sleeping and static bodies keep what the caller already has
+        if (data->exported[i] && (!body->isActive() || body->isStaticObject())) {
+            continue;
+        }
+
+        if (interpolate) {
+            btTransform trans;
+            body_interpolated_transform(data, body, trans);
+            transform_to_matrix(trans, matrices + (size_t)i * 16);
+        } else {
+            transform_to_matrix(body_current_transform(body), matrices + (size_t)i * 16);
+        }
+
+        data->exported[i] = 1;
+
+        if (changed_indices) {
+            changed_indices[changed] = i;
+        }
+
+        changed++;
+    }
+
+    return changed;
+}
+
 void physics_world_destroy(physics_world_t* world) {
     if (!world || !world->dynamics_world) {
         return;
     }
     
     btDiscreteDynamicsWorld* dynamics_world = static_cast<btDiscreteDynamicsWorld*>(world->dynamics_world);
+    physics_arena_scope_t scope(world->data->arena);
+
+    // Hands Bullet's profile hooks back once no world uses them
+    physics_profile_enable(world, 0);
     
-    // Remove all rigid bodies
+    // Remove all rigid bodies, releasing their shapes while the objects still exist
     for (int i = dynamics_world->getNumCollisionObjects() - 1; i >= 0; i--) {
         btCollisionObject* obj = dynamics_world->getCollisionObjectArray()[i];
         btRigidBody* body = btRigidBody::upcast(obj);
-        if (body && body->getMotionState()) {
-            delete body->getMotionState();
-        }
         dynamics_world->removeCollisionObject(obj);
-        delete obj;
+
+        if (body) {
+            body_free(world->data, body);
+        } else {
+            shape_release(world->data, obj->getCollisionShape());
+            delete obj;
+        }
     }
-    
-    // Delete collision shapes
-    for (int i = 0; i < dynamics_world->getNumCollisionObjects(); i++) {
-        btCollisionObject* obj = dynamics_world->getCollisionObjectArray()[i];
-        btCollisionShape* shape = obj->getCollisionShape();
-        delete shape;
+
+    // Parked bodies are outside the world, free them with their sectors
+    for (auto& sector : world->data->parked) {
+        for (const parked_body_t& parked : sector.second) {
+            body_free(world->data, parked.body);
+        }
     }
-    
+
+    world->data->parked.clear();
+
+    // Anything still cached is a leak in the reference counting
+    for (auto& it : world->data->shapes) {
+        delete it.second.shape;
+    }
+
     // Delete dynamics world
     delete static_cast<btDiscreteDynamicsWorld*>(world->dynamics_world);
     delete static_cast<btSequentialImpulseConstraintSolver*>(world->solver);
+    delete world->data->solver_pool;
+    delete world->data->solver_mt;
+    physics_solver_destroy(world->data);
     delete static_cast<btBroadphaseInterface*>(world->broadphase);
+    physics_filter_destroy(world->data);
     delete static_cast<btCollisionDispatcher*>(world->dispatcher);
     delete static_cast<btDefaultCollisionConfiguration*>(world->collision_config);
+
+    // Whatever Bullet still holds for this world goes back in one release
+    physics_arena_destroy(world->data->arena);
+
+    delete world->data;
+    world->data = nullptr;
+    world->dynamics_world = nullptr;
     
     printf("Bullet Physics world destroyed\n");
 }
 
+physics_stats_t physics_get_stats(const physics_world_t* world) {
+    physics_stats_t stats = {};
+
+    if (!world || !world->dynamics_world || !world->data) {
+        return stats;
+    }
+
+    stats.body_count = (unsigned int)static_cast<btDiscreteDynamicsWorld*>(world->dynamics_world)->getNumCollisionObjects();
+    stats.shape_count = (unsigned int)world->data->shapes.size();
+    stats.shape_references = world->data->shape_references;
+    stats.shape_bytes = world->data->shape_bytes;
+    stats.contact_pairs = (unsigned int)world->data->pairs.size();
+    stats.contact_events_dropped = world->data->events_dropped;
+    stats.lod_reduced = (unsigned int)world->data->lod_reduced.size();
+    stats.lod_frozen = world->data->lod_frozen;
+
+    for (const auto& it : world->data->shapes) {
+        stats.shape_bytes_saved += (size_t)(it.second.refs - 1) * it.second.bytes;
+    }
+
+    return stats;
+}
+
+physics_alloc_stats_t physics_get_alloc_stats(const physics_world_t* world) {
+    physics_alloc_stats_t stats = {};
+
+    if (!world || !world->dynamics_world || !world->data) {
+        return stats;
+    }
+
+    physics_arena_get_stats(world->data->arena, &stats);
+
+    return stats;
+}
+
 } // extern "C"
@@ -0,0 +1,295 @@
+#include "physics_internal.h"
+#include <BulletCollision/CollisionDispatch/btGhostObject.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+// Contact event stream: touching pairs of this tick are diffed against the
+// last tick and BEGIN/PERSIST/END events go into a fixed ring that the game
+// drains once per frame. Pair lists keep their capacity, so steady state
+// ticks don't allocate
+
+static void event_push(physics_world_data_t* data, physics_contact_type_t type, const contact_pair_t& pair) {
+    unsigned int capacity = (unsigned int)data->events.size();
+
+    if (data->event_count == capacity) {
+        data->events_dropped++;
+        return;
+    }
+
+    physics_contact_event_t& event = data->events[(data->event_head + data->event_count) % capacity];
+    data->event_count++;
+
+    event.type = type;
+    event.body_a = pair.body_a;
+    event.body_b = pair.body_b;
+    event.trigger = pair.trigger;
+    event.impulse = type == PHYSICS_CONTACT_END ? 0.0f : pair.impulse;
+
+    if (type == PHYSICS_CONTACT_END) {
+        memset(event.point, 0, sizeof(vec3));
+        memset(event.normal, 0, sizeof(vec3));
+        return;
+    }
+
+    event.point[0] = pair.point.getX();
+    event.point[1] = pair.point.getY();
+    event.point[2] = pair.point.getZ();
+    event.normal[0] = pair.normal.getX();
+    event.normal[1] = pair.normal.getY();
+    event.normal[2] = pair.normal.getZ();
+}
+
+// Objects are resolved once when the pair starts touching, END never dereferences them
+static bool pair_resolve(contact_pair_t& pair) {
+    const btGhostObject* ghost_a = btGhostObject::upcast(pair.a);
+    const btGhostObject* ghost_b = btGhostObject::upcast(pair.b);
+
+    pair.trigger = nullptr;
+
+    if (ghost_a && ghost_b) {
+        return false;
+    }
+
+    if (ghost_a || ghost_b) {
+        pair.trigger = const_cast<btGhostObject*>(ghost_a ? ghost_a : ghost_b);
+        pair.body_a = const_cast<btRigidBody*>(btRigidBody::upcast(ghost_a ? pair.b : pair.a));
+        pair.body_b = nullptr;
+
+        // Normal points from the trigger towards the body
+        if (ghost_a) {
+            pair.normal = -pair.normal;
+        }
+    } else {
+        pair.body_a = const_cast<btRigidBody*>(btRigidBody::upcast(pair.a));
+        pair.body_b = const_cast<btRigidBody*>(btRigidBody::upcast(pair.b));
+    }
+
+    return true;
+}
+
+static void gather_pairs(physics_world_t* world, std::vector<contact_pair_t>& pairs) {
+    btDispatcher* dispatcher = static_cast<btCollisionDispatcher*>(world->dispatcher);
+    int manifold_count = dispatcher->getNumManifolds();
+
+    pairs.clear();
+
+    for (int i = 0; i < manifold_count; i++) {
+        const btPersistentManifold* manifold = dispatcher->getManifoldByIndexInternal(i);
+        int contact_count = manifold->getNumContacts();
+        int deepest = -1;
+        float depth = 0.0f;
+        float impulse = 0.0f;
+
+        // Manifolds linger within the contact threshold, only penetrating points count as touching
+        for (int j = 0; j < contact_count; j++) {
+            const btManifoldPoint& point = manifold->getContactPoint(j);
+
+            impulse += point.getAppliedImpulse();
+
+            if (point.getDistance() < depth) {
+                depth = point.getDistance();
+                deepest = j;
+            }
+        }
+
+        if (deepest < 0) {
+            continue;
+        }
+
+        const btManifoldPoint& point = manifold->getContactPoint(deepest);
+        const btCollisionObject* body0 = manifold->getBody0();
+        const btCollisionObject* body1 = manifold->getBody1();
+        contact_pair_t pair;
+
+        // Normal on B points towards A, flip it along with the order
+        if (body0 < body1) {
+            pair.a = body0;
+            pair.b = body1;
+            pair.point = point.getPositionWorldOnB();
+            pair.normal = point.m_normalWorldOnB;
+        } else {
+            pair.a = body1;
+            pair.b = body0;
+            pair.point = point.getPositionWorldOnA();
+            pair.normal = -point.m_normalWorldOnB;
+        }
+
+        pair.body_a = nullptr;
+        pair.body_b = nullptr;
+        pair.trigger = nullptr;
+        pair.depth = depth;
+        pair.impulse = impulse;
+        pairs.push_back(pair);
+    }
+
+    std::sort(pairs.begin(), pairs.end());
+
+    // Compound shapes produce several manifolds per object pair, fold them into one
+    size_t out = 0;
+
+    for (size_t i = 0; i < pairs.size(); i++) {
+        if (out > 0 && pairs[out - 1].a == pairs[i].a && pairs[out - 1].b == pairs[i].b) {
+            contact_pair_t& merged = pairs[out - 1];
+            merged.impulse += pairs[i].impulse;
+
+            if (pairs[i].depth < merged.depth) {
+                merged.depth = pairs[i].depth;
+                merged.point = pairs[i].point;
+                merged.normal = pairs[i].normal;
+            }
+        } else {
+            pairs[out++] = pairs[i];
+        }
+    }
+
+    pairs.resize(out);
+}
+
+void physics_contacts_update(physics_world_t* world, bool emit_persist) {
+    physics_world_data_t* data = world->data;
+
+    if (data->events.empty()) {
+        return;
+    }
+
+    std::vector<contact_pair_t>& previous = data->pairs;
+    std::vector<contact_pair_t>& current = data->pairs_next;
+
+    gather_pairs(world, current);
+
+    // Both lists are sorted: one merge pass finds started, ongoing and finished pairs
+    size_t i = 0;
+    size_t j = 0;
+    size_t kept = 0;
+
+    while (i < previous.size() || j < current.size()) {
+        if (j == current.size() || (i < previous.size() && previous[i] < current[j])) {
+            event_push(data, PHYSICS_CONTACT_END, previous[i]);
+            i++;
+        } else if (i == previous.size() || current[j] < previous[i]) {
+            if (pair_resolve(current[j])) {
+                event_push(data, PHYSICS_CONTACT_BEGIN, current[j]);
+                current[kept++] = current[j];
+            }
+            j++;
+        } else {
+            // Keep the resolved pointers and orientation of the first tick
+            btVector3 normal = current[j].normal;
+            current[j].body_a = previous[i].body_a;
+            current[j].body_b = previous[i].body_b;
+            current[j].trigger = previous[i].trigger;
+
+            if (previous[i].trigger && previous[i].trigger == current[j].a) {
+                normal = -normal;
+            }
+
+            current[j].normal = normal;
+
+            if (emit_persist) {
+                event_push(data, PHYSICS_CONTACT_PERSIST, current[j]);
+            }
+
+            current[kept++] = current[j];
+            i++;
+            j++;
+        }
+    }
+
+    // Trigger against trigger pairs were dropped while merging
+    current.resize(kept);
+    previous.swap(current);
+}
+
+void physics_contacts_reset(physics_world_t* world) {
+    physics_world_data_t* data = world->data;
+
+    if (data->events.empty()) {
+        return;
+    }
+
+    // Taken as the last tick's pairs without events, the next tick diffs against them
+    gather_pairs(world, data->pairs);
+
+    size_t kept = 0;
+
+    for (size_t i = 0; i < data->pairs.size(); i++) {
+        if (pair_resolve(data->pairs[i])) {
+            data->pairs[kept++] = data->pairs[i];
+        }
+    }
+
+    data->pairs.resize(kept);
+}
+
+void physics_contacts_forget(physics_world_data_t* data, const btCollisionObject* object) {
+    if (data->events.empty()) {
+        return;
+    }
+
+    size_t kept = 0;
+
+    for (size_t i = 0; i < data->pairs.size(); i++) {
+        if (data->pairs[i].a == object || data->pairs[i].b == object) {
+            event_push(data, PHYSICS_CONTACT_END, data->pairs[i]);
+        } else {
+            data->pairs[kept++] = data->pairs[i];
+        }
+    }
+
+    data->pairs.resize(kept);
+}
+
+extern "C" {
+
+int physics_enable_contact_events(physics_world_t* world, unsigned int capacity) {
+    if (!world || !world->data) {
+        printf("Error: Invalid physics world\n");
+        return -1;
+    }
+
+    physics_world_data_t* data = world->data;
+
+    data->events.clear();
+    data->events.shrink_to_fit();
+    data->pairs.clear();
+    data->event_head = 0;
+    data->event_count = 0;
+    data->events_dropped = 0;
+
+    if (capacity == 0) {
+        return 0;
+    }
+
+    data->events.resize(capacity);
+
+    // Room for a busy scene up front, growth after that is rare
+    data->pairs.reserve(capacity);
+    data->pairs_next.reserve(capacity);
+
+    return 0;
+}
+
+unsigned int physics_drain_contact_events(physics_world_t* world, physics_contact_event_t* events, unsigned int max_events) {
+    if (!world || !world->data || !events) {
+        return 0;
+    }
+
+    physics_world_data_t* data = world->data;
+    unsigned int capacity = (unsigned int)data->events.size();
+    unsigned int count = data->event_count < max_events ? data->event_count : max_events;
+
+    for (unsigned int i = 0; i < count; i++) {
+        events[i] = data->events[(data->event_head + i) % capacity];
+    }
+
+    if (capacity > 0) {
+        data->event_head = (data->event_head + count) % capacity;
+    }
+
+    data->event_count -= count;
+
+    return count;
+}
+
+} // extern "C"
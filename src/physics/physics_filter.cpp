@@ -0,0 +1,153 @@
+#include "physics_internal.h"
+#include <stdio.h>
+#include <atomic>
+
+// Broadphase pair filtering
+// A pair reaches the narrowphase only when each side's group is in the
+// other's mask and no group pair rule disables it. Rules cover pair classes
+// masks can't express without touching every body, e.g. debris vs debris.
+// Bullet asks the filter whenever the broadphase reports an overlap: with
+// DBVT that is again each time a proxy leaves its fattened AABB, so the
+// counters are filter calls, not distinct new overlaps
+
+#define FILTER_GROUP_BITS 32
+
+struct collision_filter_t : public btOverlapFilterCallback {
+    uint32_t disabled[FILTER_GROUP_BITS] = {}; // Bit j of entry i: groups i and j never collide
+    bool any_disabled = false;
+
+    mutable std::atomic<unsigned long long> accepted{0};
+    mutable std::atomic<unsigned long long> rejected{0};
+
+    bool collides(int group0, int mask0, int group1, int mask1) const {
+        if (!(group0 & mask1) || !(group1 & mask0)) {
+            return false;
+        }
+
+        if (!any_disabled) {
+            return true;
+        }
+
+        // Every group bit of one side disabled against every group bit of the other
+        for (uint32_t bits = (uint32_t)group0; bits; bits &= bits - 1) {
+            if (((uint32_t)group1 & ~disabled[__builtin_ctz(bits)]) != 0) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool needBroadphaseCollision(btBroadphaseProxy* proxy0, btBroadphaseProxy* proxy1) const override {
+        bool result = collides(proxy0->m_collisionFilterGroup, proxy0->m_collisionFilterMask,
+                               proxy1->m_collisionFilterGroup, proxy1->m_collisionFilterMask);
+
+        (result ? accepted : rejected).fetch_add(1, std::memory_order_relaxed);
+
+        return result;
+    }
+};
+
+// Drops cached pairs a new rule forbids, their manifolds go with them
+struct filter_cleanup_t : public btOverlapCallback {
+    const collision_filter_t* filter;
+
+    explicit filter_cleanup_t(const collision_filter_t* owner) : filter(owner) {}
+
+    bool processOverlap(btBroadphasePair& pair) override {
+        return !filter->collides(pair.m_pProxy0->m_collisionFilterGroup, pair.m_pProxy0->m_collisionFilterMask,
+                                 pair.m_pProxy1->m_collisionFilterGroup, pair.m_pProxy1->m_collisionFilterMask);
+    }
+};
+
+void physics_filter_install(physics_world_t* world) {
+    collision_filter_t* filter = new collision_filter_t();
+
+    static_cast<btBroadphaseInterface*>(world->broadphase)->getOverlappingPairCache()->setOverlapFilterCallback(filter);
+    world->data->filter = filter;
+}
+
+void physics_filter_destroy(physics_world_data_t* data) {
+    delete data->filter;
+    data->filter = nullptr;
+}
+
+bool physics_filter_collides(const collision_filter_t* filter, int group0, int mask0, int group1, int mask1) {
+    return filter->collides(group0, mask0, group1, mask1);
+}
+
+void physics_filter_get_stats(const physics_world_data_t* data, unsigned long long* accepted, unsigned long long* rejected) {
+    *accepted = data->filter ? data->filter->accepted.load(std::memory_order_relaxed) : 0;
+    *rejected = data->filter ? data->filter->rejected.load(std::memory_order_relaxed) : 0;
+}
+
+extern "C" {
+
+int physics_set_collision_filter(physics_world_t* world, btRigidBody* body, int group, int mask) {
+    if (!world || !world->dynamics_world || !body) {
+        printf("Error: Invalid physics world\n");
+        return -1;
+    }
+
+    // Parked or removed bodies have no proxy to refilter
+    if (!body->getBroadphaseHandle()) {
+        return -1;
+    }
+
+    physics_arena_scope_t scope(world->data->arena);
+    btDiscreteDynamicsWorld* dynamics_world = static_cast<btDiscreteDynamicsWorld*>(world->dynamics_world);
+
+    // Re-adding drops the body's pairs, the broadphase finds the allowed ones again next tick.
+    // The registry slot is untouched
+    dynamics_world->removeRigidBody(body);
+
+    if (group == 0 && mask == 0) {
+        dynamics_world->addRigidBody(body);
+    } else {
+        dynamics_world->addRigidBody(body, group, mask);
+    }
+
+    return 0;
+}
+
+void physics_set_group_collision(physics_world_t* world, int group_a, int group_b, int collide) {
+    if (!world || !world->dynamics_world || !world->data || !world->data->filter) {
+        return;
+    }
+
+    collision_filter_t* filter = world->data->filter;
+
+    for (int i = 0; i < FILTER_GROUP_BITS; i++) {
+        for (int j = 0; j < FILTER_GROUP_BITS; j++) {
+            bool pair = ((group_a >> i) & 1 && (group_b >> j) & 1) || ((group_b >> i) & 1 && (group_a >> j) & 1);
+
+            if (!pair) {
+                continue;
+            }
+
+            if (collide) {
+                filter->disabled[i] &= ~(1u << j);
+            } else {
+                filter->disabled[i] |= 1u << j;
+            }
+        }
+    }
+
+    filter->any_disabled = false;
+
+    for (int i = 0; i < FILTER_GROUP_BITS; i++) {
+        filter->any_disabled = filter->any_disabled || filter->disabled[i] != 0;
+    }
+
+    // Pairs already found were allowed by the old rules
+    if (!collide) {
+        physics_arena_scope_t scope(world->data->arena);
+        filter_cleanup_t cleanup(filter);
+
+        static_cast<btBroadphaseInterface*>(world->broadphase)->getOverlappingPairCache()->processAllOverlappingPairs(
+            &cleanup, static_cast<btCollisionDispatcher*>(world->dispatcher)
+        );
+    }
+}
+
+} // extern "C"
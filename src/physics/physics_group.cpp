@@ -0,0 +1,179 @@
+#include "physics_internal.h"
+#include "core/jobs.h"
+#include <stdio.h>
+#include <new>
+#include <algorithm>
+
+// World groups: many small independent worlds, e.g. server rooms, stepped
+// concurrently on the job system. A world is one job, idle threads take the
+// next unstarted one from the shared queue. The queue is ordered by each
+// world's last step time, longest first, so a long world never starts last
+// and leaves the other threads waiting on it.
+// Worlds share no Bullet state, this holds without BT_THREADSAFE too
+
+struct group_member_t {
+    physics_world_t* world;
+    double last_ms;
+};
+
+struct physics_world_group_t {
+    std::vector<group_member_t> members; // In the order they were added
+    std::vector<unsigned int> order;     // Member indices, longest last step first
+
+    // Current step, read by the jobs
+    bool fixed = false;
+    unsigned int steps = 0;
+    float delta_time = 0.0f;
+
+    physics_world_group_stats_t stats = {};
+};
+
+static void group_job(void* user_data, unsigned int index, unsigned int thread_index) {
+    (void)thread_index;
+
+    physics_world_group_t* group = static_cast<physics_world_group_t*>(user_data);
+    group_member_t& member = group->members[group->order[index]];
+    double start = physics_now_ms();
+
+    if (group->fixed) {
+        physics_step_fixed(member.world, group->steps);
+    } else {
+        physics_step_simulation(member.world, group->delta_time);
+    }
+
+    member.last_ms = physics_now_ms() - start;
+}
+
+static void group_run(physics_world_group_t* group) {
+    unsigned int count = (unsigned int)group->members.size();
+
+    if (count == 0) {
+        return;
+    }
+
+    // Worlds never timed yet sort by their index, first added first
+    std::stable_sort(group->order.begin(), group->order.end(), [group](unsigned int a, unsigned int b) {
+        return group->members[a].last_ms > group->members[b].last_ms;
+    });
+
+    double start = physics_now_ms();
+    jobs_parallel_for(count, group_job, group);
+
+    physics_world_group_stats_t& stats = group->stats;
+    stats.world_count = count;
+    stats.thread_count = jobs_thread_count();
+    stats.step_ms = physics_now_ms() - start;
+    stats.busy_ms = 0.0;
+    stats.longest_ms = 0.0;
+
+    for (const group_member_t& member : group->members) {
+        stats.busy_ms += member.last_ms;
+        stats.longest_ms = std::max(stats.longest_ms, member.last_ms);
+    }
+}
+
+extern "C" {
+
+physics_world_group_t* physics_world_group_create(unsigned int thread_count) {
+    // Same job pool the multithreaded worlds use, their own parallel loops run inline inside a group step
+    if (jobs_thread_count() <= 1 && thread_count != 1) {
+        jobs_init(thread_count);
+    }
+
+    physics_world_group_t* group = new (std::nothrow) physics_world_group_t();
+
+    if (!group) {
+        fprintf(stderr, "Failed to allocate physics world group\n");
+        return nullptr;
+    }
+
+    printf("Physics world group created: %u threads\n", jobs_thread_count());
+
+    return group;
+}
+
+void physics_world_group_destroy(physics_world_group_t* group) {
+    delete group;
+}
+
+int physics_world_group_add(physics_world_group_t* group, physics_world_t* world) {
+    if (!group || !world || !world->dynamics_world) {
+        printf("Error: Invalid physics world\n");
+        return -1;
+    }
+
+    for (const group_member_t& member : group->members) {
+        if (member.world == world) {
+            return -1;
+        }
+    }
+
+    group->order.push_back((unsigned int)group->members.size());
+    group->members.push_back({world, 0.0});
+
+    return 0;
+}
+
+void physics_world_group_remove(physics_world_group_t* group, physics_world_t* world) {
+    if (!group) {
+        return;
+    }
+
+    for (size_t i = 0; i < group->members.size(); i++) {
+        if (group->members[i].world != world) {
+            continue;
+        }
+
+        group->members.erase(group->members.begin() + (ptrdiff_t)i);
+        group->order.erase(std::find(group->order.begin(), group->order.end(), (unsigned int)i));
+
+        // Later members moved down one index
+        for (unsigned int& index : group->order) {
+            if (index > i) {
+                index--;
+            }
+        }
+
+        return;
+    }
+}
+
+void physics_world_group_step(physics_world_group_t* group, float delta_time) {
+    if (!group) {
+        return;
+    }
+
+    group->fixed = false;
+    group->delta_time = delta_time;
+    group_run(group);
+}
+
+void physics_world_group_step_fixed(physics_world_group_t* group, unsigned int steps) {
+    if (!group || steps == 0) {
+        return;
+    }
+
+    group->fixed = true;
+    group->steps = steps;
+    group_run(group);
+}
+
+physics_world_group_stats_t physics_world_group_get_stats(const physics_world_group_t* group) {
+    return group ? group->stats : physics_world_group_stats_t{};
+}
+
+unsigned int physics_world_group_get_times(const physics_world_group_t* group, double* world_ms, unsigned int capacity) {
+    if (!group || !world_ms) {
+        return 0;
+    }
+
+    unsigned int count = std::min(capacity, (unsigned int)group->members.size());
+
+    for (unsigned int i = 0; i < count; i++) {
+        world_ms[i] = group->members[i].last_ms;
+    }
+
+    return count;
+}
+
+} // extern "C"
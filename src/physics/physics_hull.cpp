@@ -0,0 +1,464 @@
+#include "physics_internal.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <LinearMath/btConvexHull.h>
+
+// Convex hull collision generated from render meshes
+// A hull is built by Bullet's hull library straight from the mesh points and
+// capped to the vertex budget while it grows. Decomposition splits the triangles of the
+// most concave piece in two along its longest axis until every piece is
+// close to its hull or the piece budget is used up. Concavity is the deepest
+// a piece's triangle centroid sits inside its own hull.
+// Results are cached on disk under the content hash, generation runs once
+
+#define HULL_CACHE_MAGIC 0x4C55484Du // "MHUL"
+#define HULL_CACHE_VERSION 2
+
+#define HULL_DEFAULT_MAX_VERTICES 32
+#define HULL_MAX_PIECES 64
+#define HULL_DEFAULT_CONCAVITY 0.02f // Share of the mesh bounds diagonal
+
+struct hull_cache_header_t {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t hash;        // Over the mesh and the params
+    uint32_t piece_count; // Followed by one point count per piece, then xyz floats
+    uint32_t point_count;
+};
+
+struct hull_piece_t {
+    std::vector<unsigned int> triangles; // Source triangle indices
+    std::vector<btVector3> points;       // Simplified hull
+    btScalar concavity;
+};
+
+static void hull_simplify(const std::vector<btVector3>& source, unsigned int max_vertices, std::vector<btVector3>& points,
+                          std::vector<unsigned int>* triangles) {
+    // Raw points straight in, the library stops adding vertices at the cap
+    HullDesc desc(QF_TRIANGLES, (unsigned int)source.size(), source.data());
+    desc.mMaxVertices = max_vertices;
+
+    HullLibrary library;
+    HullResult result;
+
+    points.clear();
+
+    if (triangles) {
+        triangles->clear();
+    }
+
+    // Degenerate input, e.g. a flat piece: no points, the piece is dropped
+    if (library.CreateConvexHull(desc, result) != QE_OK) {
+        return;
+    }
+
+    for (unsigned int i = 0; i < result.mNumOutputVertices; i++) {
+        points.push_back(result.m_OutputVertices[(int)i]);
+    }
+
+    if (triangles) {
+        for (unsigned int i = 0; i < result.mNumIndices; i++) {
+            triangles->push_back(result.m_Indices[(int)i]);
+        }
+    }
+
+    library.ReleaseResult(result);
+}
+
+static btVector3 triangle_centroid(const float* positions, const unsigned int* indices, unsigned int triangle) {
+    btVector3 sum(0, 0, 0);
+
+    for (int corner = 0; corner < 3; corner++) {
+        const float* p = positions + (size_t)indices[triangle * 3 + corner] * 3;
+        sum += btVector3(p[0], p[1], p[2]);
+    }
+
+    return sum / btScalar(3);
+}
+
+// Builds a piece's hull and measures how far its surface sinks below it
+static void piece_build(hull_piece_t& piece, const float* positions, const unsigned int* indices, unsigned int max_vertices) {
+    std::vector<btVector3> source;
+    std::vector<unsigned int> hull_triangles;
+
+    source.reserve(piece.triangles.size() * 3);
+
+    for (unsigned int triangle : piece.triangles) {
+        for (int corner = 0; corner < 3; corner++) {
+            const float* p = positions + (size_t)indices[triangle * 3 + corner] * 3;
+            source.push_back(btVector3(p[0], p[1], p[2]));
+        }
+    }
+
+    hull_simplify(source, max_vertices, piece.points, &hull_triangles);
+    piece.concavity = 0.0f;
+
+    if (hull_triangles.empty()) {
+        return;
+    }
+
+    btVector3 center(0, 0, 0);
+
+    for (const btVector3& point : piece.points) {
+        center += point;
+    }
+
+    center /= (btScalar)piece.points.size();
+
+    // Outward face planes of the hull
+    std::vector<btVector4> planes;
+
+    for (size_t i = 0; i + 2 < hull_triangles.size(); i += 3) {
+        const btVector3& a = piece.points[hull_triangles[i]];
+        btVector3 normal = (piece.points[hull_triangles[i + 1]] - a).cross(piece.points[hull_triangles[i + 2]] - a);
+
+        if (normal.length2() < SIMD_EPSILON) {
+            continue;
+        }
+
+        normal.normalize();
+
+        if (normal.dot(center - a) > 0) {
+            normal = -normal;
+        }
+
+        planes.push_back(btVector4(normal.x(), normal.y(), normal.z(), normal.dot(a)));
+    }
+
+    // Depth of a point inside the hull: distance to the nearest face
+    for (unsigned int triangle : piece.triangles) {
+        btVector3 centroid = triangle_centroid(positions, indices, triangle);
+        btScalar depth = BT_LARGE_FLOAT;
+
+        for (const btVector4& plane : planes) {
+            depth = btMin(depth, plane.w() - btVector3(plane.x(), plane.y(), plane.z()).dot(centroid));
+        }
+
+        piece.concavity = btMax(piece.concavity, depth);
+    }
+}
+
+// Splits at the centroid mean along the longest axis, false if everything falls on one side
+static bool piece_split(hull_piece_t& piece, hull_piece_t& other, const float* positions, const unsigned int* indices) {
+    btVector3 min(BT_LARGE_FLOAT, BT_LARGE_FLOAT, BT_LARGE_FLOAT);
+    btVector3 max(-BT_LARGE_FLOAT, -BT_LARGE_FLOAT, -BT_LARGE_FLOAT);
+    btVector3 mean(0, 0, 0);
+
+    for (unsigned int triangle : piece.triangles) {
+        btVector3 centroid = triangle_centroid(positions, indices, triangle);
+
+        min.setMin(centroid);
+        max.setMax(centroid);
+        mean += centroid;
+    }
+
+    mean /= (btScalar)piece.triangles.size();
+
+    btVector3 extent = max - min;
+    int axis = extent.x() > extent.y() ? (extent.x() > extent.z() ? 0 : 2) : (extent.y() > extent.z() ? 1 : 2);
+    std::vector<unsigned int> below;
+    std::vector<unsigned int> above;
+
+    for (unsigned int triangle : piece.triangles) {
+        (triangle_centroid(positions, indices, triangle)[axis] < mean[axis] ? below : above).push_back(triangle);
+    }
+
+    if (below.empty() || above.empty()) {
+        return false;
+    }
+
+    piece.triangles.swap(below);
+    other.triangles.swap(above);
+
+    return true;
+}
+
+static void hull_decompose(const float* positions, unsigned int vertex_count, const unsigned int* indices, unsigned int index_count,
+                           unsigned int max_vertices, unsigned int max_pieces, float concavity, std::vector<hull_piece_t>& pieces) {
+    pieces.assign(1, hull_piece_t());
+
+    for (unsigned int i = 0; i < index_count / 3; i++) {
+        pieces[0].triangles.push_back(i);
+    }
+
+    if (concavity <= 0.0f) {
+        btVector3 min(BT_LARGE_FLOAT, BT_LARGE_FLOAT, BT_LARGE_FLOAT);
+        btVector3 max(-BT_LARGE_FLOAT, -BT_LARGE_FLOAT, -BT_LARGE_FLOAT);
+
+        for (unsigned int i = 0; i < vertex_count; i++) {
+            btVector3 p(positions[i * 3], positions[i * 3 + 1], positions[i * 3 + 2]);
+            min.setMin(p);
+            max.setMax(p);
+        }
+
+        concavity = HULL_DEFAULT_CONCAVITY * (max - min).length();
+    }
+
+    piece_build(pieces[0], positions, indices, max_vertices);
+
+    while (pieces.size() < max_pieces) {
+        size_t worst = 0;
+
+        for (size_t i = 1; i < pieces.size(); i++) {
+            if (pieces[i].concavity > pieces[worst].concavity) {
+                worst = i;
+            }
+        }
+
+        if (pieces[worst].concavity <= concavity) {
+            break;
+        }
+
+        hull_piece_t other;
+
+        if (!piece_split(pieces[worst], other, positions, indices)) {
+            pieces[worst].concavity = 0.0f; // Can't be split further, leave it as it is
+            continue;
+        }
+
+        piece_build(pieces[worst], positions, indices, max_vertices);
+        piece_build(other, positions, indices, max_vertices);
+        pieces.push_back(std::move(other));
+    }
+}
+
+static bool cache_load(const char* path, uint64_t hash, std::vector<hull_piece_t>& pieces) {
+    FILE* file = fopen(path, "rb");
+
+    if (!file) {
+        return false;
+    }
+
+    hull_cache_header_t header;
+    std::vector<uint32_t> counts;
+    std::vector<float> floats;
+    bool valid = fread(&header, sizeof(header), 1, file) == 1 && header.magic == HULL_CACHE_MAGIC &&
+                 header.version == HULL_CACHE_VERSION && header.hash == hash && header.piece_count > 0 &&
+                 header.piece_count <= HULL_MAX_PIECES;
+
+    if (valid) {
+        counts.resize(header.piece_count);
+        floats.resize((size_t)header.point_count * 3);
+        valid = fread(counts.data(), sizeof(uint32_t), counts.size(), file) == counts.size() &&
+                fread(floats.data(), sizeof(float), floats.size(), file) == floats.size();
+    }
+
+    fclose(file);
+
+    size_t total = 0;
+
+    for (size_t i = 0; valid && i < counts.size(); i++) {
+        valid = counts[i] > 0;
+        total += counts[i];
+    }
+
+    if (!valid || total != header.point_count) {
+        return false;
+    }
+
+    pieces.assign(header.piece_count, hull_piece_t());
+
+    const float* p = floats.data();
+
+    for (size_t i = 0; i < counts.size(); i++) {
+        for (uint32_t j = 0; j < counts[i]; j++, p += 3) {
+            pieces[i].points.push_back(btVector3(p[0], p[1], p[2]));
+        }
+    }
+
+    return true;
+}
+
+static void cache_store(const char* path, uint64_t hash, const std::vector<hull_piece_t>& pieces) {
+    hull_cache_header_t header = {};
+    std::vector<uint32_t> counts;
+    std::vector<float> floats;
+
+    header.magic = HULL_CACHE_MAGIC;
+    header.version = HULL_CACHE_VERSION;
+    header.hash = hash;
+    header.piece_count = (uint32_t)pieces.size();
+
+    for (const hull_piece_t& piece : pieces) {
+        counts.push_back((uint32_t)piece.points.size());
+
+        for (const btVector3& point : piece.points) {
+            floats.push_back((float)point.x());
+            floats.push_back((float)point.y());
+            floats.push_back((float)point.z());
+        }
+    }
+
+    header.point_count = (uint32_t)(floats.size() / 3);
+
+    physics_cache_block_t blocks[] = {
+        {&header, sizeof(header)},
+        {counts.data(), sizeof(uint32_t) * counts.size()},
+        {floats.data(), sizeof(float) * floats.size()},
+    };
+
+    if (physics_cache_write_atomic(path, blocks, 3) != 0) {
+        return;
+    }
+
+    printf("Wrote hull cache %s (%u pieces | %u points)\n", path, header.piece_count, header.point_count);
+}
+
+static void hull_generate(const float* positions, unsigned int vertex_count, const unsigned int* indices, unsigned int index_count,
+                          unsigned int max_vertices, unsigned int max_pieces, float concavity, std::vector<hull_piece_t>& pieces) {
+    if (max_pieces > 1) {
+        hull_decompose(positions, vertex_count, indices, index_count, max_vertices, max_pieces, concavity, pieces);
+        return;
+    }
+
+    std::vector<btVector3> source;
+    source.reserve(vertex_count);
+
+    for (unsigned int i = 0; i < vertex_count; i++) {
+        source.push_back(btVector3(positions[i * 3], positions[i * 3 + 1], positions[i * 3 + 2]));
+    }
+
+    pieces.assign(1, hull_piece_t());
+    hull_simplify(source, max_vertices, pieces[0].points, nullptr);
+}
+
+// Hull around the points' center, which is returned in mesh space
+static btConvexHullShape* hull_shape_build(const std::vector<btVector3>& points, btVector3& center) {
+    btConvexHullShape* hull = new btConvexHullShape();
+
+    center.setValue(0, 0, 0);
+
+    for (const btVector3& point : points) {
+        center += point;
+    }
+
+    center /= (btScalar)points.size();
+
+    for (const btVector3& point : points) {
+        hull->addPoint(point - center, false);
+    }
+
+    hull->recalcLocalAabb();
+
+    return hull;
+}
+
+btCollisionShape* physics_hull_shape_create(const float* positions, unsigned int vertex_count, const unsigned int* indices,
+                                            unsigned int index_count, const physics_hull_params_t* params, const char* cache_dir,
+                                            btTransform& principal, btVector3& unit_inertia) {
+    unsigned int max_vertices = params && params->max_vertices >= 4 ? params->max_vertices : HULL_DEFAULT_MAX_VERTICES;
+    unsigned int max_pieces = params && params->max_pieces > 1 ? btMin(params->max_pieces, (unsigned int)HULL_MAX_PIECES) : 1;
+    float concavity = params ? params->concavity : 0.0f;
+
+    // Decomposition works on triangles, a single hull only needs the points
+    if (!indices || index_count < 3) {
+        max_pieces = 1;
+        index_count = 0;
+    }
+
+    std::vector<hull_piece_t> pieces;
+    char path[1024] = "";
+    uint64_t hash = 0;
+
+    if (cache_dir) {
+        // Different params give a different hull
+        hash = physics_mesh_hash(positions, vertex_count, indices, index_count);
+        hash = (hash ^ max_vertices) * 1099511628211ull;
+        hash = (hash ^ max_pieces) * 1099511628211ull;
+        hash = (hash ^ (uint64_t)(uint32_t)(concavity * SHAPE_QUANTIZE)) * 1099511628211ull;
+
+        if (snprintf(path, sizeof(path), "%s/%016llx.hull", cache_dir, (unsigned long long)hash) >= (int)sizeof(path)) {
+            fprintf(stderr, "Hull cache path too long: %s\n", cache_dir);
+            path[0] = '\0';
+        } else if (cache_load(path, hash, pieces)) {
+            printf("Loaded hull cache %s\n", path);
+        } else {
+            pieces.clear();
+        }
+    }
+
+    if (pieces.empty()) {
+        hull_generate(positions, vertex_count, indices, index_count, max_vertices, max_pieces, concavity, pieces);
+
+        if (path[0] != '\0') {
+            cache_store(path, hash, pieces);
+        }
+    }
+
+    // Pieces too flat for a hull are dropped, a box or a plane needs another shape
+    for (size_t i = pieces.size(); i-- > 0;) {
+        if (pieces[i].points.size() < 4) {
+            pieces.erase(pieces.begin() + (ptrdiff_t)i);
+        }
+    }
+
+    if (pieces.empty()) {
+        fprintf(stderr, "Mesh too flat for a convex hull\n");
+        return nullptr;
+    }
+
+    // Each hull is centered on its own points and placed at that offset, so
+    // the body's center of mass and inertia come from the hull, not the mesh origin
+    if (pieces.size() == 1) {
+        btVector3 center;
+        btConvexHullShape* hull = hull_shape_build(pieces[0].points, center);
+
+        principal.setIdentity();
+        principal.setOrigin(center);
+        hull->calculateLocalInertia(1.0f, unit_inertia);
+
+        return hull;
+    }
+
+    btCompoundShape* compound = new btCompoundShape(true, (int)pieces.size());
+    std::vector<btScalar> masses;
+    btScalar total = 0.0f;
+
+    for (const hull_piece_t& piece : pieces) {
+        btVector3 center;
+        btConvexHullShape* hull = hull_shape_build(piece.points, center);
+        btTransform child;
+        btVector3 min;
+        btVector3 max;
+
+        child.setIdentity();
+        child.setOrigin(center);
+        compound->addChildShape(child, hull);
+
+        // Mass shared out by bounds volume, close enough for convex pieces
+        hull->getAabb(btTransform::getIdentity(), min, max);
+        btVector3 extent = max - min;
+        masses.push_back(btMax(extent.x() * extent.y() * extent.z(), SIMD_EPSILON));
+        total += masses.back();
+    }
+
+    for (btScalar& mass : masses) {
+        mass /= total;
+    }
+
+    compound->calculatePrincipalAxisTransform(masses.data(), principal, unit_inertia);
+
+    // Children move into the principal frame, the body is shifted by the caller to match
+    btTransform to_principal = principal.inverse();
+
+    for (int i = 0; i < compound->getNumChildShapes(); i++) {
+        compound->updateChildTransform(i, to_principal * compound->getChildTransform(i), false);
+    }
+
+    compound->recalculateLocalAabb();
+
+    return compound;
+}
+
+void physics_hull_shape_free(btCollisionShape* shape) {
+    if (shape->getShapeType() == COMPOUND_SHAPE_PROXYTYPE) {
+        btCompoundShape* compound = static_cast<btCompoundShape*>(shape);
+
+        for (int i = compound->getNumChildShapes() - 1; i >= 0; i--) {
+            delete compound->getChildShape(i);
+        }
+    }
+
+    delete shape;
+}
@@ -0,0 +1,525 @@
+#ifndef PHYSICS_INTERNAL_H
+#define PHYSICS_INTERNAL_H
+
+// Shared state of the Bullet wrapper translation units, C++ only
+
+#include "physics.h"
+#include <btBulletDynamicsCommon.h>
+#include <LinearMath/btThreads.h>
+#include <stdint.h>
+#include <time.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE__) && !defined(BT_USE_DOUBLE_PRECISION)
+#include <xmmintrin.h>
+#define PHYSICS_SSE_EXPORT 1
+#endif
+
+class btITaskScheduler;
+struct physics_arena_t;
+struct collision_filter_t;
+class btMLCPSolverInterface;
+
+// Default fixed timestep
+#define PHYSICS_TICK_RATE 60.0f
+#define PHYSICS_MAX_STEPS 5
+
+// Default sector edge for streaming
+#define PHYSICS_SECTOR_SIZE 64.0f
+
+// Shape dimensions are compared at 0.1 mm so float noise doesn't split the cache
+#define SHAPE_QUANTIZE 10000.0f
+
+// Shape user index of compounds made by static baking, their children are cached boxes
+#define SHAPE_BAKED_COMPOUND 1
+
+struct shape_key_t {
+    int type;
+    int dims[3];
+
+    bool operator==(const shape_key_t& other) const {
+        return type == other.type && dims[0] == other.dims[0] && dims[1] == other.dims[1] && dims[2] == other.dims[2];
+    }
+};
+
+struct shape_key_hash_t {
+    size_t operator()(const shape_key_t& key) const {
+        size_t hash = (size_t)key.type;
+
+        for (int i = 0; i < 3; i++) {
+            hash = hash * 31 + (size_t)(unsigned int)key.dims[i];
+        }
+
+        return hash;
+    }
+};
+
+struct shape_entry_t {
+    btCollisionShape* shape;
+    unsigned int refs;
+    size_t bytes;
+    shape_key_t key;
+};
+
+// Touching object pair, a < b so pairs sort and merge by address
+struct contact_pair_t {
+    const btCollisionObject* a;
+    const btCollisionObject* b;
+    btRigidBody* body_a;
+    btRigidBody* body_b;
+    btGhostObject* trigger;
+    btVector3 point;
+    btVector3 normal;
+    float depth;
+    float impulse;
+
+    bool operator<(const contact_pair_t& other) const {
+        return a < other.a || (a == other.a && b < other.b);
+    }
+};
+
+// Body out of the world while its sector is unloaded, with the filter it had
+struct parked_body_t {
+    btRigidBody* body;
+    int group;
+    int mask;
+};
+
+// Per slot LOD state, list_index points into the reduced or drifting list
+struct body_lod_t {
+    uint8_t tier = PHYSICS_LOD_FULL;
+    uint8_t hidden = 0;
+    uint8_t listed = 0;
+    uint8_t pad = 0;
+    uint32_t list_index = 0;
+    float drift = 0.0f; // Extrapolation seconds left while frozen
+};
+
+// Bodies from physics_add_boxes(), freed when the last one is removed
+struct body_block_t {
+    unsigned char* motion_states;
+    unsigned char* bodies;
+    unsigned int count;
+    unsigned int live;
+};
+
+struct physics_world_data_t {
+    // Node based: entry pointers stay valid and are kept in the shape user pointer
+    std::unordered_map<shape_key_t, shape_entry_t, shape_key_hash_t> shapes;
+    unsigned int shape_references = 0;
+    size_t shape_bytes = 0;
+
+    std::vector<body_block_t> blocks;
+
+    // Dense body registry, a body's slot is kept in its user index
+    std::vector<btRigidBody*> bodies;
+    std::vector<unsigned char> exported; // Slot written by the last export
+    std::vector<btTransform> previous;   // Transform one tick before the current one
+    std::vector<body_lod_t> lod;         // LOD tier of each slot
+    unsigned int layout_version = 0;     // Bumped when slots change, snapshots check it
+
+    // Fixed timestep accumulator, tick 0 falls back to Bullet's internal substepping
+    float tick = 1.0f / PHYSICS_TICK_RATE;
+    unsigned int max_steps = PHYSICS_MAX_STEPS;
+    float accumulator = 0.0f;
+    float alpha = 1.0f;
+
+    // Multithreaded world only, world->solver is unused then
+    btConstraintSolver* solver_pool = nullptr; // btConstraintSolverPoolMt
+    btConstraintSolver* solver_mt = nullptr;
+
+    // Solver backend, MLCP solvers don't own their LCP solvers
+    physics_solver_type_t solver_type = PHYSICS_SOLVER_SI;
+    std::vector<btMLCPSolverInterface*> mlcp_interfaces;
+
+    // Contact events, off while the ring is empty
+    std::vector<contact_pair_t> pairs;      // Touching after the last tick, sorted
+    std::vector<contact_pair_t> pairs_next; // Scratch, swapped with pairs every tick
+    std::vector<physics_contact_event_t> events;
+    unsigned int event_head = 0;
+    unsigned int event_count = 0;
+    unsigned int events_dropped = 0;
+
+    // Physics LOD, off until physics_lod_enable()
+    bool lod_enabled = false;
+    physics_lod_config_t lod_config = {};
+    btVector3 lod_focus = btVector3(0, 0, 0);
+    std::vector<btRigidBody*> lod_reduced;  // Bodies in the reduced tier
+    std::vector<btRigidBody*> lod_drifting; // Frozen bodies still being extrapolated
+    unsigned int lod_frozen = 0;
+    unsigned int lod_cursor = 0;            // Next slot to re-tier
+    unsigned long long lod_tick = 0;
+
+    // Unloaded sectors by packed XZ coordinates, empty ones included
+    std::unordered_map<uint64_t, std::vector<parked_body_t>> parked;
+    unsigned int parked_count = 0;
+    float sector_size = PHYSICS_SECTOR_SIZE;
+
+    // Snapshot restore scratch: manifolds keyed by their body slots
+    std::vector<std::pair<uint64_t, btPersistentManifold*>> manifold_lookup;
+
+    // Broadphase pair filter with group pair rules and counters
+    collision_filter_t* filter = nullptr;
+
+    // Per-phase timing, off until physics_profile_enable()
+    bool profile_enabled = false;
+    physics_profile_t profile = {};         // Last step call
+    physics_profile_t profile_current = {}; // Filled by the profile hooks during a step call
+    uint64_t profile_start = 0;
+    std::vector<int> profile_islands;       // Island tag scratch
+
+    // Every Bullet allocation made for this world, NULL on the heap allocator
+    physics_arena_t* arena = nullptr;
+};
+
+// Arena receiving Bullet allocations on this thread
+extern thread_local physics_arena_t* physics_current_arena;
+
+// Routes Bullet allocations to an arena until the end of the scope
+struct physics_arena_scope_t {
+    physics_arena_t* previous;
+
+    explicit physics_arena_scope_t(physics_arena_t* arena) : previous(physics_current_arena) {
+        physics_current_arena = arena;
+    }
+
+    ~physics_arena_scope_t() {
+        physics_current_arena = previous;
+    }
+
+    physics_arena_scope_t(const physics_arena_scope_t&) = delete;
+    physics_arena_scope_t& operator=(const physics_arena_scope_t&) = delete;
+};
+
+inline const btTransform& body_current_transform(const btRigidBody* body) {
+    // All wrapper bodies use the default motion state, skip the virtual copy
+    return static_cast<const btDefaultMotionState*>(body->getMotionState())->m_graphicsWorldTrans;
+}
+
+// Monotonic clock for step timings and stats
+inline uint64_t physics_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+inline double physics_now_ms(void) {
+    return (double)physics_now_ns() / 1e6;
+}
+
+// Column-major OpenGL matrix from a rigid transform
+inline void transform_to_matrix(const btTransform& transform, float* out) {
+#ifdef PHYSICS_SSE_EXPORT
+    const btMatrix3x3& basis = transform.getBasis();
+
+    __m128 r0 = _mm_loadu_ps(basis[0].m_floats);
+    __m128 r1 = _mm_loadu_ps(basis[1].m_floats);
+    __m128 r2 = _mm_loadu_ps(basis[2].m_floats);
+    __m128 r3 = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+
+    // Basis rows become matrix columns, row w lanes land in column 3
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+    const btVector3& origin = transform.getOrigin();
+
+    _mm_storeu_ps(out, r0);
+    _mm_storeu_ps(out + 4, r1);
+    _mm_storeu_ps(out + 8, r2);
+    _mm_storeu_ps(out + 12, _mm_set_ps(1.0f, origin.getZ(), origin.getY(), origin.getX()));
+#else
+    transform.getOpenGLMatrix(out);
+#endif
+}
+
+/**
+    * Give a body the next registry slot
+    * @param data World data
+    * @param body Body just added to the dynamics world
+**/
+
+void body_register(physics_world_data_t* data, btRigidBody* body);
+
+/**
+    * Take a body out of the registry, the last body moves into its slot
+    * @param data World data
+    * @param body Registered body, no-op otherwise
+**/
+
+void body_unregister(physics_world_data_t* data, btRigidBody* body);
+
+/**
+    * Re-tier a share of the bodies, run before every step
+    * @param world Physics world, no-op with LOD off
+**/
+
+void physics_lod_update(physics_world_t* world);
+
+/**
+    * Put reduced tier bodies due this tick on a longer step, freeze the others
+    * @param world Physics world, no-op with LOD off
+**/
+
+void physics_lod_pre_tick(physics_world_t* world);
+
+/**
+    * Undo the longer step and extrapolate drifting frozen bodies
+    * @param world Physics world, no-op with LOD off
+    * @param dt Seconds the tick covered
+**/
+
+void physics_lod_post_tick(physics_world_t* world, float dt);
+
+/**
+    * Put a body back to full simulation before it leaves the registry
+    * @param data World data
+    * @param body Registered body
+**/
+
+void physics_lod_forget(physics_world_data_t* data, btRigidBody* body);
+
+/**
+    * Create the configured broadphase behind the timing wrapper
+    * @param config World config or NULL for a dynamic AABB tree
+    * @return Broadphase owning the wrapped one
+**/
+
+btBroadphaseInterface* physics_broadphase_create(const physics_world_config_t* config);
+
+/**
+    * Rebalance the broadphase after many inserts, no-op for sweep and prune
+    * @param broadphase Broadphase from physics_broadphase_create()
+**/
+
+void physics_broadphase_optimize(btBroadphaseInterface* broadphase);
+
+/**
+    * Mark the span of a simulation step, broadphase work is timed inside it only
+    * @param broadphase Broadphase from physics_broadphase_create()
+    * @param stepping True before stepping, false after
+**/
+
+void physics_broadphase_set_stepping(btBroadphaseInterface* broadphase, bool stepping);
+
+/**
+    * Create a constraint solver of the given backend
+    * @param data World data, keeps what the solver doesn't own
+    * @param type Solver backend
+    * @return Solver, every backend derives from sequential impulse
+**/
+
+btSequentialImpulseConstraintSolver* physics_solver_create(physics_world_data_t* data, physics_solver_type_t type);
+
+/**
+    * Apply a backend's solver info defaults once the world exists
+    * @param world Physics world
+    * @param type Solver backend the world was created with
+**/
+
+void physics_solver_setup(physics_world_t* world, physics_solver_type_t type);
+
+/**
+    * Free what the solvers don't own, after the solvers themselves
+    * @param data World data
+**/
+
+void physics_solver_destroy(physics_world_data_t* data);
+
+/**
+    * Install the world's broadphase pair filter
+    * @param world Physics world with its broadphase created
+**/
+
+void physics_filter_install(physics_world_t* world);
+
+/**
+    * Free the pair filter once the broadphase is gone
+    * @param data World data
+**/
+
+void physics_filter_destroy(physics_world_data_t* data);
+
+/**
+    * Test two group/mask pairs against the masks and group pair rules, without counting
+    * @param filter World pair filter
+    * @return True when the pair may collide
+**/
+
+bool physics_filter_collides(const collision_filter_t* filter, int group0, int mask0, int group1, int mask1);
+
+/**
+    * Get the pair filter call counters
+    * @param data World data
+    * @param accepted Output filter calls that passed the pair on
+    * @param rejected Output filter calls that rejected the pair
+**/
+
+void physics_filter_get_stats(const physics_world_data_t* data, unsigned long long* accepted, unsigned long long* rejected);
+
+/**
+    * Start attributing Bullet's profile zones on this thread to the world
+    * @param world Physics world, no-op with profiling off
+**/
+
+void physics_profile_begin(physics_world_t* world);
+
+/**
+    * Stop attributing profile zones and count pairs, contacts and islands
+    * @param world Physics world, no-op with profiling off
+    * @param ticks Ticks run since physics_profile_begin()
+**/
+
+void physics_profile_end(physics_world_t* world, unsigned int ticks);
+
+/**
+    * Park active bodies that moved into an unloaded sector
+    * @param world Physics world, no-op while every sector is loaded
+**/
+
+void physics_sectors_update(physics_world_t* world);
+
+/**
+    * Drop a parked body from its sector before it is freed
+    * @param data World data
+    * @param body Body to look up
+    * @return True if the body was parked
+**/
+
+bool physics_sectors_forget(physics_world_data_t* data, btRigidBody* body);
+
+/**
+    * Get the task scheduler backed by the engine job system
+    * Starts the job system when it isn't running yet
+    * @param thread_count Threads to start with: 0 for one per CPU core
+    * @return Scheduler, created once and shared by all worlds
+**/
+
+btITaskScheduler* physics_task_scheduler(unsigned int thread_count);
+
+/**
+    * Diff the dispatcher's manifolds against the last tick and queue events
+    * @param world Physics world, no-op with contact events off
+    * @param emit_persist Queue PERSIST events for pairs still touching
+**/
+
+void physics_contacts_update(physics_world_t* world, bool emit_persist);
+
+/**
+    * Rebuild the touching pairs from the current manifolds without queueing events
+    * Used after a snapshot restore so the next tick doesn't diff against the rolled back state
+    * @param world Physics world, no-op with contact events off
+**/
+
+void physics_contacts_reset(physics_world_t* world);
+
+/**
+    * End every pair of an object that is about to be freed
+    * @param data World data
+    * @param object Body or trigger leaving the world
+**/
+
+void physics_contacts_forget(physics_world_data_t* data, const btCollisionObject* object);
+
+/**
+    * Create a static triangle mesh shape, the BVH comes from the cache when valid
+    * @param positions xyz per vertex, copied
+    * @param vertex_count Vertex count
+    * @param indices Triangle indices, copied
+    * @param index_count Index count: multiple of 3
+    * @param cache_path BVH cache file, written after a build: NULL to always build
+    * @return btBvhTriangleMeshShape or NULL on failure
+**/
+
+btCollisionShape* physics_mesh_shape_create(const float* positions, unsigned int vertex_count,
+                                            const unsigned int* indices, unsigned int index_count, const char* cache_path);
+
+/**
+    * Hash a mesh's positions and indices, FNV-1a over 32-bit words
+    * @param positions xyz per vertex
+    * @param vertex_count Vertex count
+    * @param indices Triangle indices or NULL
+    * @param index_count Index count
+    * @return Content hash
+**/
+
+uint64_t physics_mesh_hash(const float* positions, unsigned int vertex_count, const unsigned int* indices, unsigned int index_count);
+
+struct physics_cache_block_t {
+    const void* data;
+    size_t size;
+};
+
+/**
+    * Write a cache file through a temporary file and a rename
+    * @param path Cache file path
+    * @param blocks Data written back to back
+    * @param count Number of blocks
+    * @return 0 on success, -1 on failure
+**/
+
+int physics_cache_write_atomic(const char* path, const physics_cache_block_t* blocks, unsigned int count);
+
+/**
+    * Free a mesh shape with its mesh copy and mapped BVH
+    * @param shape Shape from physics_mesh_shape_create()
+**/
+
+void physics_mesh_shape_free(btCollisionShape* shape);
+
+/**
+    * Create a convex hull shape, or a compound of hulls when decomposing
+    * @param positions xyz per vertex
+    * @param vertex_count Vertex count
+    * @param indices Triangle indices, needed to decompose: NULL for a single hull
+    * @param index_count Index count
+    * @param params Vertex cap and decomposition, NULL for one 32 vertex hull
+    * @param cache_dir Directory for hull caches named by content hash: NULL to always generate
+    * @param principal Output: center of mass frame in mesh space, the shape is built around it
+    * @param unit_inertia Output: principal inertia for a mass of 1
+    * @return btConvexHullShape, btCompoundShape of them or NULL for a flat mesh
+**/
+
+btCollisionShape* physics_hull_shape_create(const float* positions, unsigned int vertex_count, const unsigned int* indices,
+                                            unsigned int index_count, const physics_hull_params_t* params, const char* cache_dir,
+                                            btTransform& principal, btVector3& unit_inertia);
+
+/**
+    * Free a hull shape, compound children included
+    * @param shape Shape from physics_hull_shape_create()
+**/
+
+void physics_hull_shape_free(btCollisionShape* shape);
+
+/**
+    * Route btAlignedAlloc() and btAlignedFree() through the wrapper allocator
+    * Idempotent, called before the first Bullet object is created
+**/
+
+void physics_alloc_install(void);
+
+/**
+    * Create an arena of size-class pools
+    * @param thread_safe Lock on every allocation: needed by multithreaded worlds
+    * @return Arena or NULL on failure
+**/
+
+physics_arena_t* physics_arena_create(int thread_safe);
+
+/**
+    * Release all arena memory at once, live blocks included
+    * @param arena Arena to destroy
+**/
+
+void physics_arena_destroy(physics_arena_t* arena);
+
+/**
+    * Get arena allocation stats
+    * @param arena Arena or NULL for allocations outside any arena
+    * @param stats Output stats
+**/
+
+void physics_arena_get_stats(physics_arena_t* arena, physics_alloc_stats_t* stats);
+
+#endif // PHYSICS_INTERNAL_H
@@ -0,0 +1,326 @@
+#include "physics_internal.h"
+#include <stdio.h>
+
+// Distance based physics LOD
+// Bullet steps every body of a world with the same timestep, so tiers are
+// built from activation states:
+// - Reduced bodies are frozen on most ticks. On their turn they step once
+//   with velocities and gravity scaled by the interval, which integrates
+//   interval ticks worth of motion in one tick
+// - Frozen bodies keep DISABLE_SIMULATION: no integration, no AABB update,
+//   no island. Moving ones drift along their velocity for a while so they
+//   don't stop dead on screen
+// With LOD on only active bodies get their AABBs updated, which is what makes
+// the frozen part of the world close to free
+
+#define LOD_DEFAULT_INTERVAL 4
+#define LOD_DEFAULT_HIDDEN_SCALE 0.5f
+#define LOD_DEFAULT_CLASSIFY_SPREAD 8 // Steps to re-tier every body once
+
+// Moving slower than this when frozen: nothing worth extrapolating
+#define LOD_DRIFT_MIN_SPEED 0.05f
+
+static inline body_lod_t& body_lod(physics_world_data_t* data, const btRigidBody* body) {
+    return data->lod[body->getUserIndex()];
+}
+
+static void list_add(physics_world_data_t* data, std::vector<btRigidBody*>& list, btRigidBody* body) {
+    body_lod_t& lod = body_lod(data, body);
+
+    lod.listed = 1;
+    lod.list_index = (uint32_t)list.size();
+    list.push_back(body);
+}
+
+static void list_remove(physics_world_data_t* data, std::vector<btRigidBody*>& list, btRigidBody* body) {
+    body_lod_t& lod = body_lod(data, body);
+
+    if (!lod.listed) {
+        return;
+    }
+
+    btRigidBody* last = list.back();
+    list[lod.list_index] = last;
+    body_lod(data, last).list_index = lod.list_index;
+    list.pop_back();
+
+    lod.listed = 0;
+}
+
+// Reduced bodies take turns spread over the interval, keyed by address so the turn survives slot moves
+static inline bool reduced_due(const physics_world_data_t* data, const btRigidBody* body) {
+    return ((uintptr_t)body / sizeof(btRigidBody) + data->lod_tick) % data->lod_config.reduced_interval == 0;
+}
+
+static void set_tier(physics_world_data_t* data, btRigidBody* body, physics_lod_tier_t tier) {
+    body_lod_t& lod = body_lod(data, body);
+
+    if (lod.tier != tier) {
+        if (lod.tier == PHYSICS_LOD_REDUCED) {
+            list_remove(data, data->lod_reduced, body);
+        } else if (lod.tier == PHYSICS_LOD_FROZEN) {
+            list_remove(data, data->lod_drifting, body);
+            data->lod_frozen--;
+        }
+
+        lod.tier = (uint8_t)tier;
+
+        if (tier == PHYSICS_LOD_REDUCED) {
+            list_add(data, data->lod_reduced, body);
+        } else if (tier == PHYSICS_LOD_FROZEN) {
+            data->lod_frozen++;
+
+            if (data->lod_config.extrapolation_time > 0.0f &&
+                body->getLinearVelocity().length2() > LOD_DRIFT_MIN_SPEED * LOD_DRIFT_MIN_SPEED) {
+                lod.drift = data->lod_config.extrapolation_time;
+                list_add(data, data->lod_drifting, body);
+            }
+        }
+    }
+
+    // Applied every time, snapshot restores and sector loads may have changed the state
+    if (tier == PHYSICS_LOD_FROZEN) {
+        if (body->getActivationState() != DISABLE_SIMULATION && body->isActive()) {
+            body->forceActivationState(DISABLE_SIMULATION);
+        }
+    } else if (tier == PHYSICS_LOD_FULL && body->getActivationState() == DISABLE_SIMULATION) {
+        body->forceActivationState(ACTIVE_TAG);
+        body->setDeactivationTime(0.0f);
+    }
+}
+
+void physics_lod_update(physics_world_t* world) {
+    physics_world_data_t* data = world->data;
+
+    if (!data->lod_enabled || data->bodies.empty()) {
+        return;
+    }
+
+    const physics_lod_config_t& config = data->lod_config;
+    unsigned int count = (unsigned int)data->bodies.size();
+    unsigned int budget = config.classify_rate > 0
+        ? config.classify_rate
+        : (count + LOD_DEFAULT_CLASSIFY_SPREAD - 1) / LOD_DEFAULT_CLASSIFY_SPREAD;
+
+    if (budget > count) {
+        budget = count;
+    }
+
+    for (unsigned int i = 0; i < budget; i++) {
+        if (data->lod_cursor >= count) {
+            data->lod_cursor = 0;
+        }
+
+        btRigidBody* body = data->bodies[data->lod_cursor++];
+        body_lod_t& lod = body_lod(data, body);
+
+        // Sleeping bodies already cost nothing, leave them to the island manager
+        if (body->isStaticOrKinematicObject() || (lod.tier == PHYSICS_LOD_FULL && body->getActivationState() == ISLAND_SLEEPING)) {
+            continue;
+        }
+
+        float scale = lod.hidden ? config.hidden_scale : 1.0f;
+        float reduced = config.reduced_distance * scale;
+        float frozen = config.frozen_distance * scale;
+        float hysteresis = config.hysteresis * scale;
+        float distance = (body->getWorldTransform().getOrigin() - data->lod_focus).length();
+
+        // Coarser past a threshold, finer only once well inside it again
+        physics_lod_tier_t tier = (physics_lod_tier_t)lod.tier;
+
+        if (distance > frozen) {
+            tier = PHYSICS_LOD_FROZEN;
+        } else if (distance > reduced) {
+            if (tier == PHYSICS_LOD_FULL || distance < frozen - hysteresis) {
+                tier = PHYSICS_LOD_REDUCED;
+            }
+        } else if (distance < reduced - hysteresis) {
+            tier = PHYSICS_LOD_FULL;
+        } else if (tier == PHYSICS_LOD_FROZEN) {
+            tier = PHYSICS_LOD_REDUCED;
+        }
+
+        set_tier(data, body, tier);
+    }
+}
+
+void physics_lod_pre_tick(physics_world_t* world) {
+    physics_world_data_t* data = world->data;
+
+    if (!data->lod_enabled || data->lod_reduced.empty()) {
+        return;
+    }
+
+    data->lod_tick++;
+
+    btScalar interval = (btScalar)data->lod_config.reduced_interval;
+    btVector3 gravity = static_cast<btDiscreteDynamicsWorld*>(world->dynamics_world)->getGravity();
+
+    for (btRigidBody* body : data->lod_reduced) {
+        if (!reduced_due(data, body)) {
+            if (body->isActive()) {
+                body->forceActivationState(DISABLE_SIMULATION);
+            }
+
+            continue;
+        }
+
+        if (body->getActivationState() == DISABLE_SIMULATION) {
+            body->forceActivationState(ACTIVE_TAG);
+        } else if (body->getActivationState() == ISLAND_SLEEPING) {
+            continue; // Asleep on its own, stays asleep
+        }
+
+        // One tick of length dt at velocity v*k moves as far as k ticks at v,
+        // gravity k*k makes the unscaled velocity gain k ticks of gravity
+        body->setLinearVelocity(body->getLinearVelocity() * interval);
+        body->setAngularVelocity(body->getAngularVelocity() * interval);
+        body->setGravity(gravity * (interval * interval));
+    }
+}
+
+void physics_lod_post_tick(physics_world_t* world, float dt) {
+    physics_world_data_t* data = world->data;
+
+    if (!data->lod_enabled) {
+        return;
+    }
+
+    if (!data->lod_reduced.empty()) {
+        btScalar inverse = btScalar(1) / (btScalar)data->lod_config.reduced_interval;
+        btVector3 gravity = static_cast<btDiscreteDynamicsWorld*>(world->dynamics_world)->getGravity();
+
+        for (btRigidBody* body : data->lod_reduced) {
+            if (reduced_due(data, body) && body->getActivationState() != ISLAND_SLEEPING) {
+                body->setLinearVelocity(body->getLinearVelocity() * inverse);
+                body->setAngularVelocity(body->getAngularVelocity() * inverse);
+                body->setGravity(gravity);
+            }
+        }
+    }
+
+    btDiscreteDynamicsWorld* dynamics_world = static_cast<btDiscreteDynamicsWorld*>(world->dynamics_world);
+
+    for (size_t i = data->lod_drifting.size(); i-- > 0;) {
+        btRigidBody* body = data->lod_drifting[i];
+        body_lod_t& lod = body_lod(data, body);
+
+        // Ballistic without gravity: with no collision checks it must not fall through the floor
+        btTransform transform;
+        btTransformUtil::integrateTransform(body->getWorldTransform(), body->getLinearVelocity(), body->getAngularVelocity(), dt, transform);
+
+        body->setWorldTransform(transform);
+        body->setInterpolationWorldTransform(transform);
+        static_cast<btDefaultMotionState*>(body->getMotionState())->m_graphicsWorldTrans = transform;
+        dynamics_world->updateSingleAabb(body);
+        data->exported[body->getUserIndex()] = 0;
+
+        lod.drift -= dt;
+
+        if (lod.drift <= 0.0f) {
+            list_remove(data, data->lod_drifting, body);
+        }
+    }
+}
+
+void physics_lod_forget(physics_world_data_t* data, btRigidBody* body) {
+    if (!data->lod_enabled || body->getUserIndex() < 0) {
+        return;
+    }
+
+    body_lod_t& lod = body_lod(data, body);
+
+    if (lod.tier == PHYSICS_LOD_REDUCED) {
+        list_remove(data, data->lod_reduced, body);
+    } else if (lod.tier == PHYSICS_LOD_FROZEN) {
+        list_remove(data, data->lod_drifting, body);
+        data->lod_frozen--;
+    }
+
+    lod.tier = PHYSICS_LOD_FULL;
+
+    // Leaves the world simulated, e.g. when its sector is loaded again
+    if (body->getActivationState() == DISABLE_SIMULATION) {
+        body->forceActivationState(ACTIVE_TAG);
+    }
+}
+
+extern "C" {
+
+int physics_lod_enable(physics_world_t* world, const physics_lod_config_t* config) {
+    if (!world || !world->dynamics_world || !world->data) {
+        printf("Error: Invalid physics world\n");
+        return -1;
+    }
+
+    physics_world_data_t* data = world->data;
+    btDiscreteDynamicsWorld* dynamics_world = static_cast<btDiscreteDynamicsWorld*>(world->dynamics_world);
+
+    if (!config) {
+        if (data->lod_enabled) {
+            for (btRigidBody* body : data->bodies) {
+                set_tier(data, body, PHYSICS_LOD_FULL);
+            }
+
+            data->lod_enabled = false;
+            dynamics_world->setForceUpdateAllAabbs(true);
+        }
+
+        return 0;
+    }
+
+    if (config->reduced_distance <= 0.0f || config->frozen_distance < config->reduced_distance) {
+        fprintf(stderr, "Invalid physics LOD distances: reduced %.1f | frozen %.1f\n", config->reduced_distance, config->frozen_distance);
+        return -1;
+    }
+
+    data->lod_config = *config;
+
+    if (data->lod_config.reduced_interval == 0) {
+        data->lod_config.reduced_interval = LOD_DEFAULT_INTERVAL;
+    }
+
+    if (data->lod_config.hidden_scale <= 0.0f) {
+        data->lod_config.hidden_scale = LOD_DEFAULT_HIDDEN_SCALE;
+    }
+
+    if (data->lod_config.hysteresis <= 0.0f) {
+        data->lod_config.hysteresis = config->reduced_distance * 0.1f;
+    }
+
+    data->lod_enabled = true;
+
+    // Frozen bodies don't move, only active ones need their AABBs refreshed
+    dynamics_world->setForceUpdateAllAabbs(false);
+
+    printf("Physics LOD: reduced beyond %.0f (1/%u rate) | frozen beyond %.0f\n",
+           config->reduced_distance, data->lod_config.reduced_interval, config->frozen_distance);
+
+    return 0;
+}
+
+void physics_lod_set_focus(physics_world_t* world, vec3 focus) {
+    if (!world || !world->data) {
+        return;
+    }
+
+    world->data->lod_focus.setValue(focus[0], focus[1], focus[2]);
+}
+
+void physics_lod_set_visible(physics_world_t* world, btRigidBody* body, int visible) {
+    if (!world || !world->data || !body || body->getUserIndex() < 0) {
+        return;
+    }
+
+    body_lod(world->data, body).hidden = visible ? 0 : 1;
+}
+
+physics_lod_tier_t physics_lod_get_tier(const physics_world_t* world, btRigidBody* body) {
+    if (!world || !world->data || !body || body->getUserIndex() < 0) {
+        return PHYSICS_LOD_FULL;
+    }
+
+    return (physics_lod_tier_t)world->data->lod[body->getUserIndex()].tier;
+}
+
+} // extern "C"
@@ -0,0 +1,245 @@
+#include "physics_internal.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Static triangle mesh collision with a quantized BVH cached on disk
+// The cache file is the header below followed by the BVH exactly as
+// serializeInPlace() wrote it, so a warm load maps the file copy-on-write
+// and only patches the BVH header in place
+
+#define MESH_CACHE_MAGIC 0x4856424Du // "MBVH"
+#define MESH_CACHE_VERSION 1
+
+struct alignas(16) mesh_cache_header_t {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t hash;        // Over positions and indices, a changed mesh rebuilds
+    uint32_t vertex_count;
+    uint32_t index_count;
+    uint32_t bvh_size;
+    uint32_t scalar_size; // Float and double Bullet builds don't share caches
+};
+
+// Kept in the shape user pointer, Bullet only references the mesh memory
+struct mesh_entry_t {
+    btTriangleIndexVertexArray* arrays;
+    float* vertices;
+    int* indices;
+    void* mapping; // Mapped cache file holding the BVH, NULL when built here
+    size_t mapping_size;
+};
+
+// FNV-1a over 32-bit words, the mesh is hashed on every load
+uint64_t physics_mesh_hash(const float* positions, unsigned int vertex_count, const unsigned int* indices, unsigned int index_count) {
+    uint64_t hash = 14695981039346656037ull;
+    const uint32_t* words = reinterpret_cast<const uint32_t*>(positions);
+
+    for (size_t i = 0; i < (size_t)vertex_count * 3; i++) {
+        hash = (hash ^ words[i]) * 1099511628211ull;
+    }
+
+    for (size_t i = 0; i < index_count; i++) {
+        hash = (hash ^ indices[i]) * 1099511628211ull;
+    }
+
+    return hash;
+}
+
+static btOptimizedBvh* cache_load(const char* path, const mesh_cache_header_t* expected, mesh_entry_t* entry) {
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    struct stat info;
+
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(mesh_cache_header_t)) {
+        close(fd);
+        return nullptr;
+    }
+
+    // Private mapping: deSerializeInPlace() writes the BVH header, the file stays untouched
+    size_t size = (size_t)info.st_size;
+    void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (mapping == MAP_FAILED) {
+        return nullptr;
+    }
+
+    const mesh_cache_header_t* header = static_cast<const mesh_cache_header_t*>(mapping);
+
+    if (header->magic != expected->magic || header->version != expected->version || header->hash != expected->hash ||
+        header->vertex_count != expected->vertex_count || header->index_count != expected->index_count ||
+        header->scalar_size != expected->scalar_size || size != sizeof(mesh_cache_header_t) + header->bvh_size) {
+        munmap(mapping, size);
+        return nullptr;
+    }
+
+    btOptimizedBvh* bvh = static_cast<btOptimizedBvh*>(btOptimizedBvh::deSerializeInPlace(
+        static_cast<unsigned char*>(mapping) + sizeof(mesh_cache_header_t), header->bvh_size, false
+    ));
+
+    if (!bvh) {
+        munmap(mapping, size);
+        return nullptr;
+    }
+
+    entry->mapping = mapping;
+    entry->mapping_size = size;
+
+    return bvh;
+}
+
+int physics_cache_write_atomic(const char* path, const physics_cache_block_t* blocks, unsigned int count) {
+    // Written aside and renamed, a crash never leaves a half written cache behind
+    char temp_path[1024];
+
+    if (snprintf(temp_path, sizeof(temp_path), "%s.tmp", path) >= (int)sizeof(temp_path)) {
+        fprintf(stderr, "Cache path too long: %s\n", path);
+        return -1;
+    }
+
+    FILE* file = fopen(temp_path, "wb");
+
+    if (!file) {
+        fprintf(stderr, "Failed to open cache %s\n", temp_path);
+        return -1;
+    }
+
+    bool written = true;
+
+    for (unsigned int i = 0; written && i < count; i++) {
+        written = blocks[i].size == 0 || fwrite(blocks[i].data, blocks[i].size, 1, file) == 1;
+    }
+
+    written = fclose(file) == 0 && written;
+
+    if (!written || rename(temp_path, path) != 0) {
+        fprintf(stderr, "Failed to write cache %s\n", path);
+        unlink(temp_path);
+        return -1;
+    }
+
+    return 0;
+}
+
+static void cache_store(const char* path, mesh_cache_header_t header, const btOptimizedBvh* bvh) {
+    header.bvh_size = bvh->calculateSerializeBufferSize();
+
+    void* buffer = btAlignedAlloc(header.bvh_size, 16);
+
+    if (!buffer) {
+        fprintf(stderr, "Failed to allocate BVH cache buffer\n");
+        return;
+    }
+
+    if (!bvh->serializeInPlace(buffer, header.bvh_size, false)) {
+        fprintf(stderr, "Failed to serialize mesh BVH\n");
+        btAlignedFree(buffer);
+        return;
+    }
+
+    physics_cache_block_t blocks[] = {{&header, sizeof(header)}, {buffer, header.bvh_size}};
+    int written = physics_cache_write_atomic(path, blocks, 2);
+    btAlignedFree(buffer);
+
+    if (written != 0) {
+        return;
+    }
+
+    printf("Wrote BVH cache %s (%u KB)\n", path, header.bvh_size / 1024);
+}
+
+btCollisionShape* physics_mesh_shape_create(const float* positions, unsigned int vertex_count,
+                                            const unsigned int* indices, unsigned int index_count, const char* cache_path) {
+    mesh_entry_t* entry = new mesh_entry_t();
+    entry->vertices = static_cast<float*>(btAlignedAlloc(sizeof(float) * 3 * vertex_count, 16));
+    entry->indices = static_cast<int*>(btAlignedAlloc(sizeof(int) * index_count, 16));
+
+    if (!entry->vertices || !entry->indices) {
+        fprintf(stderr, "Failed to allocate %u mesh vertices\n", vertex_count);
+        btAlignedFree(entry->vertices);
+        btAlignedFree(entry->indices);
+        delete entry;
+        return nullptr;
+    }
+
+    memcpy(entry->vertices, positions, sizeof(float) * 3 * vertex_count);
+
+    for (unsigned int i = 0; i < index_count; i++) {
+        entry->indices[i] = (int)indices[i];
+    }
+
+    btIndexedMesh mesh;
+    mesh.m_numTriangles = (int)(index_count / 3);
+    mesh.m_triangleIndexBase = reinterpret_cast<const unsigned char*>(entry->indices);
+    mesh.m_triangleIndexStride = 3 * sizeof(int);
+    mesh.m_numVertices = (int)vertex_count;
+    mesh.m_vertexBase = reinterpret_cast<const unsigned char*>(entry->vertices);
+    mesh.m_vertexStride = 3 * sizeof(float);
+    mesh.m_indexType = PHY_INTEGER;
+    mesh.m_vertexType = PHY_FLOAT;
+
+    entry->arrays = new btTriangleIndexVertexArray();
+    entry->arrays->addIndexedMesh(mesh, PHY_INTEGER);
+
+    mesh_cache_header_t header = {};
+    btOptimizedBvh* bvh = nullptr;
+
+    if (cache_path) {
+        header.magic = MESH_CACHE_MAGIC;
+        header.version = MESH_CACHE_VERSION;
+        header.hash = physics_mesh_hash(positions, vertex_count, indices, index_count);
+        header.vertex_count = vertex_count;
+        header.index_count = index_count;
+        header.scalar_size = sizeof(btScalar);
+
+        bvh = cache_load(cache_path, &header, entry);
+    }
+
+    btBvhTriangleMeshShape* shape;
+
+    if (bvh) {
+        // The mapped BVH isn't owned by the shape, unmapped in physics_mesh_shape_free()
+        shape = new btBvhTriangleMeshShape(entry->arrays, true, false);
+        shape->setOptimizedBvh(bvh);
+        printf("Loaded BVH cache %s\n", cache_path);
+    } else {
+        shape = new btBvhTriangleMeshShape(entry->arrays, true, true);
+
+        if (cache_path) {
+            cache_store(cache_path, header, shape->getOptimizedBvh());
+        }
+    }
+
+    shape->setUserPointer(entry);
+
+    return shape;
+}
+
+void physics_mesh_shape_free(btCollisionShape* shape) {
+    mesh_entry_t* entry = static_cast<mesh_entry_t*>(shape->getUserPointer());
+
+    delete shape;
+
+    if (!entry) {
+        return;
+    }
+
+    delete entry->arrays;
+    btAlignedFree(entry->vertices);
+    btAlignedFree(entry->indices);
+
+    if (entry->mapping) {
+        munmap(entry->mapping, entry->mapping_size);
+    }
+
+    delete entry;
+}
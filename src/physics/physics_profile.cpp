@@ -0,0 +1,219 @@
+#include "physics_internal.h"
+#include <LinearMath/btQuickprof.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+// Per-phase step timing on Bullet's profile zone hooks
+// The hooks are process wide: they are installed while at least one world
+// has profiling on and Bullet's previous ones are put back after. Zones are
+// attributed through a thread local target set around the stepping world's
+// ticks, so worlds stepped concurrently by a group don't mix. Zones opened on
+// job threads of a multithreaded world have no target and fall inside the
+// stepping thread's enclosing phase.
+// Times are exclusive: a phase nested in another is not counted twice
+
+#define PROFILE_MAX_DEPTH 32
+
+struct profile_zone_t {
+    int phase;             // -1 for zones outside every phase, e.g. stepSimulation
+    uint64_t start;
+    uint64_t phase_nested; // Time spent in nested phases, not counted here
+};
+
+struct profile_thread_t {
+    physics_profile_t* target = nullptr;
+    unsigned int depth = 0;
+    unsigned int overflow = 0; // Zones past PROFILE_MAX_DEPTH, ignored
+    profile_zone_t zones[PROFILE_MAX_DEPTH];
+};
+
+struct profile_phase_name_t {
+    const char* name;
+    physics_phase_t phase;
+};
+
+// Zone names of btDiscreteDynamicsWorld, btCollisionWorld and the island manager
+static const profile_phase_name_t phase_names[] = {
+    {"updateAabbs", PHYSICS_PHASE_BROADPHASE},
+    {"calculateOverlappingPairs", PHYSICS_PHASE_BROADPHASE},
+    {"dispatchAllCollisionPairs", PHYSICS_PHASE_NARROWPHASE},
+    {"createPredictiveContacts", PHYSICS_PHASE_NARROWPHASE},
+    {"calculateSimulationIslands", PHYSICS_PHASE_ISLANDS},
+    {"islandUnionFindAndQuickSort", PHYSICS_PHASE_ISLANDS},
+    {"updateActivationState", PHYSICS_PHASE_ISLANDS},
+    {"solveConstraints", PHYSICS_PHASE_SOLVER},
+    {"predictUnconstraintMotion", PHYSICS_PHASE_INTEGRATION},
+    {"integrateTransforms", PHYSICS_PHASE_INTEGRATION},
+    {"synchronizeMotionStates", PHYSICS_PHASE_INTEGRATION},
+};
+
+static thread_local profile_thread_t profile_thread;
+
+static unsigned int hook_users = 0; // Worlds with profiling on, changed between steps only
+static btEnterProfileZoneFunc* previous_enter = nullptr;
+static btLeaveProfileZoneFunc* previous_leave = nullptr;
+
+static int phase_of(const char* name) {
+    for (const profile_phase_name_t& entry : phase_names) {
+        if (strcmp(name, entry.name) == 0) {
+            return entry.phase;
+        }
+    }
+
+    return -1;
+}
+
+static void profile_enter(const char* name) {
+    profile_thread_t& thread = profile_thread;
+
+    if (!thread.target) {
+        return;
+    }
+
+    if (thread.depth == PROFILE_MAX_DEPTH) {
+        thread.overflow++;
+        return;
+    }
+
+    profile_zone_t& zone = thread.zones[thread.depth++];
+    zone.phase = phase_of(name);
+    zone.phase_nested = 0;
+    zone.start = physics_now_ns();
+}
+
+static void profile_leave(void) {
+    profile_thread_t& thread = profile_thread;
+
+    if (!thread.target || thread.depth == 0) {
+        return;
+    }
+
+    if (thread.overflow > 0) {
+        thread.overflow--;
+        return;
+    }
+
+    profile_zone_t& zone = thread.zones[--thread.depth];
+    uint64_t nested = zone.phase_nested;
+
+    if (zone.phase >= 0) {
+        uint64_t elapsed = physics_now_ns() - zone.start;
+
+        thread.target->phase_ms[zone.phase] += (double)(elapsed - nested) / 1e6;
+        nested = elapsed;
+    }
+
+    // Whatever this zone spent in phases is nested time for the enclosing one
+    if (thread.depth > 0) {
+        thread.zones[thread.depth - 1].phase_nested += nested;
+    }
+}
+
+static void count_islands(physics_world_t* world, physics_profile_t* profile) {
+    physics_world_data_t* data = world->data;
+    std::vector<int>& tags = data->profile_islands;
+
+    tags.clear();
+
+    for (btRigidBody* body : data->bodies) {
+        if (!body->isStaticOrKinematicObject() && body->isActive()) {
+            profile->active_bodies++;
+
+            if (body->getIslandTag() >= 0) {
+                tags.push_back(body->getIslandTag());
+            }
+        }
+    }
+
+    std::sort(tags.begin(), tags.end());
+    profile->islands = (unsigned int)(std::unique(tags.begin(), tags.end()) - tags.begin());
+}
+
+void physics_profile_begin(physics_world_t* world) {
+    physics_world_data_t* data = world->data;
+
+    if (!data->profile_enabled) {
+        return;
+    }
+
+    data->profile_current = {};
+    data->profile_start = physics_now_ns();
+
+    profile_thread.target = &data->profile_current;
+    profile_thread.depth = 0;
+    profile_thread.overflow = 0;
+}
+
+void physics_profile_end(physics_world_t* world, unsigned int ticks) {
+    physics_world_data_t* data = world->data;
+
+    if (!data->profile_enabled) {
+        return;
+    }
+
+    profile_thread.target = nullptr;
+
+    physics_profile_t& profile = data->profile_current;
+    profile.ticks = ticks;
+    profile.step_ms = (double)(physics_now_ns() - data->profile_start) / 1e6;
+
+    btCollisionDispatcher* dispatcher = static_cast<btCollisionDispatcher*>(world->dispatcher);
+    int manifolds = dispatcher->getNumManifolds();
+
+    profile.pairs = (unsigned int)static_cast<btBroadphaseInterface*>(world->broadphase)->getOverlappingPairCache()->getNumOverlappingPairs();
+    profile.manifolds = (unsigned int)manifolds;
+
+    for (int i = 0; i < manifolds; i++) {
+        profile.contacts += (unsigned int)dispatcher->getManifoldByIndexInternal(i)->getNumContacts();
+    }
+
+    count_islands(world, &profile);
+
+    data->profile = profile;
+}
+
+extern "C" {
+
+int physics_profile_enable(physics_world_t* world, int enabled) {
+    if (!world || !world->dynamics_world || !world->data) {
+        printf("Error: Invalid physics world\n");
+        return -1;
+    }
+
+    physics_world_data_t* data = world->data;
+
+    if ((enabled != 0) == data->profile_enabled) {
+        return 0;
+    }
+
+    data->profile_enabled = enabled != 0;
+
+    if (enabled) {
+        if (hook_users++ == 0) {
+            previous_enter = btGetCurrentEnterProfileZoneFunc();
+            previous_leave = btGetCurrentLeaveProfileZoneFunc();
+            btSetCustomEnterProfileZoneFunc(profile_enter);
+            btSetCustomLeaveProfileZoneFunc(profile_leave);
+        }
+    } else {
+        if (--hook_users == 0) {
+            btSetCustomEnterProfileZoneFunc(previous_enter);
+            btSetCustomLeaveProfileZoneFunc(previous_leave);
+        }
+
+        data->profile = {};
+    }
+
+    return 0;
+}
+
+physics_profile_t physics_get_profile(const physics_world_t* world) {
+    if (!world || !world->data) {
+        return physics_profile_t{};
+    }
+
+    return world->data->profile;
+}
+
+} // extern "C"
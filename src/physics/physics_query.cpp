@@ -0,0 +1,252 @@
+#include "physics_internal.h"
+#include "core/jobs.h"
+#include <stdio.h>
+
+// Batched ray and sphere sweep queries
+// Bullet queries only read the world, but the broadphase ray stack is shared
+// unless Bullet was built with BT_THREADSAFE, so batches run serially otherwise
+
+// Queries per job, small enough to balance uneven scenes
+#define QUERY_GRAIN 64
+
+struct ray_callback_t : public btCollisionWorld::RayResultCallback {
+    bool any;
+    const collision_filter_t* filter; // Group pair rules on top of the masks
+    btVector3 normal;
+
+    ray_callback_t(bool any_hit, const collision_filter_t* pair_filter) : any(any_hit), filter(pair_filter), normal(0, 0, 0) {}
+
+    bool needsCollision(btBroadphaseProxy* proxy) const override {
+        // One hit answers an any-hit query, skip the narrowphase of the remaining candidates
+        if (any && m_collisionObject) {
+            return false;
+        }
+
+        if (filter) {
+            return physics_filter_collides(filter, m_collisionFilterGroup, m_collisionFilterMask,
+                                           proxy->m_collisionFilterGroup, proxy->m_collisionFilterMask);
+        }
+
+        return RayResultCallback::needsCollision(proxy);
+    }
+
+    btScalar addSingleResult(btCollisionWorld::LocalRayResult& result, bool normal_in_world_space) override {
+        m_closestHitFraction = result.m_hitFraction;
+        m_collisionObject = result.m_collisionObject;
+        normal = normal_in_world_space
+            ? result.m_hitNormalLocal
+            : m_collisionObject->getWorldTransform().getBasis() * result.m_hitNormalLocal;
+
+        // Returning 0 also stops triangle mesh traversal
+        return any ? btScalar(0) : result.m_hitFraction;
+    }
+};
+
+struct sweep_callback_t : public btCollisionWorld::ConvexResultCallback {
+    bool any;
+    const collision_filter_t* filter;
+    const btCollisionObject* object;
+    btVector3 point;
+    btVector3 normal;
+
+    sweep_callback_t(bool any_hit, const collision_filter_t* pair_filter)
+        : any(any_hit), filter(pair_filter), object(nullptr), point(0, 0, 0), normal(0, 0, 0) {}
+
+    bool needsCollision(btBroadphaseProxy* proxy) const override {
+        if (any && object) {
+            return false;
+        }
+
+        if (filter) {
+            return physics_filter_collides(filter, m_collisionFilterGroup, m_collisionFilterMask,
+                                           proxy->m_collisionFilterGroup, proxy->m_collisionFilterMask);
+        }
+
+        return ConvexResultCallback::needsCollision(proxy);
+    }
+
+    btScalar addSingleResult(btCollisionWorld::LocalConvexResult& result, bool normal_in_world_space) override {
+        m_closestHitFraction = result.m_hitFraction;
+        object = result.m_hitCollisionObject;
+        point = result.m_hitPointLocal; // Bullet reports the sweep point in world space despite the name
+        normal = normal_in_world_space
+            ? result.m_hitNormalLocal
+            : object->getWorldTransform().getBasis() * result.m_hitNormalLocal;
+
+        return any ? btScalar(0) : result.m_hitFraction;
+    }
+};
+
+struct query_batch_t {
+    const btCollisionWorld* world;
+    const physics_ray_t* rays;
+    const physics_sweep_t* sweeps;
+    physics_hit_t* hits;
+    unsigned int count;
+    bool any;
+    int group;
+    int mask;
+    const collision_filter_t* filter;
+    unsigned int hit_counts[JOBS_MAX_THREADS];
+};
+
+static inline btVector3 to_bt(const vec3 v) {
+    return btVector3(v[0], v[1], v[2]);
+}
+
+static inline void from_bt(const btVector3& v, vec3 out) {
+    out[0] = v.getX();
+    out[1] = v.getY();
+    out[2] = v.getZ();
+}
+
+static void hit_clear(physics_hit_t* hit) {
+    hit->body = nullptr;
+    glm_vec3_zero(hit->point);
+    glm_vec3_zero(hit->normal);
+    hit->fraction = 1.0f;
+    hit->hit = 0;
+}
+
+static int raycast_one(const query_batch_t* batch, unsigned int i) {
+    const physics_ray_t* ray = &batch->rays[i];
+    physics_hit_t* hit = &batch->hits[i];
+    btVector3 from = to_bt(ray->from);
+    btVector3 to = to_bt(ray->to);
+
+    ray_callback_t callback(batch->any, batch->filter);
+    callback.m_collisionFilterGroup = batch->group;
+    callback.m_collisionFilterMask = batch->mask;
+
+    batch->world->rayTest(from, to, callback);
+
+    if (!callback.m_collisionObject) {
+        hit_clear(hit);
+        return 0;
+    }
+
+    hit->body = const_cast<btRigidBody*>(btRigidBody::upcast(callback.m_collisionObject));
+    from_bt(from.lerp(to, callback.m_closestHitFraction), hit->point);
+    from_bt(callback.normal.normalized(), hit->normal);
+    hit->fraction = callback.m_closestHitFraction;
+    hit->hit = 1;
+
+    return 1;
+}
+
+static int sweep_one(const query_batch_t* batch, unsigned int i) {
+    const physics_sweep_t* sweep = &batch->sweeps[i];
+    physics_hit_t* hit = &batch->hits[i];
+
+    btSphereShape sphere(sweep->radius);
+    btTransform from;
+    btTransform to;
+    from.setIdentity();
+    to.setIdentity();
+    from.setOrigin(to_bt(sweep->from));
+    to.setOrigin(to_bt(sweep->to));
+
+    sweep_callback_t callback(batch->any, batch->filter);
+    callback.m_collisionFilterGroup = batch->group;
+    callback.m_collisionFilterMask = batch->mask;
+
+    batch->world->convexSweepTest(&sphere, from, to, callback);
+
+    if (!callback.object) {
+        hit_clear(hit);
+        return 0;
+    }
+
+    hit->body = const_cast<btRigidBody*>(btRigidBody::upcast(callback.object));
+    from_bt(callback.point, hit->point);
+    from_bt(callback.normal.normalized(), hit->normal);
+    hit->fraction = callback.m_closestHitFraction;
+    hit->hit = 1;
+
+    return 1;
+}
+
+static void query_job(void* user_data, unsigned int index, unsigned int thread_index) {
+    query_batch_t* batch = static_cast<query_batch_t*>(user_data);
+    unsigned int begin = index * QUERY_GRAIN;
+    unsigned int end = btMin(begin + QUERY_GRAIN, batch->count);
+    unsigned int hits = 0;
+
+    // Query scratch memory is short lived, keep it off the world arena and its lock
+    physics_arena_scope_t scope(nullptr);
+
+    for (unsigned int i = begin; i < end; i++) {
+        hits += batch->rays ? raycast_one(batch, i) : sweep_one(batch, i);
+    }
+
+    batch->hit_counts[thread_index] += hits;
+}
+
+static unsigned int query_run(physics_world_t* world, query_batch_t* batch, const physics_query_params_t* params) {
+    batch->world = static_cast<btCollisionWorld*>(static_cast<btDiscreteDynamicsWorld*>(world->dynamics_world));
+    batch->any = params && params->mode == PHYSICS_QUERY_ANY;
+    batch->group = params && params->filter_group ? params->filter_group : btBroadphaseProxy::DefaultFilter;
+    batch->mask = params && params->filter_mask ? params->filter_mask
+                                                : btBroadphaseProxy::AllFilter ^ btBroadphaseProxy::SensorTrigger;
+    batch->filter = world->data ? world->data->filter : nullptr;
+
+    unsigned int chunks = (batch->count + QUERY_GRAIN - 1) / QUERY_GRAIN;
+
+#if BT_THREADSAFE
+    jobs_parallel_for(chunks, query_job, batch);
+#else
+    for (unsigned int i = 0; i < chunks; i++) {
+        query_job(batch, i, 0);
+    }
+#endif
+
+    unsigned int hits = 0;
+
+    for (int i = 0; i < JOBS_MAX_THREADS; i++) {
+        hits += batch->hit_counts[i];
+    }
+
+    return hits;
+}
+
+extern "C" {
+
+unsigned int physics_raycast_batch(physics_world_t* world, const physics_ray_t* rays, unsigned int count,
+                                   const physics_query_params_t* params, physics_hit_t* hits) {
+    if (!world || !world->dynamics_world) {
+        printf("Error: Invalid physics world\n");
+        return 0;
+    }
+
+    if (count == 0 || !rays || !hits) {
+        return 0;
+    }
+
+    query_batch_t batch = {};
+    batch.rays = rays;
+    batch.hits = hits;
+    batch.count = count;
+
+    return query_run(world, &batch, params);
+}
+
+unsigned int physics_sweep_sphere_batch(physics_world_t* world, const physics_sweep_t* sweeps, unsigned int count,
+                                        const physics_query_params_t* params, physics_hit_t* hits) {
+    if (!world || !world->dynamics_world) {
+        printf("Error: Invalid physics world\n");
+        return 0;
+    }
+
+    if (count == 0 || !sweeps || !hits) {
+        return 0;
+    }
+
+    query_batch_t batch = {};
+    batch.sweeps = sweeps;
+    batch.hits = hits;
+    batch.count = count;
+
+    return query_run(world, &batch, params);
+}
+
+} // extern "C"
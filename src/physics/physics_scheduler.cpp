@@ -0,0 +1,125 @@
+#include "physics_internal.h"
+#include "core/jobs.h"
+#include <LinearMath/btThreads.h>
+#include <stdio.h>
+
+// Bullet task scheduler running on the engine job system
+// Bullet parallelizes island solving, narrowphase and integration through it
+
+struct parallel_for_ctx_t {
+    const btIParallelForBody* body;
+    physics_arena_t* arena; // Allocations on job threads land in the stepping world
+    int begin;
+    int end;
+    int grain;
+};
+
+struct parallel_sum_ctx_t {
+    const btIParallelSumBody* body;
+    physics_arena_t* arena;
+    int begin;
+    int end;
+    int grain;
+    btScalar sums[JOBS_MAX_THREADS]; // One partial sum per job thread
+};
+
+static void parallel_for_job(void* user_data, unsigned int index, unsigned int thread_index) {
+    (void)thread_index;
+
+    parallel_for_ctx_t* ctx = static_cast<parallel_for_ctx_t*>(user_data);
+    physics_arena_scope_t scope(ctx->arena);
+    int begin = ctx->begin + (int)index * ctx->grain;
+    int end = btMin(begin + ctx->grain, ctx->end);
+
+    ctx->body->forLoop(begin, end);
+}
+
+static void parallel_sum_job(void* user_data, unsigned int index, unsigned int thread_index) {
+    parallel_sum_ctx_t* ctx = static_cast<parallel_sum_ctx_t*>(user_data);
+    physics_arena_scope_t scope(ctx->arena);
+    int begin = ctx->begin + (int)index * ctx->grain;
+    int end = btMin(begin + ctx->grain, ctx->end);
+
+    ctx->sums[thread_index] += ctx->body->sumLoop(begin, end);
+}
+
+class physics_job_scheduler_t : public btITaskScheduler {
+public:
+    physics_job_scheduler_t() : btITaskScheduler("MiracleJobs") {}
+
+    int getMaxNumThreads() const override {
+        return JOBS_MAX_THREADS;
+    }
+
+    int getNumThreads() const override {
+        return (int)jobs_thread_count();
+    }
+
+    void setNumThreads(int numThreads) override {
+        // The pool is sized once by jobs_init(), Bullet only reads the count back
+        (void)numThreads;
+    }
+
+    void parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody& body) override {
+        if (iEnd <= iBegin) {
+            return;
+        }
+
+        parallel_for_ctx_t ctx;
+        ctx.body = &body;
+        ctx.arena = physics_current_arena;
+        ctx.begin = iBegin;
+        ctx.end = iEnd;
+        ctx.grain = grainSize > 0 ? grainSize : 1;
+
+        unsigned int chunks = (unsigned int)((iEnd - iBegin + ctx.grain - 1) / ctx.grain);
+
+        btPushThreadsAreRunning();
+        jobs_parallel_for(chunks, parallel_for_job, &ctx);
+        btPopThreadsAreRunning();
+    }
+
+    btScalar parallelSum(int iBegin, int iEnd, int grainSize, const btIParallelSumBody& body) override {
+        if (iEnd <= iBegin) {
+            return btScalar(0);
+        }
+
+        parallel_sum_ctx_t ctx = {};
+        ctx.body = &body;
+        ctx.arena = physics_current_arena;
+        ctx.begin = iBegin;
+        ctx.end = iEnd;
+        ctx.grain = grainSize > 0 ? grainSize : 1;
+
+        unsigned int chunks = (unsigned int)((iEnd - iBegin + ctx.grain - 1) / ctx.grain);
+
+        btPushThreadsAreRunning();
+        jobs_parallel_for(chunks, parallel_sum_job, &ctx);
+        btPopThreadsAreRunning();
+
+        btScalar sum = btScalar(0);
+
+        for (int i = 0; i < JOBS_MAX_THREADS; i++) {
+            sum += ctx.sums[i];
+        }
+
+        return sum;
+    }
+};
+
+btITaskScheduler* physics_task_scheduler(unsigned int thread_count) {
+    static physics_job_scheduler_t* scheduler = nullptr;
+
+    if (jobs_thread_count() <= 1 && thread_count != 1) {
+        jobs_init(thread_count);
+    }
+
+    if (!scheduler) {
+        // Outlives every world, keep it out of their arenas
+        physics_arena_scope_t scope(nullptr);
+        scheduler = new physics_job_scheduler_t();
+        btSetTaskScheduler(scheduler);
+    }
+
+    return scheduler;
+}
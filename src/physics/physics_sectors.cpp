@@ -0,0 +1,165 @@
+#include "physics_internal.h"
+#include <stdio.h>
+#include <math.h>
+
+// Sector streaming on a square XZ grid
+// Unloading a sector takes every body whose origin lies inside out of the
+// dynamics world and its broadphase. The body objects stay allocated, so
+// pointers held by the game remain valid, and only the body pointer and
+// its filter are parked. Loading the sector adds them back unchanged
+
+static inline uint64_t sector_key(int x, int z) {
+    return ((uint64_t)(uint32_t)x << 32) | (uint32_t)z;
+}
+
+static inline uint64_t body_sector_key(const physics_world_data_t* data, const btRigidBody* body) {
+    const btVector3& origin = body->getWorldTransform().getOrigin();
+
+    return sector_key((int)floorf(origin.getX() / data->sector_size), (int)floorf(origin.getZ() / data->sector_size));
+}
+
+static void body_park(physics_world_t* world, btRigidBody* body, std::vector<parked_body_t>& sector) {
+    physics_world_data_t* data = world->data;
+    const btBroadphaseProxy* proxy = body->getBroadphaseHandle();
+
+    parked_body_t parked;
+    parked.body = body;
+    parked.group = proxy ? proxy->m_collisionFilterGroup : btBroadphaseProxy::DefaultFilter;
+    parked.mask = proxy ? proxy->m_collisionFilterMask : btBroadphaseProxy::AllFilter;
+
+    physics_contacts_forget(data, body);
+    static_cast<btDiscreteDynamicsWorld*>(world->dynamics_world)->removeRigidBody(body);
+    body_unregister(data, body);
+
+    sector.push_back(parked);
+    data->parked_count++;
+}
+
+void physics_sectors_update(physics_world_t* world) {
+    physics_world_data_t* data = world->data;
+
+    if (data->parked.empty()) {
+        return;
+    }
+
+    // Backwards: a swap remove only moves bodies that were already checked
+    for (size_t i = data->bodies.size(); i-- > 0;) {
+        btRigidBody* body = data->bodies[i];
+
+        if (!body->isActive() || body->isStaticObject()) {
+            continue;
+        }
+
+        auto it = data->parked.find(body_sector_key(data, body));
+
+        if (it != data->parked.end()) {
+            body_park(world, body, it->second);
+        }
+    }
+}
+
+bool physics_sectors_forget(physics_world_data_t* data, btRigidBody* body) {
+    // A parked body doesn't move, so it is still filed under the sector of its origin
+    auto it = data->parked.find(body_sector_key(data, body));
+
+    if (it == data->parked.end()) {
+        return false;
+    }
+
+    std::vector<parked_body_t>& sector = it->second;
+
+    for (size_t i = 0; i < sector.size(); i++) {
+        if (sector[i].body == body) {
+            sector[i] = sector.back();
+            sector.pop_back();
+            data->parked_count--;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+extern "C" {
+
+void physics_sector_of(const physics_world_t* world, vec3 pos, int* sector_x, int* sector_z) {
+    float size = world && world->data ? world->data->sector_size : PHYSICS_SECTOR_SIZE;
+
+    *sector_x = (int)floorf(pos[0] / size);
+    *sector_z = (int)floorf(pos[2] / size);
+}
+
+unsigned int physics_sector_unload(physics_world_t* world, int sector_x, int sector_z) {
+    if (!world || !world->dynamics_world || !world->data) {
+        printf("Error: Invalid physics world\n");
+        return 0;
+    }
+
+    physics_world_data_t* data = world->data;
+    auto inserted = data->parked.emplace(sector_key(sector_x, sector_z), std::vector<parked_body_t>());
+
+    if (!inserted.second) {
+        return 0;
+    }
+
+    physics_arena_scope_t scope(data->arena);
+    std::vector<parked_body_t>& sector = inserted.first->second;
+    uint64_t key = sector_key(sector_x, sector_z);
+
+    for (size_t i = data->bodies.size(); i-- > 0;) {
+        if (body_sector_key(data, data->bodies[i]) == key) {
+            body_park(world, data->bodies[i], sector);
+        }
+    }
+
+    sector.shrink_to_fit();
+
+    return (unsigned int)sector.size();
+}
+
+unsigned int physics_sector_load(physics_world_t* world, int sector_x, int sector_z) {
+    if (!world || !world->dynamics_world || !world->data) {
+        printf("Error: Invalid physics world\n");
+        return 0;
+    }
+
+    physics_world_data_t* data = world->data;
+    auto it = data->parked.find(sector_key(sector_x, sector_z));
+
+    if (it == data->parked.end()) {
+        return 0;
+    }
+
+    physics_arena_scope_t scope(data->arena);
+    btDiscreteDynamicsWorld* dynamics_world = static_cast<btDiscreteDynamicsWorld*>(world->dynamics_world);
+    unsigned int count = (unsigned int)it->second.size();
+
+    data->bodies.reserve(data->bodies.size() + count);
+    data->exported.reserve(data->exported.size() + count);
+    data->previous.reserve(data->previous.size() + count);
+    data->lod.reserve(data->lod.size() + count);
+
+    for (const parked_body_t& parked : it->second) {
+        dynamics_world->addRigidBody(parked.body, parked.group, parked.mask);
+        body_register(data, parked.body);
+    }
+
+    data->parked_count -= count;
+    data->parked.erase(it);
+
+    if (count > 0) {
+        physics_broadphase_optimize(world->broadphase);
+    }
+
+    return count;
+}
+
+int physics_sector_is_loaded(const physics_world_t* world, int sector_x, int sector_z) {
+    if (!world || !world->data) {
+        return 0;
+    }
+
+    return world->data->parked.find(sector_key(sector_x, sector_z)) == world->data->parked.end();
+}
+
+} // extern "C"
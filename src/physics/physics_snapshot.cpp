@@ -0,0 +1,436 @@
+#include "physics_internal.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+
+// World snapshots in a caller owned flat buffer:
+// header | body records (full) or slot + record (delta) | manifolds with their points
+// Bodies are addressed by registry slot, so a snapshot only fits the world
+// layout it was taken from: adding or removing bodies invalidates it
+
+#define SNAPSHOT_MAGIC 0x4E534D50u // "PMSN"
+#define SNAPSHOT_DELTA 1u
+#define SNAPSHOT_MAX_POINTS 4 // Bullet's manifold cache size
+
+struct alignas(16) snapshot_header_t {
+    uint32_t magic;
+    uint32_t flags;
+    uint32_t layout; // Registry version the slots refer to
+    uint32_t body_count;
+    uint32_t record_count;
+    uint32_t manifold_count;
+    uint32_t point_count;
+    float accumulator;
+    uint64_t size; // Bytes including this header
+};
+
+struct body_record_t {
+    btTransformFloatData transform;
+    btVector3FloatData linear_velocity;
+    btVector3FloatData angular_velocity;
+    float deactivation_time;
+    int activation_state;
+    int pad[2];
+};
+
+struct delta_record_t {
+    uint32_t slot;
+    uint32_t pad[3];
+    body_record_t record;
+};
+
+struct manifold_record_t {
+    uint32_t slot0; // Manifold body order, restored onto the manifold of the same order
+    uint32_t slot1;
+    uint32_t point_count;
+    uint32_t pad;
+};
+
+// Warm starting data: cached impulses, friction directions and point lifetimes
+struct point_record_t {
+    btVector3FloatData local_a;
+    btVector3FloatData local_b;
+    btVector3FloatData world_a;
+    btVector3FloatData world_b;
+    btVector3FloatData normal;
+    btVector3FloatData lateral_dir1;
+    btVector3FloatData lateral_dir2;
+    float distance;
+    float applied_impulse;
+    float lateral_impulse1;
+    float lateral_impulse2;
+    float friction;
+    float restitution;
+    int life_time;
+    int flags;
+};
+
+static inline uint64_t manifold_key(uint32_t slot0, uint32_t slot1) {
+    return ((uint64_t)slot0 << 32) | slot1;
+}
+
+// Slot of a registered body, -1 for triggers and foreign objects
+static inline int object_slot(const physics_world_data_t* data, const btCollisionObject* object) {
+    int slot = object->getUserIndex();
+
+    if (slot < 0 || (size_t)slot >= data->bodies.size() || data->bodies[slot] != object) {
+        return -1;
+    }
+
+    return slot;
+}
+
+static void record_fill(const btRigidBody* body, body_record_t* record) {
+    // Padding included, delta snapshots compare records bytewise
+    memset(record, 0, sizeof(body_record_t));
+
+    body->getWorldTransform().serializeFloat(record->transform);
+    body->getLinearVelocity().serializeFloat(record->linear_velocity);
+    body->getAngularVelocity().serializeFloat(record->angular_velocity);
+    record->deactivation_time = body->getDeactivationTime();
+    record->activation_state = body->getActivationState();
+}
+
+static void record_apply(btRigidBody* body, const body_record_t* record) {
+    btTransform transform;
+    btVector3 linear_velocity;
+    btVector3 angular_velocity;
+
+    transform.deSerializeFloat(record->transform);
+    linear_velocity.deSerializeFloat(record->linear_velocity);
+    angular_velocity.deSerializeFloat(record->angular_velocity);
+
+    body->setWorldTransform(transform);
+    body->setInterpolationWorldTransform(transform);
+    body->setLinearVelocity(linear_velocity);
+    body->setAngularVelocity(angular_velocity);
+    body->setInterpolationLinearVelocity(linear_velocity);
+    body->setInterpolationAngularVelocity(angular_velocity);
+    body->clearForces();
+    body->forceActivationState(record->activation_state);
+    body->setDeactivationTime(record->deactivation_time);
+
+    static_cast<btDefaultMotionState*>(body->getMotionState())->m_graphicsWorldTrans = transform;
+}
+
+static void point_fill(const btManifoldPoint& point, point_record_t* record) {
+    memset(record, 0, sizeof(point_record_t));
+
+    point.m_localPointA.serializeFloat(record->local_a);
+    point.m_localPointB.serializeFloat(record->local_b);
+    point.m_positionWorldOnA.serializeFloat(record->world_a);
+    point.m_positionWorldOnB.serializeFloat(record->world_b);
+    point.m_normalWorldOnB.serializeFloat(record->normal);
+    point.m_lateralFrictionDir1.serializeFloat(record->lateral_dir1);
+    point.m_lateralFrictionDir2.serializeFloat(record->lateral_dir2);
+    record->distance = point.m_distance1;
+    record->applied_impulse = point.m_appliedImpulse;
+    record->lateral_impulse1 = point.m_appliedImpulseLateral1;
+    record->lateral_impulse2 = point.m_appliedImpulseLateral2;
+    record->friction = point.m_combinedFriction;
+    record->restitution = point.m_combinedRestitution;
+    record->life_time = point.m_lifeTime;
+    record->flags = point.m_contactPointFlags;
+}
+
+static void point_apply(btPersistentManifold* manifold, const point_record_t* record) {
+    btVector3 local_a;
+    btVector3 local_b;
+    btVector3 normal;
+
+    local_a.deSerializeFloat(record->local_a);
+    local_b.deSerializeFloat(record->local_b);
+    normal.deSerializeFloat(record->normal);
+
+    btManifoldPoint point(local_a, local_b, normal, record->distance);
+    point.m_positionWorldOnA.deSerializeFloat(record->world_a);
+    point.m_positionWorldOnB.deSerializeFloat(record->world_b);
+    point.m_lateralFrictionDir1.deSerializeFloat(record->lateral_dir1);
+    point.m_lateralFrictionDir2.deSerializeFloat(record->lateral_dir2);
+    point.m_appliedImpulse = record->applied_impulse;
+    point.m_appliedImpulseLateral1 = record->lateral_impulse1;
+    point.m_appliedImpulseLateral2 = record->lateral_impulse2;
+    point.m_combinedFriction = record->friction;
+    point.m_combinedRestitution = record->restitution;
+    point.m_lifeTime = record->life_time;
+    point.m_contactPointFlags = record->flags;
+
+    manifold->addManifoldPoint(point);
+}
+
+static const snapshot_header_t* header_check(const physics_world_data_t* data, const void* buffer, size_t size) {
+    const snapshot_header_t* header = static_cast<const snapshot_header_t*>(buffer);
+
+    if (!buffer || size < sizeof(snapshot_header_t) || header->magic != SNAPSHOT_MAGIC || header->size > size) {
+        fprintf(stderr, "Invalid physics snapshot\n");
+        return nullptr;
+    }
+
+    if (header->layout != data->layout_version || header->body_count != data->bodies.size()) {
+        fprintf(stderr, "Physics snapshot doesn't match the world's bodies\n");
+        return nullptr;
+    }
+
+    return header;
+}
+
+// Full snapshot usable as a delta base: header plus one record per body
+static const body_record_t* base_records(const physics_world_data_t* data, const void* base) {
+    const snapshot_header_t* header = static_cast<const snapshot_header_t*>(base);
+
+    if (!base || header->magic != SNAPSHOT_MAGIC || (header->flags & SNAPSHOT_DELTA) ||
+        header->layout != data->layout_version || header->body_count != data->bodies.size()) {
+        fprintf(stderr, "Delta snapshot base must be a full snapshot of the same world layout\n");
+        return nullptr;
+    }
+
+    return reinterpret_cast<const body_record_t*>(header + 1);
+}
+
+extern "C" {
+
+size_t physics_snapshot_size(const physics_world_t* world) {
+    if (!world || !world->dynamics_world || !world->data) {
+        return 0;
+    }
+
+    const btDispatcher* dispatcher = static_cast<const btCollisionDispatcher*>(world->dispatcher);
+    size_t manifold_bytes = sizeof(manifold_record_t) + SNAPSHOT_MAX_POINTS * sizeof(point_record_t);
+
+    // Delta records are the larger ones, the bound holds for both kinds
+    return sizeof(snapshot_header_t) + world->data->bodies.size() * sizeof(delta_record_t) +
+           (size_t)dispatcher->getNumManifolds() * manifold_bytes;
+}
+
+size_t physics_snapshot_save(physics_world_t* world, void* buffer, size_t capacity, const void* base) {
+    if (!world || !world->dynamics_world || !world->data || !buffer) {
+        printf("Error: Invalid physics world\n");
+        return 0;
+    }
+
+    physics_world_data_t* data = world->data;
+    const body_record_t* base_body = nullptr;
+
+    if (base && !(base_body = base_records(data, base))) {
+        return 0;
+    }
+
+    unsigned char* out = static_cast<unsigned char*>(buffer);
+    unsigned char* end = out + capacity;
+    unsigned char* cursor = out + sizeof(snapshot_header_t);
+
+    if (cursor > end) {
+        return 0;
+    }
+
+    snapshot_header_t header = {};
+    header.magic = SNAPSHOT_MAGIC;
+    header.flags = base ? SNAPSHOT_DELTA : 0;
+    header.layout = data->layout_version;
+    header.body_count = (uint32_t)data->bodies.size();
+    header.accumulator = data->accumulator;
+
+    for (uint32_t slot = 0; slot < header.body_count; slot++) {
+        body_record_t record;
+        record_fill(data->bodies[slot], &record);
+
+        if (base_body) {
+            // Sleeping and static bodies match their base record and cost nothing
+            if (memcmp(&record, &base_body[slot], sizeof(body_record_t)) == 0) {
+                continue;
+            }
+
+            if ((size_t)(end - cursor) < sizeof(delta_record_t)) {
+                return 0;
+            }
+
+            delta_record_t* delta = reinterpret_cast<delta_record_t*>(cursor);
+            memset(delta, 0, sizeof(delta_record_t));
+            delta->slot = slot;
+            delta->record = record;
+            cursor += sizeof(delta_record_t);
+        } else {
+            if ((size_t)(end - cursor) < sizeof(body_record_t)) {
+                return 0;
+            }
+
+            memcpy(cursor, &record, sizeof(body_record_t));
+            cursor += sizeof(body_record_t);
+        }
+
+        header.record_count++;
+    }
+
+    btDispatcher* dispatcher = static_cast<btCollisionDispatcher*>(world->dispatcher);
+    int manifold_count = dispatcher->getNumManifolds();
+
+    for (int i = 0; i < manifold_count; i++) {
+        const btPersistentManifold* manifold = dispatcher->getManifoldByIndexInternal(i);
+        int point_count = manifold->getNumContacts();
+        int slot0 = object_slot(data, manifold->getBody0());
+        int slot1 = object_slot(data, manifold->getBody1());
+
+        if (point_count == 0 || slot0 < 0 || slot1 < 0) {
+            continue;
+        }
+
+        size_t bytes = sizeof(manifold_record_t) + (size_t)point_count * sizeof(point_record_t);
+
+        if ((size_t)(end - cursor) < bytes) {
+            return 0;
+        }
+
+        manifold_record_t* record = reinterpret_cast<manifold_record_t*>(cursor);
+        record->slot0 = (uint32_t)slot0;
+        record->slot1 = (uint32_t)slot1;
+        record->point_count = (uint32_t)point_count;
+        record->pad = 0;
+
+        point_record_t* points = reinterpret_cast<point_record_t*>(record + 1);
+
+        for (int j = 0; j < point_count; j++) {
+            point_fill(manifold->getContactPoint(j), &points[j]);
+        }
+
+        cursor += bytes;
+        header.manifold_count++;
+        header.point_count += (uint32_t)point_count;
+    }
+
+    header.size = (uint64_t)(cursor - out);
+    memcpy(out, &header, sizeof(header));
+
+    return (size_t)header.size;
+}
+
+int physics_snapshot_restore(physics_world_t* world, const void* buffer, size_t size, const void* base) {
+    if (!world || !world->dynamics_world || !world->data) {
+        printf("Error: Invalid physics world\n");
+        return -1;
+    }
+
+    physics_world_data_t* data = world->data;
+    const snapshot_header_t* header = header_check(data, buffer, size);
+
+    if (!header) {
+        return -1;
+    }
+
+    const unsigned char* cursor = reinterpret_cast<const unsigned char*>(header + 1);
+    const unsigned char* end = static_cast<const unsigned char*>(buffer) + header->size;
+    size_t record_size = (header->flags & SNAPSHOT_DELTA) ? sizeof(delta_record_t) : sizeof(body_record_t);
+    size_t record_count = (header->flags & SNAPSHOT_DELTA) ? header->record_count : header->body_count;
+
+    if ((size_t)(end - cursor) < record_count * record_size) {
+        fprintf(stderr, "Truncated physics snapshot\n");
+        return -1;
+    }
+
+    if (header->flags & SNAPSHOT_DELTA) {
+        const body_record_t* base_body = base_records(data, base);
+
+        if (!base_body) {
+            return -1;
+        }
+
+        // Base first, then the bodies that changed since
+        for (uint32_t slot = 0; slot < header->body_count; slot++) {
+            record_apply(data->bodies[slot], &base_body[slot]);
+        }
+
+        const delta_record_t* deltas = reinterpret_cast<const delta_record_t*>(cursor);
+
+        for (uint32_t i = 0; i < header->record_count; i++) {
+            if (deltas[i].slot >= header->body_count) {
+                continue;
+            }
+
+            record_apply(data->bodies[deltas[i].slot], &deltas[i].record);
+        }
+
+        cursor += (size_t)header->record_count * sizeof(delta_record_t);
+    } else {
+        const body_record_t* records = reinterpret_cast<const body_record_t*>(cursor);
+
+        for (uint32_t slot = 0; slot < header->body_count; slot++) {
+            record_apply(data->bodies[slot], &records[slot]);
+        }
+
+        cursor += (size_t)header->body_count * sizeof(body_record_t);
+    }
+
+    // No blending across a restore, and every slot has to be exported again
+    for (size_t i = 0; i < data->bodies.size(); i++) {
+        data->previous[i] = data->bodies[i]->getWorldTransform();
+        data->exported[i] = 0;
+    }
+
+    data->accumulator = header->accumulator;
+    data->alpha = data->tick > 0.0f ? data->accumulator / data->tick : 1.0f;
+
+    // Per body: updateAabbs() skips inactive bodies while LOD has forced updates off,
+    // sleeping and frozen bodies moved by the restore would keep stale proxies
+    btDiscreteDynamicsWorld* dynamics_world = static_cast<btDiscreteDynamicsWorld*>(world->dynamics_world);
+
+    for (btRigidBody* body : data->bodies) {
+        if (body->getBroadphaseHandle()) {
+            dynamics_world->updateSingleAabb(body);
+        }
+    }
+
+    // Warm starting: manifolds of pairs the broadphase still tracks get their points back,
+    // the rest start cold on the next step
+    btDispatcher* dispatcher = static_cast<btCollisionDispatcher*>(world->dispatcher);
+    int manifold_count = dispatcher->getNumManifolds();
+
+    data->manifold_lookup.clear();
+
+    for (int i = 0; i < manifold_count; i++) {
+        btPersistentManifold* manifold = dispatcher->getManifoldByIndexInternal(i);
+        int slot0 = object_slot(data, manifold->getBody0());
+        int slot1 = object_slot(data, manifold->getBody1());
+
+        if (slot0 < 0 || slot1 < 0) {
+            continue;
+        }
+
+        manifold->clearManifold();
+        data->manifold_lookup.emplace_back(manifold_key((uint32_t)slot0, (uint32_t)slot1), manifold);
+    }
+
+    std::sort(data->manifold_lookup.begin(), data->manifold_lookup.end());
+
+    for (uint32_t i = 0; i < header->manifold_count; i++) {
+        if ((size_t)(end - cursor) < sizeof(manifold_record_t)) {
+            break;
+        }
+
+        const manifold_record_t* record = reinterpret_cast<const manifold_record_t*>(cursor);
+        const point_record_t* points = reinterpret_cast<const point_record_t*>(record + 1);
+
+        if ((size_t)(end - cursor - sizeof(manifold_record_t)) < (size_t)record->point_count * sizeof(point_record_t)) {
+            break;
+        }
+
+        uint64_t key = manifold_key(record->slot0, record->slot1);
+
+        auto it = std::lower_bound(data->manifold_lookup.begin(), data->manifold_lookup.end(),
+                                   std::make_pair(key, static_cast<btPersistentManifold*>(nullptr)));
+
+        if (it != data->manifold_lookup.end() && it->first == key) {
+            for (uint32_t j = 0; j < record->point_count && j < SNAPSHOT_MAX_POINTS; j++) {
+                point_apply(it->second, &points[j]);
+            }
+        }
+
+        cursor += sizeof(manifold_record_t) + (size_t)record->point_count * sizeof(point_record_t);
+    }
+
+    // Contact events continue from the restored contacts, not the ones before the rollback
+    physics_contacts_reset(world);
+
+    return 0;
+}
+
+} // extern "C"
@@ -0,0 +1,120 @@
+#include "physics_internal.h"
+#include <stdio.h>
+#include <BulletDynamics/ConstraintSolver/btNNCGConstraintSolver.h>
+#include <BulletDynamics/MLCPSolvers/btMLCPSolver.h>
+#include <BulletDynamics/MLCPSolvers/btDantzigSolver.h>
+#include <BulletDynamics/MLCPSolvers/btSolveProjectedGaussSeidel.h>
+#include <BulletDynamics/MLCPSolvers/btLemkeSolver.h>
+
+// Constraint solver backends
+// Every backend is a sequential impulse solver underneath: NNCG changes the
+// iteration, the MLCP solvers assemble each island into one LCP and hand it
+// to a direct solver, falling back to sequential impulse when it fails.
+// Sequential impulse picks its SSE rows by itself on CPUs that have them
+
+static const char* solver_names[] = {"sequential impulse", "NNCG", "MLCP Dantzig", "MLCP PGS", "MLCP Lemke"};
+
+btSequentialImpulseConstraintSolver* physics_solver_create(physics_world_data_t* data, physics_solver_type_t type) {
+    btMLCPSolverInterface* mlcp;
+
+    switch (type) {
+        case PHYSICS_SOLVER_NNCG:
+            return new btNNCGConstraintSolver();
+        case PHYSICS_SOLVER_MLCP_DANTZIG:
+            mlcp = new btDantzigSolver();
+            break;
+        case PHYSICS_SOLVER_MLCP_PGS:
+            mlcp = new btSolveProjectedGaussSeidel();
+            break;
+        case PHYSICS_SOLVER_MLCP_LEMKE:
+            mlcp = new btLemkeSolver();
+            break;
+        default:
+            return new btSequentialImpulseConstraintSolver();
+    }
+
+    data->mlcp_interfaces.push_back(mlcp);
+
+    return new btMLCPSolver(mlcp);
+}
+
+void physics_solver_setup(physics_world_t* world, physics_solver_type_t type) {
+    btContactSolverInfo& info = static_cast<btDiscreteDynamicsWorld*>(world->dynamics_world)->getSolverInfo();
+
+    world->data->solver_type = type;
+
+    // Batched islands would make one large LCP out of unrelated stacks
+    if (type >= PHYSICS_SOLVER_MLCP_DANTZIG) {
+        info.m_minimumSolverBatchSize = 1;
+    }
+
+    printf("Constraint solver: %s | %d iterations\n", solver_names[type], info.m_numIterations);
+}
+
+void physics_solver_destroy(physics_world_data_t* data) {
+    for (btMLCPSolverInterface* mlcp : data->mlcp_interfaces) {
+        delete mlcp;
+    }
+
+    data->mlcp_interfaces.clear();
+}
+
+extern "C" {
+
+physics_solver_params_t physics_get_solver_params(const physics_world_t* world) {
+    physics_solver_params_t params = {};
+
+    if (!world || !world->dynamics_world) {
+        return params;
+    }
+
+    const btContactSolverInfo& info = static_cast<btDiscreteDynamicsWorld*>(world->dynamics_world)->getSolverInfo();
+
+    params.iterations = (unsigned int)info.m_numIterations;
+    params.warm_starting = (info.m_solverMode & SOLVER_USE_WARMSTARTING) != 0;
+    params.warm_starting_factor = info.m_warmstartingFactor;
+    params.split_impulse = info.m_splitImpulse != 0;
+    params.split_impulse_threshold = info.m_splitImpulsePenetrationThreshold;
+    params.erp = info.m_erp;
+    params.randomize_order = (info.m_solverMode & SOLVER_RANDMIZE_ORDER) != 0;
+
+    return params;
+}
+
+int physics_set_solver_params(physics_world_t* world, const physics_solver_params_t* params) {
+    if (!world || !world->dynamics_world || !params) {
+        printf("Error: Invalid physics world\n");
+        return -1;
+    }
+
+    if (params->iterations == 0 || params->warm_starting_factor < 0.0f || params->warm_starting_factor > 1.0f ||
+        params->erp < 0.0f || params->erp > 1.0f || params->split_impulse_threshold > 0.0f) {
+        fprintf(stderr, "Invalid solver params: %u iterations | warm starting %.2f | erp %.2f | split threshold %.3f\n",
+                params->iterations, params->warm_starting_factor, params->erp, params->split_impulse_threshold);
+        return -1;
+    }
+
+    btContactSolverInfo& info = static_cast<btDiscreteDynamicsWorld*>(world->dynamics_world)->getSolverInfo();
+
+    info.m_numIterations = (int)params->iterations;
+    info.m_warmstartingFactor = params->warm_starting_factor;
+    info.m_splitImpulse = params->split_impulse ? 1 : 0;
+    info.m_splitImpulsePenetrationThreshold = params->split_impulse_threshold;
+    info.m_erp = params->erp;
+
+    if (params->warm_starting) {
+        info.m_solverMode |= SOLVER_USE_WARMSTARTING;
+    } else {
+        info.m_solverMode &= ~SOLVER_USE_WARMSTARTING;
+    }
+
+    if (params->randomize_order) {
+        info.m_solverMode |= SOLVER_RANDMIZE_ORDER;
+    } else {
+        info.m_solverMode &= ~SOLVER_RANDMIZE_ORDER;
+    }
+
+    return 0;
+}
+
+} // extern "C"
@@ -0,0 +1,445 @@
+#define _POSIX_C_SOURCE 200112L
+#include "physics_thread.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+
+// Ticks run back to back when the thread fell behind, the rest is dropped
+#define PHYSICS_THREAD_MAX_CATCHUP 5
+// Fresh bit of the shared triple buffer slot
+#define FRAME_FRESH 4u
+
+typedef enum {
+    COMMAND_ADD_BOX,
+    COMMAND_REMOVE,
+    COMMAND_FORCE,
+    COMMAND_IMPULSE,
+    COMMAND_LOD_FOCUS
+} physics_command_type_t;
+
+typedef struct {
+    physics_command_type_t type;
+    unsigned int handle;
+    vec3 a; // Position, force, impulse or LOD focus
+    vec3 b; // Box size
+    float mass;
+} physics_command_t;
+
+struct physics_thread_t {
+    physics_world_t* world;
+    pthread_t thread;
+    atomic_int running;
+    int started;
+    float tick;
+
+    // Single producer, single consumer command ring
+    physics_command_t* commands;
+    unsigned int command_mask;
+    atomic_uint command_head; // Written by the game thread
+    atomic_uint command_tail; // Written by the physics thread
+
+    // Handle table: bodies is physics thread side, the free list game thread side
+    btRigidBody** bodies;
+    unsigned char* fresh; // No previous transform yet
+    unsigned char* live;  // Game thread side: handed out and not removed since
+    unsigned int max_handles;
+    unsigned int handle_high; // Highest used handle + 1
+    unsigned int* free_handles;
+    unsigned int free_count;
+    unsigned int next_handle;
+
+    // Export target for physics_export_transforms(), indexed by body slot
+    float* slot_matrices;
+    unsigned int slot_capacity;
+    float* last_matrices; // Per handle, current of the previous publish
+
+    // Triple buffer: writer owns back, reader owns front, shared holds the third
+    physics_frame_t frames[3];
+    unsigned int back;
+    unsigned int front;
+    atomic_uint shared;
+    unsigned long long tick_count;
+};
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static int command_push(physics_thread_t* thread, const physics_command_t* command) {
+    unsigned int head = atomic_load_explicit(&thread->command_head, memory_order_relaxed);
+    unsigned int tail = atomic_load_explicit(&thread->command_tail, memory_order_acquire);
+
+    if (head - tail > thread->command_mask) {
+        return -1;
+    }
+
+    thread->commands[head & thread->command_mask] = *command;
+    atomic_store_explicit(&thread->command_head, head + 1, memory_order_release);
+
+    return 0;
+}
+
+static void process_commands(physics_thread_t* thread) {
+    unsigned int tail = atomic_load_explicit(&thread->command_tail, memory_order_relaxed);
+    unsigned int head = atomic_load_explicit(&thread->command_head, memory_order_acquire);
+
+    for (; tail != head; tail++) {
+        physics_command_t* command = &thread->commands[tail & thread->command_mask];
+        btRigidBody* body = thread->bodies[command->handle];
+
+        switch (command->type) {
+            case COMMAND_ADD_BOX:
+                thread->bodies[command->handle] = physics_add_box(thread->world, command->a, command->b, command->mass);
+                thread->fresh[command->handle] = 1;
+
+                if (command->handle >= thread->handle_high) {
+                    thread->handle_high = command->handle + 1;
+                }
+                break;
+
+            case COMMAND_REMOVE:
+                physics_remove_body(thread->world, body);
+                thread->bodies[command->handle] = NULL;
+                break;
+
+            case COMMAND_FORCE:
+                physics_apply_central_force(body, command->a);
+                break;
+
+            case COMMAND_IMPULSE:
+                physics_apply_central_impulse(body, command->a);
+                break;
+
+            case COMMAND_LOD_FOCUS:
+                physics_lod_set_focus(thread->world, command->a);
+                break;
+        }
+    }
+
+    atomic_store_explicit(&thread->command_tail, tail, memory_order_release);
+}
+
+static void publish(physics_thread_t* thread, float step_ms) {
+    physics_frame_t* frame = &thread->frames[thread->back];
+
+    physics_export_transforms(thread->world, thread->slot_matrices, thread->slot_capacity, NULL);
+
+    for (unsigned int h = 0; h < thread->handle_high; h++) {
+        int slot = physics_body_index(thread->bodies[h]);
+
+        if (slot < 0 || (unsigned int)slot >= thread->slot_capacity) {
+            continue;
+        }
+
+        float* current = frame->current + (size_t)h * 16;
+        float* last = thread->last_matrices + (size_t)h * 16;
+
+        memcpy(current, thread->slot_matrices + (size_t)slot * 16, sizeof(float) * 16);
+
+        if (thread->fresh[h]) {
+            memcpy(last, current, sizeof(float) * 16);
+            thread->fresh[h] = 0;
+        }
+
+        memcpy(frame->previous + (size_t)h * 16, last, sizeof(float) * 16);
+        memcpy(last, current, sizeof(float) * 16);
+    }
+
+    frame->handle_count = thread->handle_high;
+    frame->tick = thread->tick_count;
+    frame->time = now_seconds();
+    frame->tick_length = thread->tick;
+    frame->step_ms = step_ms;
+
+    // Hand the finished frame over and take whatever the reader left behind
+    unsigned int old = atomic_exchange_explicit(&thread->shared, thread->back | FRAME_FRESH, memory_order_acq_rel);
+    thread->back = old & 3u;
+}
+
+static void* physics_thread_main(void* arg) {
+    physics_thread_t* thread = arg;
+    double next = now_seconds();
+
+    while (atomic_load_explicit(&thread->running, memory_order_relaxed)) {
+        process_commands(thread);
+
+        double now = now_seconds();
+        unsigned int steps = 0;
+
+        while (now >= next && steps < PHYSICS_THREAD_MAX_CATCHUP) {
+            next += thread->tick;
+            steps++;
+        }
+
+        // Too far behind: drop the backlog instead of spiralling
+        if (now >= next) {
+            next = now + thread->tick;
+        }
+
+        if (steps > 0) {
+            double start = now_seconds();
+            physics_step_fixed(thread->world, steps);
+            thread->tick_count += steps;
+
+            publish(thread, (float)((now_seconds() - start) * 1000.0 / steps));
+        }
+
+        struct timespec wake;
+        wake.tv_sec = (time_t)next;
+        wake.tv_nsec = (long)((next - (double)wake.tv_sec) * 1e9);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, NULL);
+    }
+
+    return NULL;
+}
+
+physics_thread_t* physics_thread_create(physics_world_t* world, float tick_rate, unsigned int max_handles, unsigned int command_capacity) {
+    if (!world || !world->dynamics_world || tick_rate <= 0.0f || max_handles == 0) {
+        fprintf(stderr, "Invalid physics thread parameters\n");
+
+        return NULL;
+    }
+
+    physics_thread_t* thread = calloc(1, sizeof(physics_thread_t));
+
+    if (!thread) {
+        fprintf(stderr, "Failed to allocate physics thread\n");
+
+        return NULL;
+    }
+
+    unsigned int capacity = 16;
+
+    while (capacity < command_capacity) {
+        capacity <<= 1;
+    }
+
+    thread->world = world;
+    thread->tick = 1.0f / tick_rate;
+    thread->command_mask = capacity - 1;
+    thread->max_handles = max_handles;
+    thread->slot_capacity = physics_get_stats(world).body_count + max_handles;
+
+    thread->commands = malloc(sizeof(physics_command_t) * capacity);
+    thread->bodies = calloc(max_handles, sizeof(btRigidBody*));
+    thread->fresh = calloc(max_handles, 1);
+    thread->live = calloc(max_handles, 1);
+    thread->free_handles = malloc(sizeof(unsigned int) * max_handles);
+    thread->slot_matrices = malloc(sizeof(float) * 16 * thread->slot_capacity);
+    thread->last_matrices = malloc(sizeof(float) * 16 * max_handles);
+
+    int failed = !thread->commands || !thread->bodies || !thread->fresh || !thread->live || !thread->free_handles ||
+                 !thread->slot_matrices || !thread->last_matrices;
+
+    for (int i = 0; i < 3 && !failed; i++) {
+        thread->frames[i].current = calloc((size_t)max_handles * 16, sizeof(float));
+        thread->frames[i].previous = calloc((size_t)max_handles * 16, sizeof(float));
+        failed = !thread->frames[i].current || !thread->frames[i].previous;
+    }
+
+    if (failed) {
+        fprintf(stderr, "Failed to allocate physics thread buffers\n");
+        physics_thread_destroy(thread);
+
+        return NULL;
+    }
+
+    thread->back = 0;
+    atomic_init(&thread->shared, 1u);
+    thread->front = 2;
+
+    atomic_init(&thread->command_head, 0u);
+    atomic_init(&thread->command_tail, 0u);
+    atomic_init(&thread->running, 0);
+
+    // One wall clock tick must advance the world by exactly one tick
+    physics_set_fixed_timestep(world, tick_rate, PHYSICS_THREAD_MAX_CATCHUP);
+
+    return thread;
+}
+
+unsigned int physics_thread_adopt(physics_thread_t* thread, btRigidBody* body) {
+    if (thread->started || !body || thread->next_handle >= thread->max_handles) {
+        return PHYSICS_INVALID_HANDLE;
+    }
+
+    unsigned int handle = thread->next_handle++;
+
+    thread->bodies[handle] = body;
+    thread->fresh[handle] = 1;
+    thread->live[handle] = 1;
+    thread->handle_high = handle + 1;
+
+    return handle;
+}
+
+int physics_thread_start(physics_thread_t* thread) {
+    if (thread->started) {
+        return 0;
+    }
+
+    // Readers get valid transforms before the first tick
+    publish(thread, 0.0f);
+
+    atomic_store(&thread->running, 1);
+
+    if (pthread_create(&thread->thread, NULL, physics_thread_main, thread) != 0) {
+        fprintf(stderr, "Failed to create physics thread\n");
+        atomic_store(&thread->running, 0);
+
+        return -1;
+    }
+
+    thread->started = 1;
+
+    printf("Physics thread started at %.0f Hz\n", 1.0f / thread->tick);
+
+    return 0;
+}
+
+unsigned int physics_thread_add_box(physics_thread_t* thread, vec3 pos, vec3 size, float mass) {
+    unsigned int handle;
+
+    if (thread->free_count > 0) {
+        handle = thread->free_handles[--thread->free_count];
+    } else if (thread->next_handle < thread->max_handles) {
+        handle = thread->next_handle++;
+    } else {
+        return PHYSICS_INVALID_HANDLE;
+    }
+
+    physics_command_t command = {0};
+    command.type = COMMAND_ADD_BOX;
+    command.handle = handle;
+    command.mass = mass;
+    glm_vec3_copy(pos, command.a);
+    glm_vec3_copy(size, command.b);
+
+    if (command_push(thread, &command) != 0) {
+        thread->free_handles[thread->free_count++] = handle;
+
+        return PHYSICS_INVALID_HANDLE;
+    }
+
+    thread->live[handle] = 1;
+
+    return handle;
+}
+
+int physics_thread_remove_body(physics_thread_t* thread, unsigned int handle) {
+    // A second remove would put the handle on the free list twice
+    if (handle >= thread->max_handles || !thread->live[handle]) {
+        return -1;
+    }
+
+    physics_command_t command = {0};
+    command.type = COMMAND_REMOVE;
+    command.handle = handle;
+
+    if (command_push(thread, &command) != 0) {
+        return -1;
+    }
+
+    // Commands run in order, so a later add with this handle lands after the removal
+    thread->live[handle] = 0;
+    thread->free_handles[thread->free_count++] = handle;
+
+    return 0;
+}
+
+static int push_vector_command(physics_thread_t* thread, physics_command_type_t type, unsigned int handle, vec3 value) {
+    if (handle >= thread->max_handles || !thread->live[handle]) {
+        return -1;
+    }
+
+    physics_command_t command = {0};
+    command.type = type;
+    command.handle = handle;
+    glm_vec3_copy(value, command.a);
+
+    return command_push(thread, &command);
+}
+
+int physics_thread_apply_force(physics_thread_t* thread, unsigned int handle, vec3 force) {
+    return push_vector_command(thread, COMMAND_FORCE, handle, force);
+}
+
+int physics_thread_apply_impulse(physics_thread_t* thread, unsigned int handle, vec3 impulse) {
+    return push_vector_command(thread, COMMAND_IMPULSE, handle, impulse);
+}
+
+int physics_thread_set_lod_focus(physics_thread_t* thread, vec3 focus) {
+    // Not tied to a body, so no handle check
+    physics_command_t command = {0};
+    command.type = COMMAND_LOD_FOCUS;
+    glm_vec3_copy(focus, command.a);
+
+    return command_push(thread, &command);
+}
+
+const physics_frame_t* physics_thread_acquire(physics_thread_t* thread) {
+    if (atomic_load_explicit(&thread->shared, memory_order_relaxed) & FRAME_FRESH) {
+        unsigned int old = atomic_exchange_explicit(&thread->shared, thread->front, memory_order_acq_rel);
+        thread->front = old & 3u;
+    }
+
+    return &thread->frames[thread->front];
+}
+
+void physics_frame_get_matrix(const physics_frame_t* frame, unsigned int handle, mat4 model) {
+    if (handle >= frame->handle_count) {
+        glm_mat4_identity(model);
+        return;
+    }
+
+    mat4 previous;
+    mat4 current;
+    memcpy(previous, frame->previous + (size_t)handle * 16, sizeof(mat4));
+    memcpy(current, frame->current + (size_t)handle * 16, sizeof(mat4));
+
+    // Render one tick behind and blend towards the newest state
+    float alpha = frame->tick_length > 0.0f ? (float)((now_seconds() - frame->time) / frame->tick_length) : 1.0f;
+    alpha = glm_clamp(alpha, 0.0f, 1.0f);
+
+    versor q0;
+    versor q1;
+    versor q;
+    glm_mat4_quat(previous, q0);
+    glm_mat4_quat(current, q1);
+    glm_quat_slerp(q0, q1, alpha, q);
+    glm_quat_mat4(q, model);
+
+    glm_vec3_lerp(previous[3], current[3], alpha, model[3]);
+}
+
+void physics_thread_destroy(physics_thread_t* thread) {
+    if (!thread) {
+        return;
+    }
+
+    if (thread->started) {
+        atomic_store(&thread->running, 0);
+        pthread_join(thread->thread, NULL);
+    }
+
+    free(thread->commands);
+    free(thread->bodies);
+    free(thread->fresh);
+    free(thread->live);
+    free(thread->free_handles);
+    free(thread->slot_matrices);
+    free(thread->last_matrices);
+
+    for (int i = 0; i < 3; i++) {
+        free(thread->frames[i].current);
+        free(thread->frames[i].previous);
+    }
+
+    free(thread);
+}
@@ -0,0 +1,133 @@
+#ifndef PHYSICS_THREAD_H
+#define PHYSICS_THREAD_H
+
+#include "physics.h"
+#include <cglm/cglm.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PHYSICS_INVALID_HANDLE 0xFFFFFFFFu
+
+typedef struct physics_thread_t physics_thread_t;
+
+typedef struct {
+    float* current;            // 16 floats per handle, column-major
+    float* previous;           // Same layout, one tick earlier
+    unsigned int handle_count; // Handles below this are valid indices
+    unsigned long long tick;
+    double time;               // Monotonic seconds when the tick was published
+    float tick_length;         // Seconds per tick
+    float step_ms;             // Simulation time of the last tick
+} physics_frame_t;
+
+/**
+    * Create a simulation thread that owns a physics world
+    * The world must not be touched by other threads until physics_thread_destroy()
+    * @param world Physics world, may already contain bodies
+    * @param tick_rate Ticks per second, also set as the world's fixed timestep
+    * @param max_handles Max bodies alive through the thread at once
+    * @param command_capacity Command queue size, rounded up to a power of two
+    * @return Thread or NULL on failure
+**/
+
+physics_thread_t* physics_thread_create(physics_world_t* world, float tick_rate, unsigned int max_handles, unsigned int command_capacity);
+
+/**
+    * Hand an existing body to the thread before it is started
+    * @param thread Physics thread
+    * @param body Rigid body already in the world
+    * @return Body handle or PHYSICS_INVALID_HANDLE
+**/
+
+unsigned int physics_thread_adopt(physics_thread_t* thread, btRigidBody* body);
+
+/**
+    * Start ticking at the fixed rate
+    * @param thread Physics thread
+    * @return 0 on success, -1 on failure
+**/
+
+int physics_thread_start(physics_thread_t* thread);
+
+/**
+    * Queue a box creation, the handle is usable immediately
+    * Single producer: call from one game thread only
+    * @param thread Physics thread
+    * @param pos Initial position
+    * @param size Box dimensions
+    * @param mass Mass: 0 for static objects
+    * @return Body handle or PHYSICS_INVALID_HANDLE when out of handles or the queue is full
+**/
+
+unsigned int physics_thread_add_box(physics_thread_t* thread, vec3 pos, vec3 size, float mass);
+
+/**
+    * Queue a body removal, the handle may be reused right away
+    * @param thread Physics thread
+    * @param handle Body handle
+    * @return 0 on success, -1 for a handle not in use or when the queue is full
+**/
+
+int physics_thread_remove_body(physics_thread_t* thread, unsigned int handle);
+
+/**
+    * Queue a force through the center of mass for the next tick
+    * @param thread Physics thread
+    * @param handle Body handle
+    * @param force Force in newtons
+    * @return 0 on success, -1 for a handle not in use or when the queue is full
+**/
+
+int physics_thread_apply_force(physics_thread_t* thread, unsigned int handle, vec3 force);
+
+/**
+    * Queue an impulse through the center of mass
+    * @param thread Physics thread
+    * @param handle Body handle
+    * @param impulse Impulse in newton seconds
+    * @return 0 on success, -1 for a handle not in use or when the queue is full
+**/
+
+int physics_thread_apply_impulse(physics_thread_t* thread, unsigned int handle, vec3 impulse);
+
+/**
+    * Queue a new physics LOD focus, see physics_lod_set_focus()
+    * @param thread Physics thread
+    * @param focus World position, usually the camera
+    * @return 0 on success, -1 when the queue is full
+**/
+
+int physics_thread_set_lod_focus(physics_thread_t* thread, vec3 focus);
+
+/**
+    * Get the newest published transforms without blocking
+    * The frame stays valid until the next call from the same reader thread
+    * @param thread Physics thread
+    * @return Latest frame
+**/
+
+const physics_frame_t* physics_thread_acquire(physics_thread_t* thread);
+
+/**
+    * Get a body's model matrix blended between the frame's last two ticks
+    * @param frame Frame from physics_thread_acquire()
+    * @param handle Body handle
+    * @param model Output model matrix, identity for unknown handles
+**/
+
+void physics_frame_get_matrix(const physics_frame_t* frame, unsigned int handle, mat4 model);
+
+/**
+    * Stop and join the thread, the world belongs to the caller again
+    * @param thread Physics thread to destroy
+**/
+
+void physics_thread_destroy(physics_thread_t* thread);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PHYSICS_THREAD_H
@@ -0,0 +1,595 @@
+#include "bvh.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+#include <math.h>
+
+#define BVH_BINS 16
+#define BVH_LEAF_SIZE 4
+#define BVH_TRAVERSAL_COST 1.0f
+// Past this depth splits fall back to median so traversal stacks stay bounded
+#define BVH_SAH_MAX_DEPTH 64
+#define BVH_STACK_SIZE 128
+// Rebuild once refits made the tree this much worse, or after this many refits
+#define BVH_REBUILD_RATIO 1.5f
+#define BVH_REBUILD_INTERVAL 240
+
+static float box_area(const vec3 min, const vec3 max) {
+    float dx = max[0] - min[0];
+    float dy = max[1] - min[1];
+    float dz = max[2] - min[2];
+
+    if (dx < 0.0f || dy < 0.0f || dz < 0.0f) {
+        return 0.0f;
+    }
+
+    return 2.0f * (dx * dy + dy * dz + dz * dx);
+}
+
+static void box_empty(vec3 min, vec3 max) {
+    min[0] = min[1] = min[2] = FLT_MAX;
+    max[0] = max[1] = max[2] = -FLT_MAX;
+}
+
+// Plain compares instead of fminf/fmaxf: no NaN handling, so they compile to minss/maxss
+static float min_f(float a, float b) {
+    return a < b ? a : b;
+}
+
+static float max_f(float a, float b) {
+    return a > b ? a : b;
+}
+
+static void box_grow(vec3 min, vec3 max, const vec3 other_min, const vec3 other_max) {
+    for (int i = 0; i < 3; i++) {
+        min[i] = min_f(min[i], other_min[i]);
+        max[i] = max_f(max[i], other_max[i]);
+    }
+}
+
+bvh_t bvh_create(void) {
+    bvh_t bvh = {0};
+
+    return bvh;
+}
+
+int bvh_insert(bvh_t* bvh, vec3 min, vec3 max, unsigned int user_id) {
+    unsigned int index;
+
+    if (bvh->free_count > 0) {
+        index = bvh->free_items[--bvh->free_count];
+    } else {
+        if (bvh->item_count == bvh->item_capacity) {
+            unsigned int new_capacity = bvh->item_capacity ? bvh->item_capacity * 2 : 64;
+
+            bvh_item_t* items = realloc(bvh->items, sizeof(bvh_item_t) * new_capacity);
+            unsigned int* order = realloc(bvh->item_order, sizeof(unsigned int) * new_capacity);
+            unsigned int* free_items = realloc(bvh->free_items, sizeof(unsigned int) * new_capacity);
+
+            if (items) bvh->items = items;
+            if (order) bvh->item_order = order;
+            if (free_items) bvh->free_items = free_items;
+
+            if (!items || !order || !free_items) {
+                fprintf(stderr, "Failed to allocate mem for BVH items\n");
+
+                return -1;
+            }
+
+            bvh->item_capacity = new_capacity;
+        }
+
+        index = bvh->item_count++;
+    }
+
+    bvh_item_t* item = &bvh->items[index];
+
+    glm_vec3_copy(min, item->min);
+    glm_vec3_copy(max, item->max);
+    item->user_id = user_id;
+    item->active = 1;
+
+    bvh->dirty = 1;
+
+    return (int)index;
+}
+
+void bvh_update(bvh_t* bvh, int item, vec3 min, vec3 max) {
+    if (item < 0 || (unsigned int)item >= bvh->item_count) {
+        return;
+    }
+
+    glm_vec3_copy(min, bvh->items[item].min);
+    glm_vec3_copy(max, bvh->items[item].max);
+}
+
+void bvh_remove(bvh_t* bvh, int item) {
+    if (item < 0 || (unsigned int)item >= bvh->item_count || !bvh->items[item].active) {
+        return;
+    }
+
+    bvh->items[item].active = 0;
+    bvh->free_items[bvh->free_count++] = (unsigned int)item;
+    bvh->dirty = 1;
+}
+
+/**
+    * Helper func to get the normalized SAH cost of the current tree
+**/
+
+static float tree_cost(const bvh_t* bvh) {
+    if (bvh->node_count == 0) {
+        return 0.0f;
+    }
+
+    float root_area = box_area(bvh->nodes[0].min, bvh->nodes[0].max);
+
+    if (root_area <= 0.0f) {
+        return 0.0f;
+    }
+
+    float cost = 0.0f;
+
+    for (unsigned int i = 0; i < bvh->node_count; i++) {
+        const bvh_node_t* node = &bvh->nodes[i];
+        float area = box_area(node->min, node->max);
+
+        cost += node->count ? area * (float)node->count : area * BVH_TRAVERSAL_COST;
+    }
+
+    return cost / root_area;
+}
+
+static float item_centroid(const bvh_item_t* item, int axis) {
+    return (item->min[axis] + item->max[axis]) * 0.5f;
+}
+
+static void make_leaf(bvh_node_t* node, unsigned int first, unsigned int count) {
+    node->left = -1;
+    node->right = -1;
+    node->first = first;
+    node->count = count;
+}
+
+static void build_node(bvh_t* bvh, unsigned int node_index, unsigned int first, unsigned int count, int depth) {
+    bvh_node_t* node = &bvh->nodes[node_index];
+    vec3 centroid_min, centroid_max;
+
+    box_empty(node->min, node->max);
+    box_empty(centroid_min, centroid_max);
+
+    for (unsigned int i = first; i < first + count; i++) {
+        const bvh_item_t* item = &bvh->items[bvh->item_order[i]];
+
+        box_grow(node->min, node->max, item->min, item->max);
+
+        for (int axis = 0; axis < 3; axis++) {
+            float c = item_centroid(item, axis);
+
+            centroid_min[axis] = min_f(centroid_min[axis], c);
+            centroid_max[axis] = max_f(centroid_max[axis], c);
+        }
+    }
+
+    if (count <= BVH_LEAF_SIZE) {
+        make_leaf(node, first, count);
+
+        return;
+    }
+
+    int best_axis = -1;
+    int best_split = 0;
+    float best_cost = FLT_MAX;
+
+    if (depth < BVH_SAH_MAX_DEPTH) {
+        unsigned int bin_count[3][BVH_BINS] = {{0}};
+        vec3 bin_min[3][BVH_BINS], bin_max[3][BVH_BINS];
+        vec3 scale;
+
+        for (int axis = 0; axis < 3; axis++) {
+            float extent = centroid_max[axis] - centroid_min[axis];
+
+            scale[axis] = extent > 1e-6f ? (float)BVH_BINS / extent : 0.0f;
+
+            for (int b = 0; b < BVH_BINS; b++) {
+                box_empty(bin_min[axis][b], bin_max[axis][b]);
+            }
+        }
+
+        // Bin all three axes in a single pass over the items
+        for (unsigned int i = first; i < first + count; i++) {
+            const bvh_item_t* item = &bvh->items[bvh->item_order[i]];
+
+            for (int axis = 0; axis < 3; axis++) {
+                int b = (int)((item_centroid(item, axis) - centroid_min[axis]) * scale[axis]);
+
+                if (b >= BVH_BINS) b = BVH_BINS - 1;
+
+                bin_count[axis][b]++;
+                box_grow(bin_min[axis][b], bin_max[axis][b], item->min, item->max);
+            }
+        }
+
+        for (int axis = 0; axis < 3; axis++) {
+            if (scale[axis] == 0.0f) {
+                continue;
+            }
+
+            // Sweep from the right to get suffix areas, then evaluate splits from the left
+            float right_area[BVH_BINS];
+            unsigned int right_count[BVH_BINS];
+            vec3 acc_min, acc_max;
+            unsigned int acc_count = 0;
+
+            box_empty(acc_min, acc_max);
+
+            for (int b = BVH_BINS - 1; b > 0; b--) {
+                box_grow(acc_min, acc_max, bin_min[axis][b], bin_max[axis][b]);
+                acc_count += bin_count[axis][b];
+                right_area[b] = box_area(acc_min, acc_max);
+                right_count[b] = acc_count;
+            }
+
+            box_empty(acc_min, acc_max);
+            acc_count = 0;
+
+            for (int b = 0; b < BVH_BINS - 1; b++) {
+                box_grow(acc_min, acc_max, bin_min[axis][b], bin_max[axis][b]);
+                acc_count += bin_count[axis][b];
+
+                if (acc_count == 0 || right_count[b + 1] == 0) {
+                    continue;
+                }
+
+                float cost = box_area(acc_min, acc_max) * (float)acc_count + right_area[b + 1] * (float)right_count[b + 1];
+
+                if (cost < best_cost) {
+                    best_cost = cost;
+                    best_axis = axis;
+                    best_split = b;
+                }
+            }
+        }
+    }
+
+    unsigned int mid = first + count / 2;
+
+    if (best_axis >= 0) {
+        float scale = (float)BVH_BINS / (centroid_max[best_axis] - centroid_min[best_axis]);
+        unsigned int* order = bvh->item_order;
+        unsigned int i = first;
+        unsigned int j = first + count;
+
+        // Partition in place: items in bins <= best_split go left
+        while (i < j) {
+            int b = (int)((item_centroid(&bvh->items[order[i]], best_axis) - centroid_min[best_axis]) * scale);
+
+            if (b >= BVH_BINS) b = BVH_BINS - 1;
+
+            if (b <= best_split) {
+                i++;
+            } else {
+                unsigned int tmp = order[i];
+                order[i] = order[--j];
+                order[j] = tmp;
+            }
+        }
+
+        if (i != first && i != first + count) {
+            mid = i;
+        }
+    }
+
+    // Children are allocated after their parent, so a reverse sweep refits bottom-up
+    int left = (int)bvh->node_count;
+    int right = left + 1;
+    bvh->node_count += 2;
+
+    node->left = left;
+    node->right = right;
+    node->first = 0;
+    node->count = 0;
+
+    build_node(bvh, (unsigned int)left, first, mid - first, depth + 1);
+    build_node(bvh, (unsigned int)right, mid, first + count - mid, depth + 1);
+}
+
+void bvh_build(bvh_t* bvh) {
+    unsigned int active = 0;
+
+    for (unsigned int i = 0; i < bvh->item_count; i++) {
+        if (bvh->items[i].active) {
+            bvh->item_order[active++] = i;
+        }
+    }
+
+    bvh->node_count = 0;
+    bvh->dirty = 0;
+    bvh->refits_since_build = 0;
+
+    if (active == 0) {
+        bvh->build_cost = bvh->cost = 0.0f;
+
+        return;
+    }
+
+    unsigned int needed = active * 2 - 1;
+
+    if (needed > bvh->node_capacity) {
+        bvh_node_t* nodes = realloc(bvh->nodes, sizeof(bvh_node_t) * needed);
+
+        if (!nodes) {
+            fprintf(stderr, "Failed to allocate mem for BVH nodes\n");
+
+            return;
+        }
+
+        bvh->nodes = nodes;
+        bvh->node_capacity = needed;
+    }
+
+    bvh->node_count = 1;
+    build_node(bvh, 0, 0, active, 0);
+
+    bvh->build_cost = bvh->cost = tree_cost(bvh);
+}
+
+void bvh_refit(bvh_t* bvh) {
+    if (bvh->dirty || bvh->node_count == 0) {
+        bvh_build(bvh);
+
+        return;
+    }
+
+    for (int i = (int)bvh->node_count - 1; i >= 0; i--) {
+        bvh_node_t* node = &bvh->nodes[i];
+
+        box_empty(node->min, node->max);
+
+        if (node->count > 0) {
+            for (unsigned int k = node->first; k < node->first + node->count; k++) {
+                const bvh_item_t* item = &bvh->items[bvh->item_order[k]];
+
+                box_grow(node->min, node->max, item->min, item->max);
+            }
+        } else {
+            box_grow(node->min, node->max, bvh->nodes[node->left].min, bvh->nodes[node->left].max);
+            box_grow(node->min, node->max, bvh->nodes[node->right].min, bvh->nodes[node->right].max);
+        }
+    }
+
+    bvh->cost = tree_cost(bvh);
+    bvh->refits_since_build++;
+
+    if (bvh->cost > bvh->build_cost * BVH_REBUILD_RATIO || bvh->refits_since_build >= BVH_REBUILD_INTERVAL) {
+        bvh_build(bvh);
+    }
+}
+
+/**
+    * Helper func to classify a box against the frustum
+    * @return 0 outside, 1 intersecting, 2 fully inside
+**/
+
+static int frustum_classify(vec4 planes[6], const vec3 min, const vec3 max) {
+    int inside = 2;
+
+    for (int i = 0; i < 6; i++) {
+        const float* p = planes[i];
+
+        // Positive vertex: corner furthest along the plane normal
+        float px = p[0] > 0.0f ? max[0] : min[0];
+        float py = p[1] > 0.0f ? max[1] : min[1];
+        float pz = p[2] > 0.0f ? max[2] : min[2];
+
+        if (p[0] * px + p[1] * py + p[2] * pz + p[3] < 0.0f) {
+            return 0;
+        }
+
+        float nx = p[0] > 0.0f ? min[0] : max[0];
+        float ny = p[1] > 0.0f ? min[1] : max[1];
+        float nz = p[2] > 0.0f ? min[2] : max[2];
+
+        if (p[0] * nx + p[1] * ny + p[2] * nz + p[3] < 0.0f) {
+            inside = 1;
+        }
+    }
+
+    return inside;
+}
+
+static unsigned int emit_subtree(const bvh_t* bvh, int root, unsigned int* out_ids, unsigned int count, unsigned int max_ids) {
+    int stack[BVH_STACK_SIZE];
+    int sp = 0;
+
+    stack[sp++] = root;
+
+    while (sp > 0 && count < max_ids) {
+        const bvh_node_t* node = &bvh->nodes[stack[--sp]];
+
+        if (node->count > 0) {
+            for (unsigned int k = node->first; k < node->first + node->count && count < max_ids; k++) {
+                const bvh_item_t* item = &bvh->items[bvh->item_order[k]];
+
+                if (item->active) {
+                    out_ids[count++] = item->user_id;
+                }
+            }
+        } else {
+            stack[sp++] = node->left;
+            stack[sp++] = node->right;
+        }
+    }
+
+    return count;
+}
+
+unsigned int bvh_query_frustum(const bvh_t* bvh, vec4 planes[6], unsigned int* out_ids, unsigned int max_ids) {
+    if (bvh->node_count == 0) {
+        return 0;
+    }
+
+    int stack[BVH_STACK_SIZE];
+    int sp = 0;
+    unsigned int count = 0;
+
+    stack[sp++] = 0;
+
+    while (sp > 0 && count < max_ids) {
+        int index = stack[--sp];
+        const bvh_node_t* node = &bvh->nodes[index];
+        int result = frustum_classify(planes, node->min, node->max);
+
+        if (result == 0) {
+            continue;
+        }
+
+        // Whole subtree inside: no more plane tests needed
+        if (result == 2) {
+            count = emit_subtree(bvh, index, out_ids, count, max_ids);
+            continue;
+        }
+
+        if (node->count > 0) {
+            for (unsigned int k = node->first; k < node->first + node->count && count < max_ids; k++) {
+                const bvh_item_t* item = &bvh->items[bvh->item_order[k]];
+
+                if (item->active && frustum_classify(planes, item->min, item->max) != 0) {
+                    out_ids[count++] = item->user_id;
+                }
+            }
+        } else {
+            stack[sp++] = node->left;
+            stack[sp++] = node->right;
+        }
+    }
+
+    return count;
+}
+
+/**
+    * Helper func for the slab test
+    * @return Entry distance, or FLT_MAX on a miss
+**/
+
+static float ray_box(const vec3 origin, const vec3 inv_dir, float max_t, const vec3 min, const vec3 max) {
+    float t_near = 0.0f;
+    float t_far = max_t;
+
+    for (int i = 0; i < 3; i++) {
+        float t0 = (min[i] - origin[i]) * inv_dir[i];
+        float t1 = (max[i] - origin[i]) * inv_dir[i];
+
+        t_near = fmaxf(t_near, fminf(t0, t1));
+        t_far = fminf(t_far, fmaxf(t0, t1));
+    }
+
+    return t_near <= t_far ? t_near : FLT_MAX;
+}
+
+unsigned int bvh_query_ray(const bvh_t* bvh, vec3 origin, vec3 dir, float max_t, unsigned int* out_ids, unsigned int max_ids) {
+    if (bvh->node_count == 0) {
+        return 0;
+    }
+
+    vec3 inv_dir = {1.0f / dir[0], 1.0f / dir[1], 1.0f / dir[2]};
+    int stack[BVH_STACK_SIZE];
+    int sp = 0;
+    unsigned int count = 0;
+
+    if (ray_box(origin, inv_dir, max_t, bvh->nodes[0].min, bvh->nodes[0].max) == FLT_MAX) {
+        return 0;
+    }
+
+    stack[sp++] = 0;
+
+    while (sp > 0 && count < max_ids) {
+        const bvh_node_t* node = &bvh->nodes[stack[--sp]];
+
+        if (node->count > 0) {
+            for (unsigned int k = node->first; k < node->first + node->count && count < max_ids; k++) {
+                const bvh_item_t* item = &bvh->items[bvh->item_order[k]];
+
+                if (item->active && ray_box(origin, inv_dir, max_t, item->min, item->max) != FLT_MAX) {
+                    out_ids[count++] = item->user_id;
+                }
+            }
+
+            continue;
+        }
+
+        const bvh_node_t* left = &bvh->nodes[node->left];
+        const bvh_node_t* right = &bvh->nodes[node->right];
+        float t_left = ray_box(origin, inv_dir, max_t, left->min, left->max);
+        float t_right = ray_box(origin, inv_dir, max_t, right->min, right->max);
+
+        // Push the far child first so the near one is visited first
+        if (t_left <= t_right) {
+            if (t_right != FLT_MAX) stack[sp++] = node->right;
+            if (t_left != FLT_MAX) stack[sp++] = node->left;
+        } else {
+            if (t_left != FLT_MAX) stack[sp++] = node->left;
+            if (t_right != FLT_MAX) stack[sp++] = node->right;
+        }
+    }
+
+    return count;
+}
+
+static int sphere_box(const vec3 center, float radius_sq, const vec3 min, const vec3 max) {
+    float dist_sq = 0.0f;
+
+    for (int i = 0; i < 3; i++) {
+        float v = fmaxf(min[i], fminf(center[i], max[i])) - center[i];
+
+        dist_sq += v * v;
+    }
+
+    return dist_sq <= radius_sq;
+}
+
+unsigned int bvh_query_sphere(const bvh_t* bvh, vec3 center, float radius, unsigned int* out_ids, unsigned int max_ids) {
+    if (bvh->node_count == 0) {
+        return 0;
+    }
+
+    float radius_sq = radius * radius;
+    int stack[BVH_STACK_SIZE];
+    int sp = 0;
+    unsigned int count = 0;
+
+    stack[sp++] = 0;
+
+    while (sp > 0 && count < max_ids) {
+        const bvh_node_t* node = &bvh->nodes[stack[--sp]];
+
+        if (!sphere_box(center, radius_sq, node->min, node->max)) {
+            continue;
+        }
+
+        if (node->count > 0) {
+            for (unsigned int k = node->first; k < node->first + node->count && count < max_ids; k++) {
+                const bvh_item_t* item = &bvh->items[bvh->item_order[k]];
+
+                if (item->active && sphere_box(center, radius_sq, item->min, item->max)) {
+                    out_ids[count++] = item->user_id;
+                }
+            }
+        } else {
+            stack[sp++] = node->left;
+            stack[sp++] = node->right;
+        }
+    }
+
+    return count;
+}
+
+void bvh_destroy(bvh_t* bvh) {
+    free(bvh->nodes);
+    free(bvh->items);
+    free(bvh->item_order);
+    free(bvh->free_items);
+
+    *bvh = (bvh_t){0};
+}
@@ -0,0 +1,138 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include <cglm/cglm.h>
+
+typedef struct {
+    vec3 min;
+    vec3 max;
+    int left;           // Child indices, -1 for leaves
+    int right;
+    unsigned int first; // Leaf range in item_order
+    unsigned int count; // 0 for inner nodes
+} bvh_node_t;
+
+typedef struct {
+    vec3 min;
+    vec3 max;
+    unsigned int user_id;
+    int active;
+} bvh_item_t;
+
+typedef struct {
+    bvh_node_t* nodes;
+    unsigned int node_count;
+    unsigned int node_capacity;
+
+    bvh_item_t* items;
+    unsigned int item_count;
+    unsigned int item_capacity;
+
+    unsigned int* item_order; // Items sorted by leaf
+    unsigned int* free_items;
+    unsigned int free_count;
+
+    float build_cost; // SAH cost right after the last build
+    float cost;       // SAH cost after the last refit
+    unsigned int refits_since_build;
+    int dirty;        // Items added or removed since the last build
+} bvh_t;
+
+/**
+    * Create an empty bounding volume hierarchy
+    * Use one tree for static objects (bvh_build once) and one for
+    * dynamic objects (bvh_refit every frame)
+    * @return Empty BVH
+**/
+
+bvh_t bvh_create(void);
+
+/**
+    * Add an item to the tree, takes effect on the next build or refit
+    * @param bvh BVH
+    * @param min World AABB min
+    * @param max World AABB max
+    * @param user_id Value reported by queries
+    * @return Item handle or -1 on failure
+**/
+
+int bvh_insert(bvh_t* bvh, vec3 min, vec3 max, unsigned int user_id);
+
+/**
+    * Move an item, takes effect on the next refit
+    * @param bvh BVH
+    * @param item Item handle
+    * @param min New world AABB min
+    * @param max New world AABB max
+**/
+
+void bvh_update(bvh_t* bvh, int item, vec3 min, vec3 max);
+
+/**
+    * Remove an item, its handle may be reused by later inserts
+    * @param bvh BVH
+    * @param item Item handle
+**/
+
+void bvh_remove(bvh_t* bvh, int item);
+
+/**
+    * Rebuild the whole tree top-down with binned SAH
+    * @param bvh BVH
+**/
+
+void bvh_build(bvh_t* bvh);
+
+/**
+    * Refit node bounds bottom-up after items moved
+    * Falls back to a full rebuild when items were added or removed,
+    * when the SAH cost degraded too far or periodically
+    * @param bvh BVH
+**/
+
+void bvh_refit(bvh_t* bvh);
+
+/**
+    * Find items whose AABB intersects a frustum
+    * @param bvh BVH
+    * @param planes Frustum planes from glm_frustum_planes()
+    * @param out_ids Output user IDs
+    * @param max_ids Capacity of out_ids
+    * @return Number of user IDs written
+**/
+
+unsigned int bvh_query_frustum(const bvh_t* bvh, vec4 planes[6], unsigned int* out_ids, unsigned int max_ids);
+
+/**
+    * Find items whose AABB is hit by a ray, roughly front to back
+    * @param bvh BVH
+    * @param origin Ray origin
+    * @param dir Ray direction, need not be normalized
+    * @param max_t Max distance in units of dir
+    * @param out_ids Output user IDs
+    * @param max_ids Capacity of out_ids
+    * @return Number of user IDs written
+**/
+
+unsigned int bvh_query_ray(const bvh_t* bvh, vec3 origin, vec3 dir, float max_t, unsigned int* out_ids, unsigned int max_ids);
+
+/**
+    * Find items whose AABB intersects a sphere
+    * @param bvh BVH
+    * @param center Sphere center
+    * @param radius Sphere radius
+    * @param out_ids Output user IDs
+    * @param max_ids Capacity of out_ids
+    * @return Number of user IDs written
+**/
+
+unsigned int bvh_query_sphere(const bvh_t* bvh, vec3 center, float radius, unsigned int* out_ids, unsigned int max_ids);
+
+/**
+    * Free BVH memory
+    * @param bvh BVH to destroy
+**/
+
+void bvh_destroy(bvh_t* bvh);
+
+#endif // BVH_H
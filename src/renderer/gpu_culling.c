@@ -0,0 +1,491 @@
+#define GL_GLEXT_PROTOTYPES
+#include "gpu_culling.h"
+#include "renderer.h"
+#include "shader.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <GL/gl.h>
+#include <GL/glext.h>
+
+// Model textures use units 0-2
+#define INSTANCE_TEXTURE_UNIT 3
+#define INSTANCE_ATTRIBUTE 3
+
+// Layout fixed by GL_ARB_draw_indirect
+typedef struct {
+    GLuint count;
+    GLuint instance_count;
+    GLuint first_index;
+    GLint base_vertex;
+    GLuint base_instance; // Must be 0 before GL 4.2
+} draw_command_t;
+
+// One point per instance, survivors are emitted by the geometry stage
+static const char* cull_vert_src =
+    "#version 410 core\n"
+    "uniform samplerBuffer instances;\n"
+    "uniform vec4 planes[6];\n"
+    "uniform vec4 sphere;\n"
+    "flat out uint vInstance;\n"
+    "flat out int vVisible;\n"
+    "void main() {\n"
+    "    int base = gl_VertexID * 4;\n"
+    "    mat4 m = mat4(texelFetch(instances, base), texelFetch(instances, base + 1),\n"
+    "                  texelFetch(instances, base + 2), texelFetch(instances, base + 3));\n"
+    "    vec3 center = (m * vec4(sphere.xyz, 1.0)).xyz;\n"
+    "    float scale = max(max(dot(m[0].xyz, m[0].xyz), dot(m[1].xyz, m[1].xyz)), dot(m[2].xyz, m[2].xyz));\n"
+    "    float radius = sphere.w * sqrt(scale);\n"
+    "    int visible = 1;\n"
+    "    for (int i = 0; i < 6; i++) {\n"
+    "        if (dot(planes[i].xyz, center) + planes[i].w < -radius) visible = 0;\n"
+    "    }\n"
+    "    vInstance = uint(gl_VertexID);\n"
+    "    vVisible = visible;\n"
+    "}\n";
+
+static const char* cull_geom_src =
+    "#version 410 core\n"
+    "layout (points) in;\n"
+    "layout (points, max_vertices = 1) out;\n"
+    "flat in uint vInstance[];\n"
+    "flat in int vVisible[];\n"
+    "flat out uint visibleInstance;\n"
+    "void main() {\n"
+    "    if (vVisible[0] != 0) {\n"
+    "        visibleInstance = vInstance[0];\n"
+    "        EmitVertex();\n"
+    "        EndPrimitive();\n"
+    "    }\n"
+    "}\n";
+
+static const char* draw_vert_src =
+    "#version 410 core\n"
+    "layout (location = 0) in vec3 aPos;\n"
+    "layout (location = 1) in vec3 aNormal;\n"
+    "layout (location = 2) in vec2 aTexCoord;\n"
+    "layout (location = 3) in uint aInstance;\n"
+    "uniform samplerBuffer instances;\n"
+    "uniform mat4 view;\n"
+    "uniform mat4 projection;\n"
+    "out vec3 Normal;\n"
+    "out vec2 TexCoord;\n"
+    "void main() {\n"
+    "    int base = int(aInstance) * 4;\n"
+    "    mat4 model = mat4(texelFetch(instances, base), texelFetch(instances, base + 1),\n"
+    "                      texelFetch(instances, base + 2), texelFetch(instances, base + 3));\n"
+    "    Normal = mat3(model) * aNormal;\n"
+    "    TexCoord = aTexCoord;\n"
+    "    gl_Position = projection * view * model * vec4(aPos, 1.0);\n"
+    "}\n";
+
+static const char* draw_frag_src =
+    "#version 410 core\n"
+    "in vec3 Normal;\n"
+    "in vec2 TexCoord;\n"
+    "uniform sampler2D diffuse_texture;\n"
+    "uniform int has_diffuse;\n"
+    "out vec4 FragColor;\n"
+    "void main() {\n"
+    "    vec3 albedo = has_diffuse != 0 ? texture(diffuse_texture, TexCoord).rgb : vec3(0.8);\n"
+    "    float light = max(dot(normalize(Normal), normalize(vec3(0.4, 1.0, 0.3))), 0.0);\n"
+    "    FragColor = vec4(albedo * (0.25 + 0.75 * light), 1.0);\n"
+    "}\n";
+
+static unsigned int cull_shader = 0;
+static unsigned int draw_shader = 0;
+static unsigned int empty_vao = 0;
+static int planes_location = -1;
+static int sphere_location = -1;
+static int has_query_buffer = 0;
+static int has_multi_draw = 0;
+static GLint max_texture_buffer_size = 0;
+
+int gpu_culling_init(void) {
+    const char* varyings[] = { "visibleInstance" };
+
+    cull_shader = shader_create_feedback(cull_vert_src, cull_geom_src, varyings, 1);
+    draw_shader = shader_create_from_source(draw_vert_src, draw_frag_src);
+
+    if (cull_shader == 0 || draw_shader == 0) {
+        fprintf(stderr, "Failed to create GPU culling shaders\n");
+        gpu_culling_shutdown();
+
+        return -1;
+    }
+
+    planes_location = glGetUniformLocation(cull_shader, "planes");
+    sphere_location = glGetUniformLocation(cull_shader, "sphere");
+
+    shader_use(cull_shader);
+    shader_set_int(cull_shader, "instances", INSTANCE_TEXTURE_UNIT);
+    shader_use(draw_shader);
+    shader_set_int(draw_shader, "instances", INSTANCE_TEXTURE_UNIT);
+    shader_set_int(draw_shader, "diffuse_texture", 0);
+    glUseProgram(0);
+
+    // Core profile needs a bound VAO even for attribute-less draws
+    glGenVertexArrays(1, &empty_vao);
+
+    GLint major = 0;
+    GLint minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &max_texture_buffer_size);
+
+    has_query_buffer = renderer_has_extension("GL_ARB_query_buffer_object");
+    has_multi_draw = major > 4 || (major == 4 && minor >= 3) || renderer_has_extension("GL_ARB_multi_draw_indirect");
+
+    printf("GPU culling initialized | query buffer: %s | multi-draw: %s\n",
+           has_query_buffer ? "yes" : "no", has_multi_draw ? "yes" : "no");
+
+    return 0;
+}
+
+gpu_batch_t gpu_batch_create(model_t model, unsigned int capacity) {
+    gpu_batch_t batch = {0};
+
+    if (cull_shader == 0 || model.mesh_count == 0 || capacity == 0) {
+        return batch;
+    }
+
+    if ((GLint64)capacity * 4 > max_texture_buffer_size) {
+        capacity = (unsigned int)(max_texture_buffer_size / 4);
+        printf("Warning: GPU batch capacity clamped to %u instances\n", capacity);
+    }
+
+    batch.meshes = malloc(sizeof(gpu_batch_mesh_t) * model.mesh_count);
+
+    if (!batch.meshes) {
+        fprintf(stderr, "Failed to allocate GPU batch meshes\n");
+
+        return batch;
+    }
+
+    batch.mesh_count = model.mesh_count;
+    batch.shared_texture = 1;
+
+    // Size the merged buffers
+    GLint64 vertex_bytes = 0;
+    GLint64 index_bytes = 0;
+
+    for (unsigned int i = 0; i < model.mesh_count; i++) {
+        GLint size = 0;
+
+        glBindBuffer(GL_COPY_READ_BUFFER, model.meshes[i].vbo);
+        glGetBufferParameteriv(GL_COPY_READ_BUFFER, GL_BUFFER_SIZE, &size);
+
+        batch.meshes[i].first_index = (unsigned int)(index_bytes / sizeof(unsigned int));
+        batch.meshes[i].index_count = model.meshes[i].index_count;
+        batch.meshes[i].base_vertex = (int)(vertex_bytes / sizeof(vertex_t));
+        batch.meshes[i].diffuse_texture = model.meshes[i].diffuse_texture;
+
+        if (model.meshes[i].diffuse_texture != model.meshes[0].diffuse_texture) {
+            batch.shared_texture = 0;
+        }
+
+        vertex_bytes += size;
+        index_bytes += (GLint64)model.meshes[i].index_count * sizeof(unsigned int);
+    }
+
+    glGenBuffers(1, &batch.vbo);
+    glGenBuffers(1, &batch.ebo);
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, batch.vbo);
+    glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)vertex_bytes, NULL, GL_STATIC_DRAW);
+
+    for (unsigned int i = 0; i < model.mesh_count; i++) {
+        GLint size = 0;
+
+        glBindBuffer(GL_COPY_READ_BUFFER, model.meshes[i].vbo);
+        glGetBufferParameteriv(GL_COPY_READ_BUFFER, GL_BUFFER_SIZE, &size);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0,
+                            (GLintptr)batch.meshes[i].base_vertex * sizeof(vertex_t), size);
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, batch.ebo);
+    glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)index_bytes, NULL, GL_STATIC_DRAW);
+
+    for (unsigned int i = 0; i < model.mesh_count; i++) {
+        glBindBuffer(GL_COPY_READ_BUFFER, model.meshes[i].ebo);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0,
+                            (GLintptr)batch.meshes[i].first_index * sizeof(unsigned int),
+                            (GLsizeiptr)batch.meshes[i].index_count * sizeof(unsigned int));
+    }
+
+    // Instance matrices, read as a samplerBuffer by both passes
+    glGenBuffers(1, &batch.instance_buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, batch.instance_buffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)capacity * sizeof(mat4), NULL, GL_DYNAMIC_DRAW);
+
+    glGenTextures(1, &batch.instance_texture);
+    glBindTexture(GL_TEXTURE_BUFFER, batch.instance_texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, batch.instance_buffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+    // One indirect command per mesh, instance counts filled in by the cull pass
+    draw_command_t* commands = calloc(model.mesh_count, sizeof(draw_command_t));
+
+    if (commands) {
+        for (unsigned int i = 0; i < model.mesh_count; i++) {
+            commands[i].count = batch.meshes[i].index_count;
+            commands[i].first_index = batch.meshes[i].first_index;
+            commands[i].base_vertex = batch.meshes[i].base_vertex;
+        }
+    }
+
+    glGenBuffers(1, &batch.indirect_buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, batch.indirect_buffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, sizeof(draw_command_t) * model.mesh_count, commands, GL_DYNAMIC_DRAW);
+    free(commands);
+
+    glGenBuffers(2, batch.visible_buffers);
+    glGenTransformFeedbacks(2, batch.feedback);
+    glGenQueries(2, batch.queries);
+    glGenVertexArrays(2, batch.draw_vaos);
+
+    for (int i = 0; i < 2; i++) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, batch.visible_buffers[i]);
+        glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)capacity * sizeof(GLuint), NULL, GL_DYNAMIC_COPY);
+
+        glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, batch.feedback[i]);
+        glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, batch.visible_buffers[i]);
+
+        glBindVertexArray(batch.draw_vaos[i]);
+        glBindBuffer(GL_ARRAY_BUFFER, batch.vbo);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, batch.ebo);
+
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(vertex_t), (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(vertex_t), (void*)offsetof(vertex_t, norm));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(vertex_t), (void*)offsetof(vertex_t, tex));
+        glEnableVertexAttribArray(2);
+
+        glBindBuffer(GL_ARRAY_BUFFER, batch.visible_buffers[i]);
+        glVertexAttribIPointer(INSTANCE_ATTRIBUTE, 1, GL_UNSIGNED_INT, sizeof(GLuint), (void*)0);
+        glVertexAttribDivisor(INSTANCE_ATTRIBUTE, 1);
+        glEnableVertexAttribArray(INSTANCE_ATTRIBUTE);
+    }
+
+    glBindVertexArray(0);
+    glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, 0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    // Bounding sphere around the model AABB
+    vec3 center;
+    glm_vec3_add(model.bounds_min, model.bounds_max, center);
+    glm_vec3_scale(center, 0.5f, center);
+
+    batch.bounds_sphere[0] = center[0];
+    batch.bounds_sphere[1] = center[1];
+    batch.bounds_sphere[2] = center[2];
+    batch.bounds_sphere[3] = glm_vec3_distance(model.bounds_min, model.bounds_max) * 0.5f;
+
+    batch.instance_capacity = capacity;
+
+    return batch;
+}
+
+void gpu_batch_set_transforms(gpu_batch_t* batch, unsigned int first, unsigned int count, const mat4* transforms) {
+    if (first >= batch->instance_capacity) {
+        return;
+    }
+
+    if (count > batch->instance_capacity - first) {
+        count = batch->instance_capacity - first;
+    }
+
+    stream_buffer_t* stream = renderer_get_stream_buffer();
+    size_t bytes = (size_t)count * sizeof(mat4);
+    size_t offset = 0;
+    void* staging = NULL;
+
+    // Uploads larger than what's left of the frame region skip the ring instead of overflowing it
+    if (stream->in_frame && bytes + 16 <= stream->frame_size - stream->offset) {
+        staging = stream_buffer_alloc(stream, bytes, 16, &offset);
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, batch->instance_buffer);
+
+    if (staging) {
+        // The copy is queued behind draws still reading the instances, no CPU sync
+        memcpy(staging, transforms, bytes);
+        stream_buffer_flush(stream);
+
+        glBindBuffer(GL_COPY_READ_BUFFER, stream->buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, (GLintptr)offset,
+                            (GLintptr)first * sizeof(mat4), (GLsizeiptr)bytes);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    } else {
+        glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)first * sizeof(mat4), (GLsizeiptr)bytes, transforms);
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    if (first + count > batch->instance_count) {
+        batch->instance_count = first + count;
+    }
+}
+
+void gpu_batch_set_count(gpu_batch_t* batch, unsigned int count) {
+    batch->instance_count = count < batch->instance_capacity ? count : batch->instance_capacity;
+}
+
+static void write_instance_counts(gpu_batch_t* batch, GLuint count) {
+    draw_command_t command;
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, batch->indirect_buffer);
+
+    for (unsigned int i = 0; i < batch->mesh_count; i++) {
+        glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)(i * sizeof(draw_command_t) + offsetof(draw_command_t, instance_count)),
+                        sizeof(command.instance_count), &count);
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void gpu_batch_cull(gpu_batch_t* batch, vec4 planes[6]) {
+    if (batch->instance_capacity == 0) {
+        return;
+    }
+
+    unsigned int current = batch->frame & 1;
+
+    if (!has_query_buffer && batch->has_previous) {
+        // The previous frame's list becomes drawable once its count is known. Until
+        // then the pass is skipped: culling into current would overwrite the list
+        // still being drawn with its own count
+        unsigned int pending = current ^ 1;
+        GLuint available = 0;
+
+        glGetQueryObjectuiv(batch->queries[pending], GL_QUERY_RESULT_AVAILABLE, &available);
+
+        if (!available) {
+            return;
+        }
+
+        glGetQueryObjectuiv(batch->queries[pending], GL_QUERY_RESULT, &batch->visible_count);
+        write_instance_counts(batch, batch->visible_count);
+        batch->draw_index = pending;
+    }
+
+    shader_use(cull_shader);
+    glUniform4fv(planes_location, 6, (float*)planes);
+    glUniform4fv(sphere_location, 1, batch->bounds_sphere);
+
+    glActiveTexture(GL_TEXTURE0 + INSTANCE_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_BUFFER, batch->instance_texture);
+
+    glEnable(GL_RASTERIZER_DISCARD);
+    glBindVertexArray(empty_vao);
+    glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, batch->feedback[current]);
+
+    glBeginQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN, batch->queries[current]);
+    glBeginTransformFeedback(GL_POINTS);
+    glDrawArrays(GL_POINTS, 0, (GLsizei)batch->instance_count);
+    glEndTransformFeedback();
+    glEndQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN);
+
+    glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, 0);
+    glBindVertexArray(0);
+    glDisable(GL_RASTERIZER_DISCARD);
+
+    if (has_query_buffer) {
+        // The GPU writes the count straight into each command, no readback
+        glBindBuffer(GL_QUERY_BUFFER, batch->indirect_buffer);
+
+        for (unsigned int i = 0; i < batch->mesh_count; i++) {
+            uintptr_t offset = i * sizeof(draw_command_t) + offsetof(draw_command_t, instance_count);
+            glGetQueryObjectuiv(batch->queries[current], GL_QUERY_RESULT, (GLuint*)offset);
+        }
+
+        glBindBuffer(GL_QUERY_BUFFER, 0);
+        batch->draw_index = current;
+    } else if (!batch->has_previous) {
+        // Nothing to draw until this list's count is read back next frame
+        write_instance_counts(batch, 0);
+        batch->draw_index = current;
+    }
+
+    batch->has_previous = 1;
+    batch->frame++;
+}
+
+void gpu_batch_draw(gpu_batch_t* batch, unsigned int shader, mat4 view, mat4 projection) {
+    if (batch->instance_capacity == 0 || !batch->has_previous) {
+        return;
+    }
+
+    unsigned int program = shader != 0 ? shader : draw_shader;
+
+    shader_use(program);
+    shader_set_mat4(program, "view", view);
+    shader_set_mat4(program, "projection", projection);
+    shader_set_int(program, "instances", INSTANCE_TEXTURE_UNIT);
+
+    glActiveTexture(GL_TEXTURE0 + INSTANCE_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_BUFFER, batch->instance_texture);
+
+    glBindVertexArray(batch->draw_vaos[batch->draw_index]);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, batch->indirect_buffer);
+
+    if (has_multi_draw && batch->shared_texture) {
+        // Whole model in one call
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, batch->meshes[0].diffuse_texture);
+        shader_set_int(program, "has_diffuse", batch->meshes[0].diffuse_texture != 0);
+
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)0, (GLsizei)batch->mesh_count, 0);
+    } else {
+        for (unsigned int i = 0; i < batch->mesh_count; i++) {
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, batch->meshes[i].diffuse_texture);
+            shader_set_int(program, "has_diffuse", batch->meshes[i].diffuse_texture != 0);
+
+            glDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)(uintptr_t)(i * sizeof(draw_command_t)));
+        }
+    }
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+void gpu_batch_destroy(gpu_batch_t* batch) {
+    if (batch->vbo) {
+        glDeleteBuffers(1, &batch->vbo);
+        glDeleteBuffers(1, &batch->ebo);
+        glDeleteBuffers(1, &batch->instance_buffer);
+        glDeleteTextures(1, &batch->instance_texture);
+        glDeleteBuffers(1, &batch->indirect_buffer);
+        glDeleteBuffers(2, batch->visible_buffers);
+        glDeleteTransformFeedbacks(2, batch->feedback);
+        glDeleteQueries(2, batch->queries);
+        glDeleteVertexArrays(2, batch->draw_vaos);
+    }
+
+    free(batch->meshes);
+
+    *batch = (gpu_batch_t){0};
+}
+
+void gpu_culling_shutdown(void) {
+    if (cull_shader) {
+        shader_delete(cull_shader);
+        cull_shader = 0;
+    }
+
+    if (draw_shader) {
+        shader_delete(draw_shader);
+        draw_shader = 0;
+    }
+
+    if (empty_vao) {
+        glDeleteVertexArrays(1, &empty_vao);
+        empty_vao = 0;
+    }
+}
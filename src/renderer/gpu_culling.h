@@ -0,0 +1,112 @@
+#ifndef GPU_CULLING_H
+#define GPU_CULLING_H
+
+#include "model.h"
+#include <cglm/cglm.h>
+
+typedef struct {
+    unsigned int first_index;
+    unsigned int index_count;
+    int base_vertex;
+    unsigned int diffuse_texture;
+} gpu_batch_mesh_t;
+
+typedef struct {
+    // Model meshes merged into one vertex and index buffer
+    unsigned int vbo;
+    unsigned int ebo;
+    gpu_batch_mesh_t* meshes;
+    unsigned int mesh_count;
+    vec4 bounds_sphere; // Local space center and radius
+
+    unsigned int instance_buffer;  // mat4 per instance
+    unsigned int instance_texture; // samplerBuffer view of instance_buffer
+    unsigned int instance_count;
+    unsigned int instance_capacity;
+
+    // Ping-ponged so the fallback path can draw last frame's results
+    unsigned int visible_buffers[2]; // Surviving instance indices
+    unsigned int feedback[2];
+    unsigned int queries[2];
+    unsigned int draw_vaos[2];
+    unsigned int indirect_buffer;    // One draw command per mesh
+    unsigned int frame;
+    unsigned int draw_index; // visible_buffers entry used by the next draw
+    int has_previous;
+    int shared_texture; // All meshes use one diffuse texture: multi-draw possible
+    unsigned int visible_count; // Fallback path only: count of visible_buffers[draw_index]
+} gpu_batch_t;
+
+/**
+   * Init the GPU culling pass and the default instanced draw shader
+   * @return 0 on success, -1 on failure
+**/
+
+int gpu_culling_init(void);
+
+/**
+   * Create an instanced batch of one model, culled on the GPU
+   * @param model Model whose meshes are merged into the batch
+   * @param capacity Max instances
+   * @return Batch, instance_capacity is 0 on failure
+**/
+
+gpu_batch_t gpu_batch_create(model_t model, unsigned int capacity);
+
+/**
+   * Upload instance model matrices
+   * Between renderer begin and end frame they are staged in the stream buffer
+   * and copied on the GPU, otherwise uploaded directly
+   * @param batch Batch
+   * @param first First instance to write
+   * @param count Number of matrices
+   * @param transforms Model matrices
+**/
+
+void gpu_batch_set_transforms(gpu_batch_t* batch, unsigned int first, unsigned int count, const mat4* transforms);
+
+/**
+   * Set the number of live instances, higher instances are ignored
+   * @param batch Batch
+   * @param count Instance count: <= capacity
+**/
+
+void gpu_batch_set_count(gpu_batch_t* batch, unsigned int count);
+
+/**
+   * Frustum cull all instances on the GPU and fill the indirect draw commands
+   * Without GL_ARB_query_buffer_object the visible count is read back
+   * one frame late and the previous frame's list is drawn. While that count
+   * is still pending the pass is skipped and the older list is drawn again
+   * @param batch Batch
+   * @param planes Frustum planes from glm_frustum_planes()
+**/
+
+void gpu_batch_cull(gpu_batch_t* batch, vec4 planes[6]);
+
+/**
+   * Draw the surviving instances with indirect draws
+   * Custom shaders read the instance index at location 3 and the
+   * matrices from the "instances" samplerBuffer on texture unit 3
+   * @param batch Batch
+   * @param shader Shader program ID or 0 for the default shader
+   * @param view View matrix
+   * @param projection Projection matrix
+**/
+
+void gpu_batch_draw(gpu_batch_t* batch, unsigned int shader, mat4 view, mat4 projection);
+
+/**
+   * Free batch resources
+   * @param batch Batch to destroy
+**/
+
+void gpu_batch_destroy(gpu_batch_t* batch);
+
+/**
+   * Release the culling and default draw shaders
+**/
+
+void gpu_culling_shutdown(void);
+
+#endif // GPU_CULLING_H
@@ -6,6 +6,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <float.h>
 #include <unistd.h>
 #include <sys/stat.h>
 #include <GL/gl.h>
@@ -44,6 +45,9 @@ static mesh_t process_mesh(struct aiMesh* mesh, const struct aiScene* scene) {
         return res;
     }
 
+    glm_vec3_copy((vec3){FLT_MAX, FLT_MAX, FLT_MAX}, res.bounds_min);
+    glm_vec3_copy((vec3){-FLT_MAX, -FLT_MAX, -FLT_MAX}, res.bounds_max);
+
     // Process vertices
     for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
         vertex_t vertex;
@@ -71,6 +75,9 @@ static mesh_t process_mesh(struct aiMesh* mesh, const struct aiScene* scene) {
         }
 
         vertices[i] = vertex;
+
+        glm_vec3_minv(res.bounds_min, vertex.pos, res.bounds_min);
+        glm_vec3_maxv(res.bounds_max, vertex.pos, res.bounds_max);
     }
 
     // Process indices
@@ -185,6 +192,15 @@ model_t model_load(const char *path) {
     process_node(scene->mRootNode, scene, &model, &mesh_index);
     aiReleaseImport(scene);
 
+    // Merge mesh bounds into the model bounds
+    glm_vec3_copy((vec3){FLT_MAX, FLT_MAX, FLT_MAX}, model.bounds_min);
+    glm_vec3_copy((vec3){-FLT_MAX, -FLT_MAX, -FLT_MAX}, model.bounds_max);
+
+    for (unsigned int i = 0; i < mesh_index; i++) {
+        glm_vec3_minv(model.bounds_min, model.meshes[i].bounds_min, model.bounds_min);
+        glm_vec3_maxv(model.bounds_max, model.meshes[i].bounds_max, model.bounds_max);
+    }
+
     printf("Loaded model: %s | %u meshes\n", path, model.mesh_count);
 
     return model;
@@ -259,6 +275,97 @@ void model_free(model_t *model) {
     }
 }
 
+int model_read_geometry(const model_t* model, float** positions, unsigned int* vertex_count, unsigned int** indices, unsigned int* index_count) {
+    *positions = NULL;
+    *indices = NULL;
+    *vertex_count = 0;
+    *index_count = 0;
+
+    if (!model || model->mesh_count == 0) {
+        return -1;
+    }
+
+    unsigned int total_vertices = 0;
+    unsigned int total_indices = 0;
+
+    for (unsigned int i = 0; i < model->mesh_count; i++) {
+        GLint size = 0;
+        glBindBuffer(GL_COPY_READ_BUFFER, model->meshes[i].vbo);
+        glGetBufferParameteriv(GL_COPY_READ_BUFFER, GL_BUFFER_SIZE, &size);
+
+        total_vertices += (unsigned int)size / sizeof(vertex_t);
+        total_indices += model->meshes[i].index_count;
+    }
+
+    float* out_positions = malloc(sizeof(float) * 3 * total_vertices);
+    unsigned int* out_indices = malloc(sizeof(unsigned int) * total_indices);
+    vertex_t* vertices = NULL;
+    unsigned int vertex_capacity = 0;
+
+    if (!out_positions || !out_indices) {
+        fprintf(stderr, "Failed to allocate mem for model geometry\n");
+        free(out_positions);
+        free(out_indices);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        return -1;
+    }
+
+    unsigned int base_vertex = 0;
+    unsigned int first_index = 0;
+
+    for (unsigned int i = 0; i < model->mesh_count; i++) {
+        const mesh_t* mesh = &model->meshes[i];
+        GLint size = 0;
+
+        glBindBuffer(GL_COPY_READ_BUFFER, mesh->vbo);
+        glGetBufferParameteriv(GL_COPY_READ_BUFFER, GL_BUFFER_SIZE, &size);
+
+        unsigned int count = (unsigned int)size / sizeof(vertex_t);
+
+        if (count > vertex_capacity) {
+            vertex_t* grown = realloc(vertices, sizeof(vertex_t) * count);
+
+            if (!grown) {
+                fprintf(stderr, "Failed to allocate mem for model geometry\n");
+                free(vertices);
+                free(out_positions);
+                free(out_indices);
+                glBindBuffer(GL_COPY_READ_BUFFER, 0);
+                return -1;
+            }
+
+            vertices = grown;
+            vertex_capacity = count;
+        }
+
+        glGetBufferSubData(GL_COPY_READ_BUFFER, 0, sizeof(vertex_t) * count, vertices);
+
+        for (unsigned int v = 0; v < count; v++) {
+            glm_vec3_copy(vertices[v].pos, &out_positions[(base_vertex + v) * 3]);
+        }
+
+        glBindBuffer(GL_COPY_READ_BUFFER, mesh->ebo);
+        glGetBufferSubData(GL_COPY_READ_BUFFER, 0, sizeof(unsigned int) * mesh->index_count, out_indices + first_index);
+
+        for (unsigned int j = 0; j < mesh->index_count; j++) {
+            out_indices[first_index + j] += base_vertex;
+        }
+
+        base_vertex += count;
+        first_index += mesh->index_count;
+    }
+
+    free(vertices);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+    *positions = out_positions;
+    *indices = out_indices;
+    *vertex_count = total_vertices;
+    *index_count = total_indices;
+
+    return 0;
+}
+
 model_t model_create_cube(void) {
     model_t model = {0};
 
@@ -332,6 +439,11 @@ model_t model_create_cube(void) {
     mesh->specular_texture = 0;
     mesh->index_count = sizeof(indices) / sizeof(indices[0]);
 
+    glm_vec3_copy((vec3){-0.5f, -0.5f, -0.5f}, mesh->bounds_min);
+    glm_vec3_copy((vec3){0.5f, 0.5f, 0.5f}, mesh->bounds_max);
+    glm_vec3_copy(mesh->bounds_min, model.bounds_min);
+    glm_vec3_copy(mesh->bounds_max, model.bounds_max);
+
     strcpy(mesh->material_name, "cube_material");
 
     printf("Creating cube: %u vertices | %u indices\n", (unsigned int)(sizeof(vertices) / sizeof(vertices[0])), mesh->index_count);
@@ -18,11 +18,15 @@ typedef struct {
     unsigned int normal_texture;
     unsigned int specular_texture;
     char material_name[256];
+    vec3 bounds_min;
+    vec3 bounds_max;
 } mesh_t;
 
 typedef struct {
     mesh_t* meshes;
     unsigned int mesh_count;
+    vec3 bounds_min; // Local space AABB over all meshes
+    vec3 bounds_max;
 } model_t;
 
 /**
@@ -48,6 +52,19 @@ void model_draw(model_t model, unsigned int shader_id);
 
 void model_free(model_t* model);
 
+/**
+    * Read a model's triangles back from its GPU buffers, e.g. for collision
+    * All meshes are merged, indices are rebased onto the merged positions
+    * @param model Loaded model
+    * @param positions Output xyz per vertex, free() when done
+    * @param vertex_count Output vertex count
+    * @param indices Output triangle indices, free() when done
+    * @param index_count Output index count
+    * @return 0 on success, -1 on failure
+**/
+
+int model_read_geometry(const model_t* model, float** positions, unsigned int* vertex_count, unsigned int** indices, unsigned int* index_count);
+
 /**
     * Create a simple cube primitive for testing
     * @return Cube model
@@ -0,0 +1,311 @@
+#include "occlusion.h"
+#include "shader.h"
+#define GL_GLEXT_PROTOTYPES
+#include <stdio.h>
+#include <GL/gl.h>
+#include <GL/glext.h>
+
+// Frames a visible object is trusted before its draw is queried again
+#define OCCLUSION_VISIBLE_INTERVAL 8
+// Spread re-tests of visible objects so they don't all land on one frame
+#define OCCLUSION_JITTER 4
+// Boxes closer than this to the camera may be clipped by the near plane
+#define OCCLUSION_NEAR_MARGIN 0.2f
+
+static const char* proxy_vert_src =
+    "#version 410 core\n"
+    "layout (location = 0) in vec3 aPos;\n"
+    "uniform mat4 mvp;\n"
+    "void main() {\n"
+    "    gl_Position = mvp * vec4(aPos, 1.0);\n"
+    "}\n";
+
+static const char* proxy_frag_src =
+    "#version 410 core\n"
+    "out vec4 FragColor;\n"
+    "void main() {\n"
+    "    FragColor = vec4(1.0);\n"
+    "}\n";
+
+static unsigned int proxy_vao = 0;
+static unsigned int proxy_vbo = 0;
+static unsigned int proxy_ebo = 0;
+static unsigned int proxy_shader = 0;
+static int proxy_mvp_location = -1;
+
+static mat4 view_projection;
+static vec3 eye_pos;
+static unsigned int frame_index = 0;
+static occlusion_stats_t stats;
+
+int occlusion_init(void) {
+    // Unit cube centered at origin, scaled to the object AABB at draw time
+    float vertices[] = {
+        -0.5f, -0.5f, -0.5f,
+         0.5f, -0.5f, -0.5f,
+         0.5f,  0.5f, -0.5f,
+        -0.5f,  0.5f, -0.5f,
+        -0.5f, -0.5f,  0.5f,
+         0.5f, -0.5f,  0.5f,
+         0.5f,  0.5f,  0.5f,
+        -0.5f,  0.5f,  0.5f
+    };
+
+    unsigned int indices[] = {
+        0, 2, 1,  2, 0, 3, // Back
+        4, 5, 6,  6, 7, 4, // Front
+        0, 4, 7,  7, 3, 0, // Left
+        1, 2, 6,  6, 5, 1, // Right
+        3, 7, 6,  6, 2, 3, // Top
+        0, 1, 5,  5, 4, 0  // Bottom
+    };
+
+    proxy_shader = shader_create_from_source(proxy_vert_src, proxy_frag_src);
+
+    if (proxy_shader == 0) {
+        fprintf(stderr, "Failed to create occlusion proxy shader\n");
+
+        return -1;
+    }
+
+    proxy_mvp_location = glGetUniformLocation(proxy_shader, "mvp");
+
+    glGenVertexArrays(1, &proxy_vao);
+    glGenBuffers(1, &proxy_vbo);
+    glGenBuffers(1, &proxy_ebo);
+    glBindVertexArray(proxy_vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, proxy_vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, proxy_ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    glBindVertexArray(0);
+
+    printf("Occlusion culling initialized\n");
+
+    return 0;
+}
+
+void occlusion_begin_frame(mat4 view, mat4 projection, vec3 camera_pos) {
+    glm_mat4_mul(projection, view, view_projection);
+    glm_vec3_copy(camera_pos, eye_pos);
+
+    frame_index++;
+    stats = (occlusion_stats_t){0};
+}
+
+occlusion_query_t occlusion_query_create(void) {
+    occlusion_query_t query = {0};
+
+    glGenQueries(1, &query.query);
+
+    // Unknown objects are assumed visible so they get drawn on the first frame
+    query.visible = 1;
+    query.next_test_frame = frame_index;
+
+    return query;
+}
+
+/**
+    * Helper func to fetch a finished query result without stalling
+**/
+
+static void poll_query(occlusion_query_t* query) {
+    unsigned int available = 0;
+
+    glGetQueryObjectuiv(query->query, GL_QUERY_RESULT_AVAILABLE, &available);
+
+    if (!available) {
+        return;
+    }
+
+    unsigned int samples = 0;
+    glGetQueryObjectuiv(query->query, GL_QUERY_RESULT, &samples);
+
+    query->pending = 0;
+    query->visible = samples != 0;
+
+    if (query->visible) {
+        query->next_test_frame = frame_index + OCCLUSION_VISIBLE_INTERVAL + (query->query * 7) % OCCLUSION_JITTER;
+    }
+}
+
+/**
+    * Helper func to check if the camera sits inside the (slightly grown) world AABB,
+    * where the near plane would clip the proxy and report it hidden
+**/
+
+static int camera_inside(vec3 bounds_min, vec3 bounds_max, mat4 transform) {
+    vec3 box[2];
+    vec3 world_box[2];
+
+    glm_vec3_copy(bounds_min, box[0]);
+    glm_vec3_copy(bounds_max, box[1]);
+    glm_aabb_transform(box, transform, world_box);
+
+    for (int i = 0; i < 3; i++) {
+        world_box[0][i] -= OCCLUSION_NEAR_MARGIN;
+        world_box[1][i] += OCCLUSION_NEAR_MARGIN;
+    }
+
+    return glm_aabb_point(world_box, eye_pos);
+}
+
+static void draw_proxy(occlusion_query_t* query, vec3 bounds_min, vec3 bounds_max, mat4 transform) {
+    vec3 center;
+    vec3 extent;
+    mat4 box_matrix;
+    mat4 mvp;
+
+    glm_vec3_add(bounds_min, bounds_max, center);
+    glm_vec3_scale(center, 0.5f, center);
+    glm_vec3_sub(bounds_max, bounds_min, extent);
+
+    glm_translate_make(box_matrix, center);
+    glm_scale(box_matrix, extent);
+    glm_mat4_mul(transform, box_matrix, box_matrix);
+    glm_mat4_mul(view_projection, box_matrix, mvp);
+
+    // Whatever the caller had bound or enabled is put back after the proxy,
+    // uniforms set after a culled object still reach the caller's program
+    GLint program = 0;
+    GLint vao = 0;
+    GLboolean cull_face = glIsEnabled(GL_CULL_FACE);
+    GLboolean depth_mask = GL_TRUE;
+    GLboolean color_mask[4] = {GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE};
+
+    glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vao);
+    glGetBooleanv(GL_DEPTH_WRITEMASK, &depth_mask);
+    glGetBooleanv(GL_COLOR_WRITEMASK, color_mask);
+
+    // Depth test only: the proxy must not touch color or depth
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glDepthMask(GL_FALSE);
+    glDisable(GL_CULL_FACE);
+
+    glUseProgram(proxy_shader);
+    glUniformMatrix4fv(proxy_mvp_location, 1, GL_FALSE, (float*)mvp);
+
+    glBeginQuery(GL_ANY_SAMPLES_PASSED, query->query);
+    glBindVertexArray(proxy_vao);
+    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+    glEndQuery(GL_ANY_SAMPLES_PASSED);
+
+    glBindVertexArray((GLuint)vao);
+    glUseProgram((GLuint)program);
+
+    if (cull_face) {
+        glEnable(GL_CULL_FACE);
+    }
+
+    glDepthMask(depth_mask);
+    glColorMask(color_mask[0], color_mask[1], color_mask[2], color_mask[3]);
+
+    query->pending = 1;
+    stats.queries_issued++;
+    stats.proxy_queries++;
+}
+
+int occlusion_begin(occlusion_query_t* query, vec3 bounds_min, vec3 bounds_max, mat4 transform) {
+    stats.objects++;
+
+    if (proxy_shader == 0 || query->query == 0) {
+        query->mode = OCCLUSION_MODE_PLAIN;
+
+        return 1;
+    }
+
+    if (query->pending) {
+        poll_query(query);
+    }
+
+    if (camera_inside(bounds_min, bounds_max, transform)) {
+        query->visible = 1;
+        query->mode = OCCLUSION_MODE_PLAIN;
+
+        return 1;
+    }
+
+    // Result not back yet: let the GPU decide using last frame's query
+    if (query->pending) {
+        glBeginConditionalRender(query->query, GL_QUERY_WAIT);
+        query->mode = OCCLUSION_MODE_CONDITIONAL;
+        stats.conditional_draws++;
+
+        return 1;
+    }
+
+    if (query->visible) {
+        // Temporal coherence: visible objects are trusted for a few frames
+        if (frame_index < query->next_test_frame) {
+            query->mode = OCCLUSION_MODE_PLAIN;
+
+            return 1;
+        }
+
+        // The real draw doubles as the query, no proxy needed
+        glBeginQuery(GL_ANY_SAMPLES_PASSED, query->query);
+        query->mode = OCCLUSION_MODE_QUERY;
+        stats.queries_issued++;
+
+        return 1;
+    }
+
+    // Occluded last time: test the cheap box and skip the real draw
+    draw_proxy(query, bounds_min, bounds_max, transform);
+    query->mode = OCCLUSION_MODE_PROXY;
+    stats.culled++;
+
+    return 0;
+}
+
+void occlusion_end(occlusion_query_t* query) {
+    switch (query->mode) {
+        case OCCLUSION_MODE_QUERY:
+            glEndQuery(GL_ANY_SAMPLES_PASSED);
+            query->pending = 1;
+            break;
+
+        case OCCLUSION_MODE_CONDITIONAL:
+            glEndConditionalRender();
+            break;
+
+        default:
+            break;
+    }
+
+    query->mode = OCCLUSION_MODE_NONE;
+}
+
+void occlusion_query_delete(occlusion_query_t* query) {
+    if (query->query != 0) {
+        glDeleteQueries(1, &query->query);
+    }
+
+    *query = (occlusion_query_t){0};
+}
+
+occlusion_stats_t occlusion_get_stats(void) {
+    return stats;
+}
+
+void occlusion_shutdown(void) {
+    if (proxy_vao != 0) {
+        glDeleteVertexArrays(1, &proxy_vao);
+        glDeleteBuffers(1, &proxy_vbo);
+        glDeleteBuffers(1, &proxy_ebo);
+    }
+
+    if (proxy_shader != 0) {
+        shader_delete(proxy_shader);
+    }
+
+    proxy_vao = proxy_vbo = proxy_ebo = 0;
+    proxy_shader = 0;
+}
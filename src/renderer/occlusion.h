@@ -0,0 +1,94 @@
+#ifndef OCCLUSION_H
+#define OCCLUSION_H
+
+#include <cglm/cglm.h>
+
+typedef enum {
+    OCCLUSION_MODE_NONE = 0,
+    OCCLUSION_MODE_PLAIN,       // Known visible, drawn without a query
+    OCCLUSION_MODE_QUERY,       // Visible object re-tested by wrapping its own draw
+    OCCLUSION_MODE_CONDITIONAL, // Query still pending, draw under conditional render
+    OCCLUSION_MODE_PROXY        // Known occluded, only the bounding box proxy is tested
+} occlusion_mode_t;
+
+typedef struct {
+    unsigned int query;
+    unsigned int next_test_frame;
+    int visible;
+    int pending;
+    occlusion_mode_t mode;
+} occlusion_query_t;
+
+typedef struct {
+    unsigned int objects;
+    unsigned int queries_issued;
+    unsigned int proxy_queries;
+    unsigned int conditional_draws;
+    unsigned int culled;
+} occlusion_stats_t;
+
+/**
+    * Init occlusion culling: proxy box geometry and shader
+    * Requires a current OpenGL context
+    * @return 0 on success and -1 on failure
+**/
+
+int occlusion_init(void);
+
+/**
+    * Begin a new occlusion frame
+    * @param view View matrix
+    * @param projection Projection matrix
+    * @param camera_pos Camera world position
+**/
+
+void occlusion_begin_frame(mat4 view, mat4 projection, vec3 camera_pos);
+
+/**
+    * Create occlusion state for a single object
+    * @return Occlusion query, starts out as visible
+**/
+
+occlusion_query_t occlusion_query_create(void);
+
+/**
+    * Decide how an object is drawn this frame and issue any queries for it
+    * Must be paired with occlusion_end() when it returns 1. Bound program, VAO,
+    * cull face and write masks are the same on return
+    * @param query Object occlusion state
+    * @param bounds_min Local space AABB min
+    * @param bounds_max Local space AABB max
+    * @param transform Object model matrix
+    * @return 1 if the object should be drawn and 0 if it can be skipped
+**/
+
+int occlusion_begin(occlusion_query_t* query, vec3 bounds_min, vec3 bounds_max, mat4 transform);
+
+/**
+    * Finish the object draw started with occlusion_begin()
+    * @param query Object occlusion state
+**/
+
+void occlusion_end(occlusion_query_t* query);
+
+/**
+    * Delete occlusion state for an object
+    * @param query Occlusion query to delete
+**/
+
+void occlusion_query_delete(occlusion_query_t* query);
+
+/**
+    * Get occlusion counters for the current frame
+    * @return Frame statistics
+**/
+
+occlusion_stats_t occlusion_get_stats(void);
+
+/**
+    * Release proxy geometry and shader
+**/
+
+void occlusion_shutdown(void);
+
+#endif // OCCLUSION_H
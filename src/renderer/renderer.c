@@ -1,15 +1,26 @@
+// Before any header that may pull in GL/gl.h through GLFW
+#define GL_GLEXT_PROTOTYPES
 #include "renderer.h"
 #include "renderer/camera.h"
 #include "renderer/model.h"
+#include "renderer/occlusion.h"
+#include "renderer/gpu_culling.h"
+#include "renderer/stream_buffer.h"
 #include "shader.h"
-#define GL_GLEXT_PROTOTYPES
 #include <stdio.h>
+#include <string.h>
 #include <cglm/mat4.h>
 #include <GL/gl.h>
 #include <GL/glext.h>
 
 static mat4 current_view;
 static mat4 current_projection;
+static vec4 frustum_planes[6];
+
+#define STREAM_FRAME_SIZE (4 * 1024 * 1024)
+#define STREAM_FRAME_COUNT 3
+
+static stream_buffer_t stream;
 
 void renderer_init(void) {
     glEnable(GL_DEPTH_TEST);
@@ -18,6 +29,20 @@ void renderer_init(void) {
     // Default clear color
     glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
 
+    if (occlusion_init() != 0) {
+        printf("Warning: Occlusion culling disabled\n");
+    }
+
+    if (gpu_culling_init() != 0) {
+        printf("Warning: GPU culling disabled\n");
+    }
+
+    stream = stream_buffer_create(STREAM_FRAME_SIZE, STREAM_FRAME_COUNT);
+
+    if (stream.buffer == 0) {
+        printf("Warning: Stream buffer unavailable\n");
+    }
+
     printf("Renderer initialized\n");
 }
 
@@ -27,6 +52,14 @@ void renderer_begin_frame(camera_t *camera, mat4 projection) {
 
     camera_get_view_matrix(camera, current_view);
     glm_mat4_copy(projection, current_projection);
+
+    occlusion_begin_frame(current_view, current_projection, camera->pos);
+
+    mat4 view_projection;
+    glm_mat4_mul(current_projection, current_view, view_projection);
+    glm_frustum_planes(view_projection, frustum_planes);
+
+    stream_buffer_begin_frame(&stream);
 }
 
 void renderer_submit(model_t model, mat4 transform, unsigned int shader) {
@@ -38,12 +71,53 @@ void renderer_submit(model_t model, mat4 transform, unsigned int shader) {
     model_draw(model, shader);
 }
 
+void renderer_submit_occluded(model_t model, mat4 transform, unsigned int shader, occlusion_query_t* query) {
+    if (!occlusion_begin(query, model.bounds_min, model.bounds_max, transform)) {
+        return;
+    }
+
+    renderer_submit(model, transform, shader);
+    occlusion_end(query);
+}
+
+void renderer_submit_batch(gpu_batch_t* batch, unsigned int shader) {
+    gpu_batch_cull(batch, frustum_planes);
+    gpu_batch_draw(batch, shader, current_view, current_projection);
+}
+
 void renderer_end_frame(void) {
-    // We not doing anyhere for now
+    // Fence this frame's stream region so it's reused only after the GPU is done
+    stream_buffer_end_frame(&stream);
+
     // Could be used for post-processing etc..
     // UI rendering?
 }
 
 void renderer_set_clear_color(float r, float g, float b, float a) {
     glClearColor(r, g, b, a);
+}
+
+int renderer_has_extension(const char* name) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+
+    for (GLint i = 0; i < count; i++) {
+        const char* ext = (const char*)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+
+        if (ext && strcmp(ext, name) == 0) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+stream_buffer_t* renderer_get_stream_buffer(void) {
+    return &stream;
+}
+
+void renderer_shutdown(void) {
+    stream_buffer_destroy(&stream);
+    gpu_culling_shutdown();
+    occlusion_shutdown();
 }
\ No newline at end of file
@@ -3,6 +3,9 @@
 
 #include "camera.h"
 #include "model.h"
+#include "occlusion.h"
+#include "gpu_culling.h"
+#include "stream_buffer.h"
 #include <cglm/cglm.h>
 
 /**
@@ -28,6 +31,26 @@ void renderer_begin_frame(camera_t* camera, mat4 projection);
 
 void renderer_submit(model_t model, mat4 transform, unsigned int shader);
 
+/**
+   * Submit a model for rendering with hardware occlusion culling
+   * Hidden models only cost a bounding box query
+   * @param model Model to render
+   * @param transform Model transformation matrix
+   * @param shader Shader program ID
+   * @param query Occlusion state owned by the caller, one per object
+**/
+
+void renderer_submit_occluded(model_t model, mat4 transform, unsigned int shader, occlusion_query_t* query);
+
+/**
+   * Cull an instanced batch on the GPU and draw the survivors indirectly
+   * CPU cost does not depend on the instance count
+   * @param batch Batch created with gpu_batch_create()
+   * @param shader Shader program ID or 0 for the default instanced shader
+**/
+
+void renderer_submit_batch(gpu_batch_t* batch, unsigned int shader);
+
 /**
    * End the current frame
 **/
@@ -44,4 +67,26 @@ void renderer_end_frame(void);
 
 void renderer_set_clear_color(float r, float g, float b, float a);
 
+/**
+   * Check whether the current context exposes a GL extension
+   * @param name Extension name, e.g. "GL_ARB_buffer_storage"
+   * @return 1 if supported, 0 otherwise
+**/
+
+int renderer_has_extension(const char* name);
+
+/**
+   * Get the per-frame streaming buffer for dynamic vertex, index and uniform data
+   * Allocations are valid until the end of the current frame, flush them before drawing
+   * @return Stream buffer owned by the renderer
+**/
+
+stream_buffer_t* renderer_get_stream_buffer(void);
+
+/**
+   * Release renderer resources
+**/
+
+void renderer_shutdown(void);
+
 #endif // RENDERER_H
@@ -80,26 +80,31 @@ unsigned int shader_create(const char *vert_path, const char *frag_path) {
         return 0;
     }
 
+    unsigned int program = shader_create_from_source(vertex_code, fragment_code);
+
+    free(vertex_code);
+    free(fragment_code);
+
+    return program;
+}
+
+unsigned int shader_create_from_source(const char *vert_src, const char *frag_src) {
     // Compile vertex and fragment shader
     unsigned int vertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex, 1, (const char**)&vertex_code, NULL);
+    glShaderSource(vertex, 1, &vert_src, NULL);
     glCompileShader(vertex);
 
     if (!check_compile_errors(vertex, "VERTEX")) {
-        free(vertex_code);
-        free(fragment_code);
         glDeleteShader(vertex);
 
         return 0;
     }
 
     unsigned int fragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment, 1, (const char**)&fragment_code, NULL);
+    glShaderSource(fragment, 1, &frag_src, NULL);
     glCompileShader(fragment);
 
     if (!check_compile_errors(fragment, "FRAGMENT")) {
-        free(vertex_code);
-        free(fragment_code);
         glDeleteShader(vertex);
         glDeleteShader(fragment);
 
@@ -113,8 +118,6 @@ unsigned int shader_create(const char *vert_path, const char *frag_path) {
     glLinkProgram(program);
 
     if (!check_compile_errors(program, "PROGRAM")) {
-        free(vertex_code);
-        free(fragment_code);
         glDeleteShader(vertex);
         glDeleteShader(fragment);
         glDeleteProgram(program);
@@ -124,8 +127,58 @@ unsigned int shader_create(const char *vert_path, const char *frag_path) {
 
     glDeleteShader(vertex);
     glDeleteShader(fragment);
-    free(vertex_code);
-    free(fragment_code);
+
+    return program;
+}
+
+unsigned int shader_create_feedback(const char* vert_src, const char* geom_src, const char** varyings, int varying_count) {
+    unsigned int vertex = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertex, 1, &vert_src, NULL);
+    glCompileShader(vertex);
+
+    if (!check_compile_errors(vertex, "VERTEX")) {
+        glDeleteShader(vertex);
+
+        return 0;
+    }
+
+    unsigned int geometry = 0;
+
+    if (geom_src) {
+        geometry = glCreateShader(GL_GEOMETRY_SHADER);
+        glShaderSource(geometry, 1, &geom_src, NULL);
+        glCompileShader(geometry);
+
+        if (!check_compile_errors(geometry, "GEOMETRY")) {
+            glDeleteShader(vertex);
+            glDeleteShader(geometry);
+
+            return 0;
+        }
+    }
+
+    unsigned int program = glCreateProgram();
+    glAttachShader(program, vertex);
+
+    if (geometry) {
+        glAttachShader(program, geometry);
+    }
+
+    // Captured outputs must be declared before linking
+    glTransformFeedbackVaryings(program, varying_count, varyings, GL_INTERLEAVED_ATTRIBS);
+    glLinkProgram(program);
+
+    glDeleteShader(vertex);
+
+    if (geometry) {
+        glDeleteShader(geometry);
+    }
+
+    if (!check_compile_errors(program, "PROGRAM")) {
+        glDeleteProgram(program);
+
+        return 0;
+    }
 
     return program;
 }
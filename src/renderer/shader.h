@@ -12,6 +12,26 @@
 
 unsigned int shader_create(const char* vert_path, const char* frag_path);
 
+/**
+   * Create a shader program from in-memory GLSL sources
+   * @param vert_src Vertex shader source
+   * @param frag_src Fragment shader source
+   * @return Shader program ID on success and 0 on failure
+**/
+
+unsigned int shader_create_from_source(const char* vert_src, const char* frag_src);
+
+/**
+   * Create a transform feedback program without a fragment stage
+   * @param vert_src Vertex shader source
+   * @param geom_src Geometry shader source or NULL
+   * @param varyings Names of the outputs to capture, interleaved in one buffer
+   * @param varying_count Number of varyings
+   * @return Shader program ID on success and 0 on failure
+**/
+
+unsigned int shader_create_feedback(const char* vert_src, const char* geom_src, const char** varyings, int varying_count);
+
 /**
    * Use/activate a shader program
    * @param id Shader program ID
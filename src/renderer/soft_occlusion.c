@@ -0,0 +1,521 @@
+#include "soft_occlusion.h"
+#include "../core/jobs.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+#include <math.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SOFT_OCCLUSION_X86 1
+#endif
+
+#define TILE_WIDTH 32
+#define TILE_HEIGHT 32
+#define HIZ_BLOCK 8
+
+/**
+    * Helper func to grow a scratch array, keeps old contents
+**/
+
+static int grow_array(void** data, unsigned int* capacity, unsigned int needed, size_t elem_size) {
+    if (needed <= *capacity) {
+        return 1;
+    }
+
+    unsigned int new_capacity = *capacity ? *capacity : 256;
+
+    while (new_capacity < needed) {
+        new_capacity *= 2;
+    }
+
+    void* new_data = realloc(*data, new_capacity * elem_size);
+
+    if (!new_data) {
+        fprintf(stderr, "Failed to allocate mem for occlusion buffer\n");
+
+        return 0;
+    }
+
+    *data = new_data;
+    *capacity = new_capacity;
+
+    return 1;
+}
+
+soft_occlusion_t soft_occlusion_create(int width, int height) {
+    soft_occlusion_t so = {0};
+
+    so.width = (width + TILE_WIDTH - 1) / TILE_WIDTH * TILE_WIDTH;
+    so.height = (height + TILE_HEIGHT - 1) / TILE_HEIGHT * TILE_HEIGHT;
+    so.tiles_x = so.width / TILE_WIDTH;
+    so.tiles_y = so.height / TILE_HEIGHT;
+    so.hiz_width = so.width / HIZ_BLOCK;
+    so.hiz_height = so.height / HIZ_BLOCK;
+
+    unsigned int tile_count = (unsigned int)(so.tiles_x * so.tiles_y);
+
+    // 32 byte rows so AVX2 loads never straddle
+    so.depth = aligned_alloc(32, sizeof(float) * so.width * so.height);
+    so.hiz = calloc(so.hiz_width * so.hiz_height, sizeof(float));
+    so.bin_offsets = calloc(tile_count + 1, sizeof(unsigned int));
+    so.bin_cursor = calloc(tile_count, sizeof(unsigned int));
+
+    if (!so.depth || !so.hiz || !so.bin_offsets || !so.bin_cursor) {
+        fprintf(stderr, "Failed to allocate mem for occlusion buffer\n");
+        soft_occlusion_destroy(&so);
+
+        return so;
+    }
+
+    memset(so.depth, 0, sizeof(float) * so.width * so.height);
+    glm_mat4_identity(so.view_projection);
+
+#ifdef SOFT_OCCLUSION_X86
+    so.use_avx2 = __builtin_cpu_supports("avx2");
+#endif
+
+    printf("Software occlusion buffer: %dx%d | %u tiles | AVX2 %s\n",
+           so.width, so.height, tile_count, so.use_avx2 ? "on" : "off");
+
+    return so;
+}
+
+void soft_occlusion_begin_frame(soft_occlusion_t* so, mat4 view_projection) {
+    glm_mat4_copy(view_projection, so->view_projection);
+    so->triangle_count = 0;
+}
+
+static void emit_triangle(soft_occlusion_t* so, const float* sx, const float* sy, const float* sz, int i0, int i1, int i2) {
+    float x0 = sx[i0], y0 = sy[i0], z0 = sz[i0];
+    float x1 = sx[i1], y1 = sy[i1], z1 = sz[i1];
+    float x2 = sx[i2], y2 = sy[i2], z2 = sz[i2];
+
+    // Back facing and degenerate triangles never occlude anything a front face wouldn't
+    float area2 = (x1 - x0) * (y2 - y0) - (x2 - x0) * (y1 - y0);
+
+    if (area2 <= 0.0f) {
+        return;
+    }
+
+    int min_x = (int)floorf(fminf(x0, fminf(x1, x2)));
+    int min_y = (int)floorf(fminf(y0, fminf(y1, y2)));
+    int max_x = (int)ceilf(fmaxf(x0, fmaxf(x1, x2)));
+    int max_y = (int)ceilf(fmaxf(y0, fmaxf(y1, y2)));
+
+    if (min_x < 0) min_x = 0;
+    if (min_y < 0) min_y = 0;
+    if (max_x > so->width) max_x = so->width;
+    if (max_y > so->height) max_y = so->height;
+
+    if (min_x >= max_x || min_y >= max_y) {
+        return;
+    }
+
+    if (!grow_array((void**)&so->triangles, &so->triangle_capacity, so->triangle_count + 1, sizeof(soft_triangle_t))) {
+        return;
+    }
+
+    soft_triangle_t* tri = &so->triangles[so->triangle_count++];
+
+    tri->x[0] = x0; tri->x[1] = x1; tri->x[2] = x2;
+    tri->y[0] = y0; tri->y[1] = y1; tri->y[2] = y2;
+
+    // Inverse w is linear in screen space, so a plane equation is exact
+    tri->z_a = ((z1 - z0) * (y2 - y0) - (z2 - z0) * (y1 - y0)) / area2;
+    tri->z_b = ((x1 - x0) * (z2 - z0) - (x2 - x0) * (z1 - z0)) / area2;
+    tri->z_c = z0 - tri->z_a * x0 - tri->z_b * y0;
+
+    tri->min_x = min_x;
+    tri->min_y = min_y;
+    tri->max_x = max_x;
+    tri->max_y = max_y;
+}
+
+static void setup_triangle(soft_occlusion_t* so, vec4 a, vec4 b, vec4 c) {
+    float* in[3] = {a, b, c};
+    vec4 poly[4];
+    int count = 0;
+
+    // Clip against the near plane (z >= -w), a triangle turns into at most a quad
+    for (int i = 0; i < 3; i++) {
+        float* cur = in[i];
+        float* next = in[(i + 1) % 3];
+        float d_cur = cur[2] + cur[3];
+        float d_next = next[2] + next[3];
+
+        if (d_cur >= 0.0f) {
+            glm_vec4_copy(cur, poly[count++]);
+        }
+
+        if ((d_cur >= 0.0f) != (d_next >= 0.0f)) {
+            float t = d_cur / (d_cur - d_next);
+
+            for (int k = 0; k < 4; k++) {
+                poly[count][k] = cur[k] + t * (next[k] - cur[k]);
+            }
+
+            count++;
+        }
+    }
+
+    if (count < 3) {
+        return;
+    }
+
+    float sx[4], sy[4], sz[4];
+
+    for (int i = 0; i < count; i++) {
+        float inv_w = 1.0f / fmaxf(poly[i][3], 1e-6f);
+
+        sx[i] = (poly[i][0] * inv_w * 0.5f + 0.5f) * (float)so->width;
+        sy[i] = (poly[i][1] * inv_w * 0.5f + 0.5f) * (float)so->height;
+        sz[i] = inv_w;
+    }
+
+    emit_triangle(so, sx, sy, sz, 0, 1, 2);
+
+    if (count == 4) {
+        emit_triangle(so, sx, sy, sz, 0, 2, 3);
+    }
+}
+
+void soft_occlusion_add_occluder(soft_occlusion_t* so, const float* positions, unsigned int vertex_count,
+                                 const unsigned int* indices, unsigned int index_count, mat4 transform) {
+    if (!so->depth) {
+        return;
+    }
+
+    if (!grow_array((void**)&so->clip_vertices, &so->clip_capacity, vertex_count, sizeof(vec4))) {
+        return;
+    }
+
+    mat4 mvp;
+    glm_mat4_mul(so->view_projection, transform, mvp);
+
+    for (unsigned int i = 0; i < vertex_count; i++) {
+        vec4 pos = {positions[i * 3 + 0], positions[i * 3 + 1], positions[i * 3 + 2], 1.0f};
+
+        glm_mat4_mulv(mvp, pos, so->clip_vertices[i]);
+    }
+
+    for (unsigned int i = 0; i + 2 < index_count; i += 3) {
+        setup_triangle(so, so->clip_vertices[indices[i]], so->clip_vertices[indices[i + 1]], so->clip_vertices[indices[i + 2]]);
+    }
+}
+
+void soft_occlusion_add_box(soft_occlusion_t* so, vec3 bounds_min, vec3 bounds_max, mat4 transform) {
+    float* lo = bounds_min;
+    float* hi = bounds_max;
+
+    float positions[] = {
+        lo[0], lo[1], lo[2],
+        hi[0], lo[1], lo[2],
+        hi[0], hi[1], lo[2],
+        lo[0], hi[1], lo[2],
+        lo[0], lo[1], hi[2],
+        hi[0], lo[1], hi[2],
+        hi[0], hi[1], hi[2],
+        lo[0], hi[1], hi[2]
+    };
+
+    // CCW seen from outside, same layout as the occlusion query proxy
+    static const unsigned int indices[] = {
+        0, 2, 1,  2, 0, 3,
+        4, 5, 6,  6, 7, 4,
+        0, 4, 7,  7, 3, 0,
+        1, 2, 6,  6, 5, 1,
+        3, 7, 6,  6, 2, 3,
+        0, 1, 5,  5, 4, 0
+    };
+
+    soft_occlusion_add_occluder(so, positions, 8, indices, 36, transform);
+}
+
+/**
+    * Helper func to get edge function coefficients: inside when a * x + b * y + c >= 0
+**/
+
+static void edge_setup(const soft_triangle_t* tri, float* a, float* b, float* c) {
+    for (int i = 0; i < 3; i++) {
+        int from = (i + 1) % 3;
+        int to = (i + 2) % 3;
+
+        a[i] = tri->y[from] - tri->y[to];
+        b[i] = tri->x[to] - tri->x[from];
+        c[i] = -(a[i] * tri->x[from] + b[i] * tri->y[from]);
+    }
+}
+
+static void raster_scalar(soft_occlusion_t* so, const soft_triangle_t* tri, int x0, int y0, int x1, int y1) {
+    float a[3], b[3], c[3];
+    edge_setup(tri, a, b, c);
+
+    for (int y = y0; y < y1; y++) {
+        float py = (float)y + 0.5f;
+        float* row = so->depth + y * so->width;
+
+        for (int x = x0; x < x1; x++) {
+            float px = (float)x + 0.5f;
+
+            if (a[0] * px + b[0] * py + c[0] < 0.0f ||
+                a[1] * px + b[1] * py + c[1] < 0.0f ||
+                a[2] * px + b[2] * py + c[2] < 0.0f) {
+                continue;
+            }
+
+            float z = tri->z_a * px + tri->z_b * py + tri->z_c;
+
+            if (z > row[x]) {
+                row[x] = z;
+            }
+        }
+    }
+}
+
+static void update_hiz_scalar(soft_occlusion_t* so, int tile_x, int tile_y) {
+    for (int by = tile_y; by < tile_y + TILE_HEIGHT; by += HIZ_BLOCK) {
+        for (int bx = tile_x; bx < tile_x + TILE_WIDTH; bx += HIZ_BLOCK) {
+            float farthest = FLT_MAX;
+
+            for (int y = by; y < by + HIZ_BLOCK; y++) {
+                for (int x = bx; x < bx + HIZ_BLOCK; x++) {
+                    farthest = fminf(farthest, so->depth[y * so->width + x]);
+                }
+            }
+
+            so->hiz[(by / HIZ_BLOCK) * so->hiz_width + bx / HIZ_BLOCK] = farthest;
+        }
+    }
+}
+
+#ifdef SOFT_OCCLUSION_X86
+
+__attribute__((target("avx2")))
+static void raster_avx2(soft_occlusion_t* so, const soft_triangle_t* tri, int x0, int y0, int x1, int y1) {
+    float a[3], b[3], c[3];
+    edge_setup(tri, a, b, c);
+
+    // Whole 8 pixel spans: tiles are 8 aligned so this never leaves the tile
+    x0 &= ~7;
+    x1 = (x1 + 7) & ~7;
+
+    const __m256 lane = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 a0 = _mm256_set1_ps(a[0]);
+    const __m256 a1 = _mm256_set1_ps(a[1]);
+    const __m256 a2 = _mm256_set1_ps(a[2]);
+    const __m256 za = _mm256_set1_ps(tri->z_a);
+
+    for (int y = y0; y < y1; y++) {
+        float py = (float)y + 0.5f;
+        float* row = so->depth + y * so->width;
+
+        const __m256 row0 = _mm256_set1_ps(b[0] * py + c[0]);
+        const __m256 row1 = _mm256_set1_ps(b[1] * py + c[1]);
+        const __m256 row2 = _mm256_set1_ps(b[2] * py + c[2]);
+        const __m256 row_z = _mm256_set1_ps(tri->z_b * py + tri->z_c);
+
+        for (int x = x0; x < x1; x += 8) {
+            __m256 px = _mm256_add_ps(_mm256_set1_ps((float)x), lane);
+
+            __m256 e0 = _mm256_add_ps(_mm256_mul_ps(a0, px), row0);
+            __m256 e1 = _mm256_add_ps(_mm256_mul_ps(a1, px), row1);
+            __m256 e2 = _mm256_add_ps(_mm256_mul_ps(a2, px), row2);
+
+            __m256 inside = _mm256_and_ps(
+                _mm256_and_ps(_mm256_cmp_ps(e0, zero, _CMP_GE_OQ), _mm256_cmp_ps(e1, zero, _CMP_GE_OQ)),
+                _mm256_cmp_ps(e2, zero, _CMP_GE_OQ));
+
+            if (_mm256_movemask_ps(inside) == 0) {
+                continue;
+            }
+
+            __m256 z = _mm256_add_ps(_mm256_mul_ps(za, px), row_z);
+            __m256 depth = _mm256_load_ps(row + x);
+
+            _mm256_store_ps(row + x, _mm256_blendv_ps(depth, _mm256_max_ps(depth, z), inside));
+        }
+    }
+}
+
+__attribute__((target("avx2")))
+static void update_hiz_avx2(soft_occlusion_t* so, int tile_x, int tile_y) {
+    for (int by = tile_y; by < tile_y + TILE_HEIGHT; by += HIZ_BLOCK) {
+        for (int bx = tile_x; bx < tile_x + TILE_WIDTH; bx += HIZ_BLOCK) {
+            __m256 farthest = _mm256_load_ps(so->depth + by * so->width + bx);
+
+            for (int y = by + 1; y < by + HIZ_BLOCK; y++) {
+                farthest = _mm256_min_ps(farthest, _mm256_load_ps(so->depth + y * so->width + bx));
+            }
+
+            // Horizontal min of the 8 lanes
+            __m128 half = _mm_min_ps(_mm256_castps256_ps128(farthest), _mm256_extractf128_ps(farthest, 1));
+            half = _mm_min_ps(half, _mm_movehl_ps(half, half));
+            half = _mm_min_ss(half, _mm_shuffle_ps(half, half, 1));
+
+            so->hiz[(by / HIZ_BLOCK) * so->hiz_width + bx / HIZ_BLOCK] = _mm_cvtss_f32(half);
+        }
+    }
+}
+
+#endif // SOFT_OCCLUSION_X86
+
+static void rasterize_tile_job(void* user_data, unsigned int tile, unsigned int thread_index) {
+    (void)thread_index;
+
+    soft_occlusion_t* so = user_data;
+    int tile_x = (int)(tile % so->tiles_x) * TILE_WIDTH;
+    int tile_y = (int)(tile / so->tiles_x) * TILE_HEIGHT;
+
+    for (int y = tile_y; y < tile_y + TILE_HEIGHT; y++) {
+        memset(so->depth + y * so->width + tile_x, 0, sizeof(float) * TILE_WIDTH);
+    }
+
+    for (unsigned int i = so->bin_offsets[tile]; i < so->bin_offsets[tile + 1]; i++) {
+        const soft_triangle_t* tri = &so->triangles[so->bin_triangles[i]];
+
+        int x0 = tri->min_x > tile_x ? tri->min_x : tile_x;
+        int y0 = tri->min_y > tile_y ? tri->min_y : tile_y;
+        int x1 = tri->max_x < tile_x + TILE_WIDTH ? tri->max_x : tile_x + TILE_WIDTH;
+        int y1 = tri->max_y < tile_y + TILE_HEIGHT ? tri->max_y : tile_y + TILE_HEIGHT;
+
+#ifdef SOFT_OCCLUSION_X86
+        if (so->use_avx2) {
+            raster_avx2(so, tri, x0, y0, x1, y1);
+            continue;
+        }
+#endif
+
+        raster_scalar(so, tri, x0, y0, x1, y1);
+    }
+
+#ifdef SOFT_OCCLUSION_X86
+    if (so->use_avx2) {
+        update_hiz_avx2(so, tile_x, tile_y);
+
+        return;
+    }
+#endif
+
+    update_hiz_scalar(so, tile_x, tile_y);
+}
+
+void soft_occlusion_rasterize(soft_occlusion_t* so) {
+    if (!so->depth) {
+        return;
+    }
+
+    unsigned int tile_count = (unsigned int)(so->tiles_x * so->tiles_y);
+
+    // Count triangles per tile
+    memset(so->bin_offsets, 0, sizeof(unsigned int) * (tile_count + 1));
+
+    for (unsigned int i = 0; i < so->triangle_count; i++) {
+        const soft_triangle_t* tri = &so->triangles[i];
+
+        for (int ty = tri->min_y / TILE_HEIGHT; ty <= (tri->max_y - 1) / TILE_HEIGHT; ty++) {
+            for (int tx = tri->min_x / TILE_WIDTH; tx <= (tri->max_x - 1) / TILE_WIDTH; tx++) {
+                so->bin_offsets[ty * so->tiles_x + tx + 1]++;
+            }
+        }
+    }
+
+    for (unsigned int i = 1; i <= tile_count; i++) {
+        so->bin_offsets[i] += so->bin_offsets[i - 1];
+    }
+
+    if (!grow_array((void**)&so->bin_triangles, &so->bin_capacity, so->bin_offsets[tile_count], sizeof(unsigned int))) {
+        return;
+    }
+
+    // Fill the bins
+    memcpy(so->bin_cursor, so->bin_offsets, sizeof(unsigned int) * tile_count);
+
+    for (unsigned int i = 0; i < so->triangle_count; i++) {
+        const soft_triangle_t* tri = &so->triangles[i];
+
+        for (int ty = tri->min_y / TILE_HEIGHT; ty <= (tri->max_y - 1) / TILE_HEIGHT; ty++) {
+            for (int tx = tri->min_x / TILE_WIDTH; tx <= (tri->max_x - 1) / TILE_WIDTH; tx++) {
+                so->bin_triangles[so->bin_cursor[ty * so->tiles_x + tx]++] = i;
+            }
+        }
+    }
+
+    // Tiles own disjoint pixels, so they rasterize without any locking
+    jobs_parallel_for(tile_count, rasterize_tile_job, so);
+}
+
+int soft_occlusion_test_aabb(soft_occlusion_t* so, vec3 bounds_min, vec3 bounds_max, mat4 transform) {
+    if (!so->depth) {
+        return 1;
+    }
+
+    mat4 mvp;
+    glm_mat4_mul(so->view_projection, transform, mvp);
+
+    float min_x = FLT_MAX, min_y = FLT_MAX;
+    float max_x = -FLT_MAX, max_y = -FLT_MAX;
+    float nearest = 0.0f;
+
+    for (int i = 0; i < 8; i++) {
+        vec4 corner = {
+            (i & 1) ? bounds_max[0] : bounds_min[0],
+            (i & 2) ? bounds_max[1] : bounds_min[1],
+            (i & 4) ? bounds_max[2] : bounds_min[2],
+            1.0f
+        };
+        vec4 clip;
+
+        glm_mat4_mulv(mvp, corner, clip);
+
+        // Box crosses the near plane: too close to cull safely
+        if (clip[3] <= 1e-5f || clip[2] < -clip[3]) {
+            return 1;
+        }
+
+        float inv_w = 1.0f / clip[3];
+        float sx = (clip[0] * inv_w * 0.5f + 0.5f) * (float)so->width;
+        float sy = (clip[1] * inv_w * 0.5f + 0.5f) * (float)so->height;
+
+        min_x = fminf(min_x, sx);
+        min_y = fminf(min_y, sy);
+        max_x = fmaxf(max_x, sx);
+        max_y = fmaxf(max_y, sy);
+        nearest = fmaxf(nearest, inv_w);
+    }
+
+    // Entirely off screen
+    if (max_x < 0.0f || max_y < 0.0f || min_x >= (float)so->width || min_y >= (float)so->height) {
+        return 0;
+    }
+
+    int bx0 = (int)fmaxf(min_x, 0.0f) / HIZ_BLOCK;
+    int by0 = (int)fmaxf(min_y, 0.0f) / HIZ_BLOCK;
+    int bx1 = (int)fminf(max_x, (float)(so->width - 1)) / HIZ_BLOCK;
+    int by1 = (int)fminf(max_y, (float)(so->height - 1)) / HIZ_BLOCK;
+
+    // Hidden only if every covered block has an occluder nearer than the box
+    for (int by = by0; by <= by1; by++) {
+        for (int bx = bx0; bx <= bx1; bx++) {
+            if (so->hiz[by * so->hiz_width + bx] <= nearest) {
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+void soft_occlusion_destroy(soft_occlusion_t* so) {
+    free(so->depth);
+    free(so->hiz);
+    free(so->triangles);
+    free(so->clip_vertices);
+    free(so->bin_offsets);
+    free(so->bin_cursor);
+    free(so->bin_triangles);
+
+    *so = (soft_occlusion_t){0};
+}
@@ -0,0 +1,106 @@
+#ifndef SOFT_OCCLUSION_H
+#define SOFT_OCCLUSION_H
+
+#include <cglm/cglm.h>
+
+typedef struct {
+    float x[3];
+    float y[3];
+    float z_a, z_b, z_c; // Inverse w plane: z = a * x + b * y + c
+    int min_x, min_y, max_x, max_y;
+} soft_triangle_t;
+
+typedef struct {
+    int width;
+    int height;
+    int tiles_x;
+    int tiles_y;
+
+    float* depth; // Inverse w per pixel: 0 = nothing drawn
+    float* hiz;   // Farthest inverse w per 8x8 block
+    int hiz_width;
+    int hiz_height;
+
+    soft_triangle_t* triangles;
+    unsigned int triangle_count;
+    unsigned int triangle_capacity;
+
+    vec4* clip_vertices;
+    unsigned int clip_capacity;
+
+    unsigned int* bin_offsets; // tiles_x * tiles_y + 1 entries
+    unsigned int* bin_cursor;
+    unsigned int* bin_triangles;
+    unsigned int bin_capacity;
+
+    mat4 view_projection;
+    int use_avx2;
+} soft_occlusion_t;
+
+/**
+    * Create a low resolution CPU depth buffer for occlusion tests
+    * Dimensions are rounded up to whole 32x32 tiles
+    * @param width Buffer width in pixels
+    * @param height Buffer height in pixels
+    * @return Occlusion buffer, width is 0 on failure
+**/
+
+soft_occlusion_t soft_occlusion_create(int width, int height);
+
+/**
+    * Start a new frame and drop all occluders
+    * @param so Occlusion buffer
+    * @param view_projection Projection * view matrix
+**/
+
+void soft_occlusion_begin_frame(soft_occlusion_t* so, mat4 view_projection);
+
+/**
+    * Add an indexed triangle mesh occluder: CCW front faces
+    * @param so Occlusion buffer
+    * @param positions Vertex positions: 3 floats per vertex
+    * @param vertex_count Number of vertices
+    * @param indices Triangle indices
+    * @param index_count Number of indices
+    * @param transform Occluder model matrix
+**/
+
+void soft_occlusion_add_occluder(soft_occlusion_t* so, const float* positions, unsigned int vertex_count,
+                                 const unsigned int* indices, unsigned int index_count, mat4 transform);
+
+/**
+    * Add a box occluder
+    * @param so Occlusion buffer
+    * @param bounds_min Local space box min
+    * @param bounds_max Local space box max
+    * @param transform Occluder model matrix
+**/
+
+void soft_occlusion_add_box(soft_occlusion_t* so, vec3 bounds_min, vec3 bounds_max, mat4 transform);
+
+/**
+    * Bin occluders into tiles and rasterize them on the job threads
+    * @param so Occlusion buffer
+**/
+
+void soft_occlusion_rasterize(soft_occlusion_t* so);
+
+/**
+    * Test an occludee bounding box against the rasterized occluders
+    * @param so Occlusion buffer
+    * @param bounds_min Local space AABB min
+    * @param bounds_max Local space AABB max
+    * @param transform Object model matrix
+    * @return 1 if the box may be visible and 0 if it is fully hidden
+**/
+
+int soft_occlusion_test_aabb(soft_occlusion_t* so, vec3 bounds_min, vec3 bounds_max, mat4 transform);
+
+/**
+    * Free occlusion buffer memory
+    * @param so Occlusion buffer
+**/
+
+void soft_occlusion_destroy(soft_occlusion_t* so);
+
+#endif // SOFT_OCCLUSION_H
@@ -0,0 +1,177 @@
+#define GL_GLEXT_PROTOTYPES
+#include "stream_buffer.h"
+#include "renderer.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <GL/gl.h>
+#include <GL/glext.h>
+
+// All mapping goes through the copy target so VAO and draw bindings stay untouched
+#define STREAM_MAP_TARGET GL_COPY_WRITE_BUFFER
+
+stream_buffer_t stream_buffer_create(size_t frame_size, unsigned int frame_count) {
+    stream_buffer_t stream = {0};
+
+    if (frame_count < 2) frame_count = 2;
+    if (frame_count > STREAM_BUFFER_MAX_FRAMES) frame_count = STREAM_BUFFER_MAX_FRAMES;
+
+    // Keep every region start aligned for UBO and attribute bindings
+    frame_size = (frame_size + 255) & ~(size_t)255;
+
+    stream.frame_size = frame_size;
+    stream.frame_count = frame_count;
+
+    size_t total = frame_size * frame_count;
+
+    glGenBuffers(1, &stream.buffer);
+    glBindBuffer(STREAM_MAP_TARGET, stream.buffer);
+
+    if (renderer_has_extension("GL_ARB_buffer_storage")) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+        glBufferStorage(STREAM_MAP_TARGET, (GLsizeiptr)total, NULL, flags);
+        stream.mapped = glMapBufferRange(STREAM_MAP_TARGET, 0, (GLsizeiptr)total, flags);
+        stream.persistent = stream.mapped != NULL;
+    }
+
+    if (!stream.persistent) {
+        // Immutable storage can't be respecified, start over with a fresh buffer
+        if (stream.mapped == NULL && renderer_has_extension("GL_ARB_buffer_storage")) {
+            glDeleteBuffers(1, &stream.buffer);
+            glGenBuffers(1, &stream.buffer);
+            glBindBuffer(STREAM_MAP_TARGET, stream.buffer);
+        }
+
+        glBufferData(STREAM_MAP_TARGET, (GLsizeiptr)total, NULL, GL_STREAM_DRAW);
+        stream.mapped = NULL;
+    }
+
+    glBindBuffer(STREAM_MAP_TARGET, 0);
+
+    printf("Stream buffer: %u x %zu KB | %s\n", frame_count, frame_size / 1024,
+           stream.persistent ? "persistent mapping" : "unsynchronized mapping");
+
+    return stream;
+}
+
+void stream_buffer_begin_frame(stream_buffer_t* stream) {
+    if (stream->buffer == 0) {
+        return;
+    }
+
+    GLsync fence = (GLsync)stream->fences[stream->frame_index];
+
+    // Only blocks when the CPU runs frame_count frames ahead of the GPU
+    if (fence) {
+        GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+
+        while (result == GL_TIMEOUT_EXPIRED) {
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        }
+
+        glDeleteSync(fence);
+        stream->fences[stream->frame_index] = NULL;
+    }
+
+    stream->offset = 0;
+    stream->map_start = 0;
+    stream->overflowed = 0;
+    stream->in_frame = 1;
+}
+
+// Fallback path: maps the rest of the frame region, from the write cursor on
+static int stream_map(stream_buffer_t* stream) {
+    // The fence already guarantees the GPU is done with this region
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT |
+                       GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT;
+    size_t start = stream->frame_index * stream->frame_size + stream->offset;
+
+    glBindBuffer(STREAM_MAP_TARGET, stream->buffer);
+    stream->mapped = glMapBufferRange(STREAM_MAP_TARGET, (GLintptr)start, (GLsizeiptr)(stream->frame_size - stream->offset), flags);
+    glBindBuffer(STREAM_MAP_TARGET, 0);
+
+    stream->map_start = stream->offset;
+
+    return stream->mapped ? 0 : -1;
+}
+
+void* stream_buffer_alloc(stream_buffer_t* stream, size_t size, size_t alignment, size_t* out_offset) {
+    if (stream->buffer == 0 || !stream->in_frame || stream->offset >= stream->frame_size) {
+        return NULL;
+    }
+
+    if (!stream->persistent && !stream->mapped && stream_map(stream) != 0) {
+        return NULL;
+    }
+
+    if (alignment == 0) {
+        alignment = 4;
+    }
+
+    size_t offset = (stream->offset + alignment - 1) & ~(alignment - 1);
+
+    if (offset + size > stream->frame_size) {
+        if (!stream->overflowed) {
+            fprintf(stderr, "Stream buffer frame overflow: %zu bytes requested\n", size);
+            stream->overflowed = 1;
+        }
+
+        return NULL;
+    }
+
+    stream->offset = offset + size;
+
+    size_t region = stream->frame_index * stream->frame_size;
+
+    if (out_offset) {
+        *out_offset = region + offset;
+    }
+
+    // Persistent mappings cover the whole buffer, the fallback maps from map_start on
+    return stream->persistent ? stream->mapped + region + offset : stream->mapped + (offset - stream->map_start);
+}
+
+void stream_buffer_flush(stream_buffer_t* stream) {
+    if (stream->persistent || !stream->mapped) {
+        return;
+    }
+
+    // The GL can't source a buffer while it is mapped without the persistent bit
+    glBindBuffer(STREAM_MAP_TARGET, stream->buffer);
+    glFlushMappedBufferRange(STREAM_MAP_TARGET, 0, (GLsizeiptr)(stream->offset - stream->map_start));
+    glUnmapBuffer(STREAM_MAP_TARGET);
+    glBindBuffer(STREAM_MAP_TARGET, 0);
+    stream->mapped = NULL;
+}
+
+void stream_buffer_end_frame(stream_buffer_t* stream) {
+    if (stream->buffer == 0) {
+        return;
+    }
+
+    stream_buffer_flush(stream);
+
+    stream->fences[stream->frame_index] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    stream->frame_index = (stream->frame_index + 1) % stream->frame_count;
+    stream->in_frame = 0;
+}
+
+void stream_buffer_destroy(stream_buffer_t* stream) {
+    for (unsigned int i = 0; i < STREAM_BUFFER_MAX_FRAMES; i++) {
+        if (stream->fences[i]) {
+            glDeleteSync((GLsync)stream->fences[i]);
+        }
+    }
+
+    if (stream->buffer != 0) {
+        if (stream->persistent || stream->mapped) {
+            glBindBuffer(STREAM_MAP_TARGET, stream->buffer);
+            glUnmapBuffer(STREAM_MAP_TARGET);
+            glBindBuffer(STREAM_MAP_TARGET, 0);
+        }
+
+        glDeleteBuffers(1, &stream->buffer);
+    }
+
+    *stream = (stream_buffer_t){0};
+}
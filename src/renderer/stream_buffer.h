@@ -0,0 +1,76 @@
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#include <stddef.h>
+
+#define STREAM_BUFFER_MAX_FRAMES 4
+
+typedef struct {
+    unsigned int buffer;
+    size_t frame_size;
+    unsigned int frame_count;
+    unsigned int frame_index;
+    size_t offset;          // Write cursor inside the current frame region
+    size_t map_start;       // Fallback only: region offset the current mapping starts at
+    unsigned char* mapped;  // Whole buffer when persistent, rest of the region otherwise
+    int persistent;
+    int overflowed;
+    int in_frame;           // Between begin and end frame, only then are allocations fenced
+    void* fences[STREAM_BUFFER_MAX_FRAMES]; // GLsync per frame region
+} stream_buffer_t;
+
+/**
+   * Create a ring buffer for per-frame dynamic data
+   * Uses a persistent coherent mapping when GL_ARB_buffer_storage exists
+   * and unsynchronized glMapBufferRange otherwise
+   * @param frame_size Bytes available to each frame
+   * @param frame_count Frames in flight: 2..STREAM_BUFFER_MAX_FRAMES
+   * @return Stream buffer, buffer is 0 on failure
+**/
+
+stream_buffer_t stream_buffer_create(size_t frame_size, unsigned int frame_count);
+
+/**
+   * Start writing the next frame region, waits only if the GPU still reads it
+   * @param stream Stream buffer
+**/
+
+void stream_buffer_begin_frame(stream_buffer_t* stream);
+
+/**
+   * Allocate space in the current frame region
+   * Fails outside begin/end frame, nothing would fence the data
+   * Call stream_buffer_flush() before any draw or binding reads what was written
+   * @param stream Stream buffer
+   * @param size Bytes to allocate
+   * @param alignment Required offset alignment: power of two
+   * @param out_offset Byte offset inside stream->buffer for binding
+   * @return Mapped write pointer or NULL when the frame region is full
+**/
+
+void* stream_buffer_alloc(stream_buffer_t* stream, size_t size, size_t alignment, size_t* out_offset);
+
+/**
+   * Make the data written so far visible to the GL
+   * Without buffer storage the region is unmapped here, the next allocation
+   * maps the rest of it. No-op with a persistent mapping
+   * @param stream Stream buffer
+**/
+
+void stream_buffer_flush(stream_buffer_t* stream);
+
+/**
+   * Finish the current frame region and fence it
+   * @param stream Stream buffer
+**/
+
+void stream_buffer_end_frame(stream_buffer_t* stream);
+
+/**
+   * Delete the buffer and its fences
+   * @param stream Stream buffer
+**/
+
+void stream_buffer_destroy(stream_buffer_t* stream);
+
+#endif // STREAM_BUFFER_H